@@ -63,6 +63,39 @@ function is_eq(arr, arr2) {
 	return true;
 }
 
+function view(m, buf) {
+	return new Uint8Array(m.memory().buffer, buf.ptr(), buf.len());
+}
+
+// MB/s of `seal` (copies, fresh X25519) against a cached `BoxKey` sealing in place
+function bench(m, pk2) {
+	const key = new m.BoxKey(SK1, pk2);
+
+	for (let size = 1 << 10; size <= 1 << 24; size <<= 2) {
+		const iters = Math.max(8, (64 << 20) / size);
+		const input = new Uint8Array(size);
+
+		let t = performance.now();
+		for (let i = 0; i < iters; i++) {
+			m.seal(SK1, pk2, NONCE, input);
+		}
+		const copying = size * iters / (performance.now() - t) / 1000;
+
+		const buf = new m.Buffer(size);
+		view(m, buf).fill(7, m.Buffer.macLength());
+		t = performance.now();
+		for (let i = 0; i < iters; i++) {
+			key.seal(NONCE, buf);
+		}
+		const inPlace = size * iters / (performance.now() - t) / 1000;
+		buf.free();
+
+		console.log(`${size} B: seal ${copying.toFixed(1)} MB/s, BoxKey ${inPlace.toFixed(1)} MB/s`);
+	}
+
+	key.free();
+}
+
 rust.then(m => {
 	const pk1 = m.scalarmult(SK1);
 	const pk2 = m.scalarmult(SK2);
@@ -73,4 +106,24 @@ rust.then(m => {
 	if (!is_eq(pt, MSG)) {
 		console.error("wtf", pt, MSG);
 	}
+
+	// the same box through cached keys and a buffer in wasm memory
+	const alice = new m.BoxKey(SK1, pk2);
+	const bob = new m.BoxKey(SK2, pk1);
+	const buf = new m.Buffer(MSG.length);
+	view(m, buf).set(MSG, m.Buffer.macLength());
+
+	alice.seal(NONCE, buf);
+	if (!is_eq(view(m, buf).slice(m.Buffer.macLength()), ct.slice(0, MSG.length))) {
+		console.error("in-place seal differs", view(m, buf), ct);
+	}
+	if (!bob.open(NONCE, buf) || !is_eq(view(m, buf).slice(m.Buffer.macLength()), MSG)) {
+		console.error("in-place open failed", view(m, buf), MSG);
+	}
+
+	buf.free();
+	alice.free();
+	bob.free();
+
+	bench(m, pk2);
 }).catch(console.error);
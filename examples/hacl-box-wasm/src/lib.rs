@@ -1,6 +1,7 @@
+use core::ptr;
 use wasm_bindgen::prelude::*;
 use arrayref::{ array_ref, array_mut_ref };
-use hacl_star::{ curve25519, nacl::sealed };
+use hacl_star::{ curve25519, nacl::{ secret, sealed } };
 
 
 #[wasm_bindgen]
@@ -26,8 +27,9 @@ pub fn seal(sk: &[u8], pk: &[u8], nonce: &[u8], input: &[u8]) -> Vec<u8> {
         let nonce = array_ref!(nonce, 0, sealed::NONCE_LENGTH);
         let (output, tag) = output.split_at_mut(input.len());
         let tag = array_mut_ref!(tag, 0, sealed::MAC_LENGTH);
-        sk.and(pk).nonce(nonce)
-            .seal(input, output, tag);
+        if !sk.and(pk).nonce(nonce).seal(input, output, tag) {
+            wasm_bindgen::throw_str("invalid public key")
+        }
     }
 
     output
@@ -48,3 +50,94 @@ pub fn open(sk: &[u8], pk: &[u8], nonce: &[u8], input: &[u8]) -> Vec<u8> {
         wasm_bindgen::throw_str("decrypt failed!")
     }
 }
+
+/// The module's `WebAssembly.Memory`, for views onto `Buffer`s.
+#[wasm_bindgen]
+pub fn memory() -> JsValue {
+    wasm_bindgen::memory()
+}
+
+/// A message held in wasm memory as `mac || message` (the `crypto_box_easy` layout),
+/// sealed and opened in place.
+///
+/// JS fills and reads it through `new Uint8Array(memory().buffer, buf.ptr(), buf.len())`,
+/// so no bytes cross the JS/wasm boundary per call. Views are detached when the
+/// memory grows, so take a fresh one after allocating.
+#[wasm_bindgen]
+pub struct Buffer {
+    data: Vec<u8>
+}
+
+#[wasm_bindgen]
+impl Buffer {
+    /// Room for a message of `len` bytes and its mac.
+    #[wasm_bindgen(constructor)]
+    pub fn new(len: usize) -> Buffer {
+        Buffer { data: vec![0; sealed::MAC_LENGTH + len] }
+    }
+
+    pub fn ptr(&self) -> usize {
+        self.data.as_ptr() as usize
+    }
+
+    pub fn len(&self) -> usize {
+        self.data.len()
+    }
+
+    #[wasm_bindgen(js_name = macLength)]
+    pub fn mac_length() -> usize {
+        sealed::MAC_LENGTH
+    }
+}
+
+impl Buffer {
+    fn split(&mut self) -> (&mut [u8; sealed::MAC_LENGTH], &mut [u8]) {
+        let (mac, msg) = self.data.split_at_mut(sealed::MAC_LENGTH);
+        (array_mut_ref!(mac, 0, sealed::MAC_LENGTH), msg)
+    }
+}
+
+/// Shared key of a (secret key, peer public key) pair, computed once.
+///
+/// `seal`/`open` above redo the X25519 on every call; a `BoxKey` kept by the JS side
+/// costs one X25519 per peer and then only XSalsa20-Poly1305 per message.
+#[wasm_bindgen]
+pub struct BoxKey {
+    key: secret::Key
+}
+
+#[wasm_bindgen]
+impl BoxKey {
+    #[wasm_bindgen(constructor)]
+    pub fn new(sk: &[u8], pk: &[u8]) -> Result<BoxKey, JsValue> {
+        let sk = curve25519::secretkey(array_ref!(sk, 0, sealed::SECRET_LENGTH));
+        let pk = curve25519::publickey(array_ref!(pk, 0, sealed::PUBLIC_LENGTH));
+
+        sk.and(pk).precompute()
+            .map(|key| BoxKey { key })
+            .ok_or_else(|| JsValue::from_str("invalid public key"))
+    }
+
+    /// Encrypts the message of `buf` in place and writes its mac in front.
+    pub fn seal(&self, nonce: &[u8], buf: &mut Buffer) {
+        let nonce = array_ref!(nonce, 0, sealed::NONCE_LENGTH);
+        let (mac, msg) = buf.split();
+        self.key.nonce(nonce).seal_in_place(msg, mac);
+    }
+
+    /// Decrypts `buf` in place; returns `false`, leaving it untouched, if the mac
+    /// does not verify.
+    pub fn open(&self, nonce: &[u8], buf: &mut Buffer) -> bool {
+        let nonce = array_ref!(nonce, 0, sealed::NONCE_LENGTH);
+        let (mac, msg) = buf.split();
+        self.key.nonce(nonce).open_in_place(msg, mac)
+    }
+}
+
+impl Drop for BoxKey {
+    fn drop(&mut self) {
+        for b in self.key.0.iter_mut() {
+            unsafe { ptr::write_volatile(b, 0) };
+        }
+    }
+}
@@ -0,0 +1,66 @@
+//! Prints several digests of each file, reading it once:
+//!
+//!     cargo run --release --features std --example hashsum -- -a sha256,blake2b FILE...
+//!
+//! With one algorithm the lines are those of `sha256sum` (`<hex>  <path>`), with
+//! several those of `sha256sum --tag` (`SHA256 (<path>) = <hex>`).
+
+use std::env;
+use std::process;
+use hacl_star::file::{ self, Algorithm };
+
+
+fn parse(names: &str) -> Option<Vec<Algorithm>> {
+    names.split(',')
+        .map(|name| match name {
+            "sha224" => Some(Algorithm::Sha224),
+            "sha256" => Some(Algorithm::Sha256),
+            "sha384" => Some(Algorithm::Sha384),
+            "sha512" => Some(Algorithm::Sha512),
+            "blake2s" => Some(Algorithm::Blake2s),
+            "blake2b" => Some(Algorithm::Blake2b),
+            _ => None
+        })
+        .collect()
+}
+
+fn main() {
+    let mut args = env::args().skip(1).peekable();
+    let mut algorithms = vec![Algorithm::Sha256, Algorithm::Sha512, Algorithm::Blake2b];
+
+    if args.peek().map(String::as_str) == Some("-a") {
+        args.next();
+        algorithms = match args.next().as_ref().and_then(|names| parse(names)) {
+            Some(algorithms) => algorithms,
+            None => {
+                eprintln!("usage: hashsum [-a sha224,sha256,sha384,sha512,blake2s,blake2b] FILE...");
+                process::exit(2);
+            }
+        };
+    }
+
+    let mut failed = false;
+
+    for path in args {
+        match file::hash_file(&path, &algorithms) {
+            Ok(digests) => for digest in digests {
+                let hex = digest.as_ref().iter()
+                    .map(|b| format!("{:02x}", b))
+                    .collect::<String>();
+                if algorithms.len() == 1 {
+                    println!("{}  {}", hex, path);
+                } else {
+                    println!("{} ({}) = {}", digest.algorithm, path, hex);
+                }
+            },
+            Err(err) => {
+                eprintln!("hashsum: {}: {}", path, err);
+                failed = true;
+            }
+        }
+    }
+
+    if failed {
+        process::exit(1);
+    }
+}
@@ -3,20 +3,156 @@ extern crate bindgen;
 extern crate cc;
 
 use std::env;
-#[cfg(feature = "bindgen")]
+use std::fs;
 use std::path::PathBuf;
 
-fn main() {
+/// HACL* sources, relative to the snapshot directory.
+const SOURCES: &[&str] = &[
+    "Hacl_Hash.c",
+    "Hacl_Blake2s_32.c",
+    "Hacl_Blake2b_32.c",
+    "Hacl_HMAC.c",
+    "Hacl_HKDF.c",
+    "Hacl_HMAC_DRBG.c",
+    "Lib_Memzero0.c",
+    // "Hacl_SHA2_256.c",
+    // "Hacl_SHA2_384.c",
+    // "Hacl_SHA2_512.c",
+    "Hacl_EC_Ed25519.c",
+    // "Hacl_Curve25519_64.c",
+    // "Hacl_Policies.c",
+    "Hacl_Poly1305_32.c",
+    "Hacl_Chacha20.c",
+    "Hacl_Chacha20Poly1305_32.c",
+    "EverCrypt_Chacha20Poly1305.c",
+    "EverCrypt_AutoConfig2.c",
+    "Hacl_Kremlib.c",
+];
+
+/// Sources left out of the `native` unity build: EverCrypt_Hash.c (behind the
+/// default Merkle node hash) redefines the SHA-2 round constants of Hacl_Hash.c.
+const SEPARATE: &[&str] = &[
+    "EverCrypt_Hash.c",
+];
+
+/// Wrappers that include a HACL* source verbatim, compiled in its place. They stay
+/// their own units even in a unity build, since the included statics clash (e.g.
+/// `point_double` in Hacl_Curve25519_51.c and Hacl_Ed25519.c).
+const SHIMS: &[&str] = &[
+    "shim/Hacl_Curve25519_51_Batch.c",
+    "shim/EverCrypt_AEAD_Inline.c",
+    "shim/Hacl_Ed25519_Ctx.c",
+    "shim/Hacl_NaCl_Dispatch.c",
+    "shim/MerkleTree_Batch.c",
+];
+
+/// Sources and shims whose KreMLin output sets locals it never reads (`i0` in the
+/// HMAC loops, error codes in the included EverCrypt_AEAD.c), compiled with that
+/// warning off for them alone.
+const QUIET: &[&str] = &[
+    "Hacl_HMAC.c",
+    "shim/EverCrypt_AEAD_Inline.c",
+];
+
+/// `#include` line(s) for a source or shim, with the warning off around the ones
+/// in `QUIET`.
+fn include(name: &str) -> String {
+    let file = name.trim_start_matches("shim/");
+
+    if QUIET.contains(&name) {
+        format!(
+            "#if defined(__GNUC__)\n\
+             #pragma GCC diagnostic push\n\
+             #pragma GCC diagnostic ignored \"-Wunused-but-set-variable\"\n\
+             #endif\n\
+             #include \"{}\"\n\
+             #if defined(__GNUC__)\n\
+             #pragma GCC diagnostic pop\n\
+             #endif\n",
+            file
+        )
+    } else {
+        format!("#include \"{}\"\n", file)
+    }
+}
+
+/// The file to compile for `name` at `path`: itself, or for one in `QUIET` a
+/// wrapper in OUT_DIR that includes it.
+fn quiet(name: &str, path: String) -> String {
+    if !QUIET.contains(&name) {
+        return path;
+    }
+
+    let wrapper = PathBuf::from(env::var("OUT_DIR").unwrap())
+        .join(format!("quiet_{}", name.trim_start_matches("shim/")));
+    fs::write(&wrapper, include(name)).unwrap();
+    wrapper.to_str().unwrap().into()
+}
+
+/// The `native` feature: the gcc64-only snapshot (native `uint128_t`), one unity
+/// translation unit, -O3 and the rustc `target-cpu`. Linux x86_64/aarch64 only,
+/// elsewhere the feature falls back to the portable build.
+fn native() -> bool {
+    let arch = env::var("CARGO_CFG_TARGET_ARCH").unwrap();
+    let compiler = cc::Build::new().get_compiler();
+
+    env::var("CARGO_FEATURE_NATIVE").is_ok()
+        && env::var("CARGO_CFG_TARGET_OS") == Ok("linux".into())
+        && (arch == "x86_64" || arch == "aarch64")
+        && (compiler.is_like_gnu() || compiler.is_like_clang())
+}
+
+/// wasm32 built with `-C target-feature=+simd128`. WebAssembly has no runtime
+/// feature detection (a module with SIMD opcodes fails validation on runtimes
+/// without them), so the whole library is compiled for it and the vec128 kernels
+/// are always used.
+fn wasm_simd128() -> bool {
+    env::var("CARGO_CFG_TARGET_ARCH") == Ok("wasm32".into())
+        && env::var("CARGO_CFG_TARGET_FEATURE")
+            .map(|features| features.split(',').any(|feature| feature == "simd128"))
+            .unwrap_or(false)
+}
+
+fn snapshot() -> &'static str {
+    if native() {
+        "hacl-c/gcc64-only"
+    } else {
+        "hacl-c/portable-gcc-compatible"
+    }
+}
+
+/// Value of `-C <name>=...` in the rustc flags of this build.
+fn rustc_codegen(name: &str) -> Option<String> {
+    let flags = env::var("CARGO_ENCODED_RUSTFLAGS").unwrap_or_default();
+    let prefix = format!("{}=", name);
+    let mut flags = flags.split('\x1f');
+    let mut value = None;
+
+    while let Some(flag) = flags.next() {
+        let flag = match flag {
+            "-C" | "--codegen" => flags.next().unwrap_or(""),
+            flag if flag.starts_with("-C") => &flag[2..],
+            _ => continue,
+        };
+
+        if flag == name {
+            value = Some(String::new());
+        } else if flag.starts_with(&prefix) {
+            value = Some(flag[prefix.len()..].into());
+        }
+    }
+
+    value
+}
+
+fn build() -> cc::Build {
     let mut cc = cc::Build::new();
 
     // from https://github.com/project-everest/hacl-star/blob/master/snapshots/makefiles/CMakeLists.txt#L62
     if env::var("CARGO_CFG_TARGET_POINTER_WIDTH") == Ok("32".into())
         || env::var("CARGO_CFG_TARGET_ENV") == Ok("msvc".into())
     {
-        cc.shared_flag(true)
-            .define("KRML_NOUINT128", None)
-            .flag_if_supported("-Wno-unused-function")
-            .file("hacl-c/portable-gcc-compatible/FStar.c");
+        cc.define("KRML_NOUINT128", None);
     }
 
     cc.flag_if_supported(
@@ -28,7 +164,8 @@ fn main() {
             "-std=c11"
         },
     )
-    .include("hacl-c/portable-gcc-compatible")
+    .include(snapshot())
+    .include("shim")
     // .include("hacl-c/kremlin")
     .include("hacl-c/kremlin/include")
     .include("hacl-c/kremlin/kremlib/dist/minimal")
@@ -36,22 +173,154 @@ fn main() {
     .flag_if_supported("-fwrapv")
     .flag_if_supported("-fomit-frame-pointer")
     .flag_if_supported("-funroll-loops")
-    .files(&[
-        "hacl-c/portable-gcc-compatible/Hacl_Hash.c",
-        // "hacl-c/portable-gcc-compatible/Hacl_SHA2_256.c",
-        // "hacl-c/portable-gcc-compatible/Hacl_SHA2_384.c",
-        // "hacl-c/portable-gcc-compatible/Hacl_SHA2_512.c",
-        "hacl-c/portable-gcc-compatible/Hacl_Ed25519.c",
-        // "hacl-c/portable-gcc-compatible/Hacl_Curve25519_64.c",
-        "hacl-c/portable-gcc-compatible/Hacl_Curve25519_51.c",
-        // "hacl-c/portable-gcc-compatible/Hacl_Policies.c",
-        "hacl-c/portable-gcc-compatible/Hacl_NaCl.c",
-    ])
     // ignore some warnings
     .flag_if_supported("-Wno-unused-function")
     .flag_if_supported("-Wno-unused-parameter")
-    .flag_if_supported("-Wno-unused-variable")
-    .compile("hacl");
+    .flag_if_supported("-Wno-unused-variable");
+
+    if wasm_simd128() {
+        cc.flag("-msimd128");
+    }
+
+    if native() {
+        cc.opt_level(3);
+
+        if let Some(cpu) = rustc_codegen("target-cpu") {
+            if env::var("CARGO_CFG_TARGET_ARCH") == Ok("aarch64".into()) {
+                cc.flag_if_supported(&format!("-mcpu={}", cpu));
+            } else {
+                cc.flag_if_supported(&format!("-march={}", cpu));
+            }
+        }
+
+        // `-C linker-plugin-lto` links LLVM bitcode, so hot entry points can be
+        // inlined into Rust; this needs clang of the same LLVM as rustc (and llvm-ar).
+        if rustc_codegen("linker-plugin-lto").is_some() {
+            if cc.get_compiler().is_like_clang() {
+                cc.flag("-flto=thin");
+            } else {
+                println!("cargo:warning=linker-plugin-lto needs CC=clang, building without LTO");
+            }
+        }
+    }
+
+    cc
+}
+
+/// Vale assembly (and its cpuid probes) for the current target, x86_64 only.
+fn vale_asm(name: &str) -> Option<String> {
+    if env::var("CARGO_CFG_TARGET_ARCH") != Ok("x86_64".into()) {
+        return None;
+    }
+
+    let variant = match env::var("CARGO_CFG_TARGET_OS").as_ref().map(String::as_str) {
+        Ok("macos") | Ok("ios") => "darwin.S",
+        Ok("windows") if env::var("CARGO_CFG_TARGET_ENV") == Ok("msvc".into()) => "msvc.asm",
+        Ok("windows") => "mingw.S",
+        _ => "linux.S",
+    };
+
+    Some(format!("{}/{}-x86_64-{}", snapshot(), name, variant))
+}
+
+fn main() {
+    let arch = env::var("CARGO_CFG_TARGET_ARCH").unwrap();
+    let mut cc = build();
+
+    if env::var("CARGO_CFG_TARGET_POINTER_WIDTH") == Ok("32".into())
+        || env::var("CARGO_CFG_TARGET_ENV") == Ok("msvc".into())
+    {
+        cc.shared_flag(true)
+            .file("hacl-c/portable-gcc-compatible/FStar.c");
+    }
+
+    let mut sources = SOURCES.to_vec();
+
+    // system entropy source, absent on bare wasm32
+    if !(arch == "wasm32"
+        && env::var("CARGO_CFG_TARGET_OS") != Ok("emscripten".into())
+        && env::var("CARGO_CFG_TARGET_OS") != Ok("wasi".into()))
+    {
+        sources.push("Lib_RandomBuffer_System.c");
+    }
+
+    if native() {
+        let unity = PathBuf::from(env::var("OUT_DIR").unwrap()).join("hacl_unity.c");
+        let includes = sources.iter()
+            .map(|name| include(name))
+            .collect::<String>();
+        fs::write(&unity, includes).unwrap();
+
+        for name in sources.iter().chain(SEPARATE) {
+            println!("cargo:rerun-if-changed={}/{}", snapshot(), name);
+        }
+        // once any path is listed cargo watches only those, so the rest too
+        println!("cargo:rerun-if-changed=shim");
+        println!("cargo:rerun-if-changed=build.rs");
+
+        cc.file(unity);
+    } else {
+        for name in &sources {
+            cc.file(quiet(name, format!("{}/{}", snapshot(), name)));
+        }
+    }
+
+    for name in SEPARATE {
+        cc.file(format!("{}/{}", snapshot(), name));
+    }
+
+    for shim in SHIMS {
+        cc.file(quiet(shim, shim.to_string()));
+    }
+
+    // cpuid probes behind EverCrypt_AutoConfig2, the Vale Poly1305, SHA-NI and
+    // AES-GCM kernels
+    for asm in ["cpuid", "poly1305", "sha256", "aes", "aesgcm"].iter().filter_map(|name| vale_asm(name)) {
+        cc.file(asm);
+    }
+
+    cc.compile("hacl");
+
+    // vectorized kernels need their own target flags, so they are kept in separate
+    // archives and only entered after a runtime cpu check (on wasm, a build-time one).
+    if arch == "x86_64" || arch == "aarch64" || wasm_simd128() {
+        let mut vec128 = build();
+        if arch == "x86_64" {
+            vec128.flag_if_supported("-mavx").flag_if_supported("/arch:AVX");
+        }
+        if wasm_simd128() {
+            vec128.file(format!("{}/Hacl_Blake2s_128.c", snapshot()));
+        }
+        vec128
+            .file(format!("{}/Hacl_Poly1305_128.c", snapshot()))
+            .file(format!("{}/Hacl_Chacha20_Vec128.c", snapshot()))
+            .file(format!("{}/Hacl_Chacha20Poly1305_128.c", snapshot()))
+            .file("shim/Hacl_Salsa20_Vec128.c")
+            .file("shim/MerkleTree_Vec128.c")
+            .compile("hacl_vec128");
+    }
+
+    if arch == "x86_64" {
+        build()
+            .flag_if_supported("-mavx")
+            .flag_if_supported("-mavx2")
+            .flag_if_supported("/arch:AVX2")
+            .file(format!("{}/Hacl_Poly1305_256.c", snapshot()))
+            .file(format!("{}/Hacl_Chacha20_Vec256.c", snapshot()))
+            .file(format!("{}/Hacl_Chacha20Poly1305_256.c", snapshot()))
+            .file("shim/Hacl_Salsa20_Vec256.c")
+            .file("shim/MerkleTree_Vec256.c")
+            .file("shim/Hacl_SHA2_Vec256.c")
+            .compile("hacl_vec256");
+    }
+
+    if arch == "x86_64" {
+        build()
+            .flag_if_supported("-msse4.1")
+            .flag_if_supported("-msha")
+            .file("shim/MerkleTree_ShaNI.c")
+            .compile("hacl_shani");
+    }
 
     #[cfg(all(feature = "bindgen", feature = "overwrite"))]
     let outdir = PathBuf::from(env::var("CARGO_MANIFEST_DIR").unwrap())
@@ -73,6 +342,7 @@ fn main() {
                 .whitelist_var($white)
                 .clang_arg("-I//home/huitseeker/tmp/rust-hacl-star/hacl-star-sys/hacl-c/kremlin/include/")
                 .clang_arg("-I//home/huitseeker/tmp/rust-hacl-star/hacl-star-sys/hacl-c/kremlin/kremlib/dist/minimal")
+                .clang_arg("-Ihacl-c/portable-gcc-compatible")
                 .generate().unwrap()
                 .write_to_file(outdir.join($output)).unwrap();
         };
@@ -85,14 +355,24 @@ fn main() {
 
     #[cfg(feature = "bindgen")]
     bindgen! {
-        "hacl-c/portable-gcc-compatible/Hacl_Hash.h"         => "hash.rs",           "Hacl_Hash_.+";
+        "hacl-c/portable-gcc-compatible/EverCrypt_Hash.h"    => "hash.rs",           "Hacl_Hash_.+|sha256_update";
         // "hacl-c/portable-gcc-compatible/Hacl_SHA2_256.h"         => "sha2_256.rs",           "Hacl_SHA2_256_.+";
         // "hacl-c/portable-gcc-compatible/Hacl_SHA2_384.h"         => "sha2_384.rs",           "Hacl_SHA2_384_.+";
         // "hacl-c/portable-gcc-compatible/Hacl_SHA2_512.h"         => "sha2_512.rs",           "Hacl_SHA2_512_.+";
-        "hacl-c/portable-gcc-compatible/Hacl_Ed25519.h"          => "ed25519.rs",            "Hacl_Ed25519_.+";
+        "shim/Hacl_SHA2_Vec256.h"                                => "sha2_vec256.rs",        "Hacl_SHA2_Vec256_.+";
+        "shim/Hacl_Ed25519_Ctx.h"                                => "ed25519.rs",            "Hacl_Ed25519_.+";
+        "hacl-c/portable-gcc-compatible/Hacl_EC_Ed25519.h"            => "ec_ed25519.rs",         "Hacl_EC_Ed25519_.+";
         // "hacl-c/portable-gcc-compatible/Hacl_Curve25519_64.h"       => "curve25519_64.rs",         "Hacl_Curve25519_64_.+";
-        "hacl-c/portable-gcc-compatible/Hacl_Curve25519_51.h"       => "curve25519.rs",         "Hacl_Curve25519_.+";
+        "shim/Hacl_Curve25519_51_Batch.h"                             => "curve25519.rs",         "Hacl_Curve25519_.+|Hacl_Impl_Curve25519_Field51_.+";
         // "hacl-c/portable-gcc-compatible/Hacl_Policies.h"         => "hacl_policies.rs",      "Hacl_Policies_.+";
-        "hacl-c/portable-gcc-compatible/Hacl_NaCl.h"                  => "nacl.rs",               "NaCl_.+"
+        "shim/Hacl_NaCl_Dispatch.h"                                   => "nacl.rs",               "Hacl_NaCl_.+|Hacl_Salsa20_salsa20_encrypt";
+        "hacl-c/portable-gcc-compatible/EverCrypt_Poly1305.h"         => "poly1305.rs",           "Hacl_Poly1305_.+|x64_poly1305";
+        "hacl-c/portable-gcc-compatible/EverCrypt_AutoConfig2.h"      => "autoconfig2.rs",        "EverCrypt_AutoConfig2_.+";
+        "hacl-c/portable-gcc-compatible/Hacl_Blake2s_128.h"           => "blake2.rs",             "Hacl_Blake2[sb]_32_.+|Hacl_Blake2s_128_.+";
+        "hacl-c/portable-gcc-compatible/Hacl_HMAC.h"                  => "hmac.rs",               "Hacl_HMAC_.+";
+        "hacl-c/portable-gcc-compatible/Hacl_HKDF.h"                  => "hkdf.rs",               "Hacl_HKDF_.+";
+        "hacl-c/portable-gcc-compatible/EverCrypt_DRBG.h"             => "drbg.rs",               "Hacl_HMAC_DRBG_.+|Spec_Hash_Definitions_.+|Lib_RandomBuffer_System_.+";
+        "shim/EverCrypt_AEAD_Inline.h"                                => "aead.rs",               "EverCrypt_AEAD_Inline_.+|Hacl_Chacha20Poly1305_32_aead_.+|EverCrypt_Error_.+|Spec_Agile_AEAD_.+|Spec_Cipher_Expansion_.+";
+        "shim/MerkleTree_Batch.h"                                      => "merkle.rs",             "mt_.+"
     };
 }
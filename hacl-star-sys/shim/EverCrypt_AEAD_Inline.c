@@ -0,0 +1,174 @@
+/* Compiled in place of EverCrypt_AEAD.c, which is included verbatim so the
+ * encryption paths stay the verified code; only key setup moves to caller memory,
+ * and the cpu checks to the caller. */
+
+#include "EverCrypt_AEAD.c"
+#include "EverCrypt_AEAD_Inline.h"
+
+_Static_assert(sizeof (EverCrypt_AEAD_Inline_state) == sizeof (EverCrypt_AEAD_state_s),
+  "EverCrypt_AEAD_Inline_state must mirror EverCrypt_AEAD_state_s");
+
+bool EverCrypt_AEAD_Inline_has_aes_gcm(void)
+{
+  #if EVERCRYPT_TARGETCONFIG_X64
+  bool has_aesni = EverCrypt_AutoConfig2_has_aesni();
+  bool has_pclmulqdq = EverCrypt_AutoConfig2_has_pclmulqdq();
+  bool has_avx = EverCrypt_AutoConfig2_has_avx();
+  bool has_sse = EverCrypt_AutoConfig2_has_sse();
+  bool has_movbe = EverCrypt_AutoConfig2_has_movbe();
+  return has_aesni && has_pclmulqdq && has_avx && has_sse && has_movbe;
+  #else
+  return false;
+  #endif
+}
+
+/* EverCrypt_Chacha20Poly1305 only takes the vec128 kernel on x64, after an AVX
+ * check; NEON and wasm simd128 always have it. */
+uint32_t EverCrypt_AEAD_Inline_chacha20poly1305_lanes(void)
+{
+  #if EVERCRYPT_TARGETCONFIG_X64
+  if (EverCrypt_AutoConfig2_has_avx2())
+  {
+    return (uint32_t)8U;
+  }
+  if (EverCrypt_AutoConfig2_has_avx())
+  {
+    return (uint32_t)4U;
+  }
+  return (uint32_t)1U;
+  #elif defined(__aarch64__) || defined(__wasm_simd128__)
+  return (uint32_t)4U;
+  #else
+  return (uint32_t)1U;
+  #endif
+}
+
+EverCrypt_AEAD_Inline_chacha20poly1305_encrypt
+EverCrypt_AEAD_Inline_chacha20poly1305_encrypt_kernel(void)
+{
+  switch (EverCrypt_AEAD_Inline_chacha20poly1305_lanes())
+  {
+    #if EVERCRYPT_TARGETCONFIG_X64
+    case 8U:
+      {
+        return Hacl_Chacha20Poly1305_256_aead_encrypt;
+      }
+    #endif
+    #if EVERCRYPT_TARGETCONFIG_X64 || defined(__aarch64__) || defined(__wasm_simd128__)
+    case 4U:
+      {
+        return Hacl_Chacha20Poly1305_128_aead_encrypt;
+      }
+    #endif
+    default:
+      {
+        return Hacl_Chacha20Poly1305_32_aead_encrypt;
+      }
+  }
+}
+
+EverCrypt_AEAD_Inline_chacha20poly1305_decrypt
+EverCrypt_AEAD_Inline_chacha20poly1305_decrypt_kernel(void)
+{
+  switch (EverCrypt_AEAD_Inline_chacha20poly1305_lanes())
+  {
+    #if EVERCRYPT_TARGETCONFIG_X64
+    case 8U:
+      {
+        return Hacl_Chacha20Poly1305_256_aead_decrypt;
+      }
+    #endif
+    #if EVERCRYPT_TARGETCONFIG_X64 || defined(__aarch64__) || defined(__wasm_simd128__)
+    case 4U:
+      {
+        return Hacl_Chacha20Poly1305_128_aead_decrypt;
+      }
+    #endif
+    default:
+      {
+        return Hacl_Chacha20Poly1305_32_aead_decrypt;
+      }
+  }
+}
+
+EverCrypt_Error_error_code
+EverCrypt_AEAD_Inline_init(
+  Spec_Agile_AEAD_alg a,
+  EverCrypt_AEAD_Inline_state *dst,
+  uint8_t *ek,
+  uint8_t *k
+)
+{
+  switch (a)
+  {
+    case Spec_Agile_AEAD_AES128_GCM:
+    case Spec_Agile_AEAD_AES256_GCM:
+      {
+        #if EVERCRYPT_TARGETCONFIG_X64
+        if (a == Spec_Agile_AEAD_AES128_GCM)
+        {
+          memset(ek, 0U, EverCrypt_AEAD_Inline_EK_LEN_AES128_GCM);
+          aes128_key_expansion(k, ek);
+          aes128_keyhash_init(ek, ek + (uint32_t)176U);
+          dst->impl = Spec_Cipher_Expansion_Vale_AES128;
+        }
+        else
+        {
+          memset(ek, 0U, EverCrypt_AEAD_Inline_EK_LEN_AES256_GCM);
+          aes256_key_expansion(k, ek);
+          aes256_keyhash_init(ek, ek + (uint32_t)240U);
+          dst->impl = Spec_Cipher_Expansion_Vale_AES256;
+        }
+        dst->ek = ek;
+        return EverCrypt_Error_Success;
+        #else
+        return EverCrypt_Error_UnsupportedAlgorithm;
+        #endif
+      }
+    case Spec_Agile_AEAD_CHACHA20_POLY1305:
+      {
+        memcpy(ek, k, (uint32_t)32U * sizeof (uint8_t));
+        dst->impl = Spec_Cipher_Expansion_Hacl_CHACHA20;
+        dst->ek = ek;
+        return EverCrypt_Error_Success;
+      }
+    default:
+      {
+        return EverCrypt_Error_UnsupportedAlgorithm;
+      }
+  }
+}
+
+EverCrypt_Error_error_code
+EverCrypt_AEAD_Inline_encrypt(
+  EverCrypt_AEAD_Inline_state *s,
+  uint8_t *iv,
+  uint32_t iv_len,
+  uint8_t *ad,
+  uint32_t ad_len,
+  uint8_t *plain,
+  uint32_t plain_len,
+  uint8_t *cipher,
+  uint8_t *tag
+)
+{
+  return EverCrypt_AEAD_encrypt((EverCrypt_AEAD_state_s *)s,
+    iv, iv_len, ad, ad_len, plain, plain_len, cipher, tag);
+}
+
+EverCrypt_Error_error_code
+EverCrypt_AEAD_Inline_decrypt(
+  EverCrypt_AEAD_Inline_state *s,
+  uint8_t *iv,
+  uint32_t iv_len,
+  uint8_t *ad,
+  uint32_t ad_len,
+  uint8_t *cipher,
+  uint32_t cipher_len,
+  uint8_t *tag,
+  uint8_t *dst
+)
+{
+  return EverCrypt_AEAD_decrypt((EverCrypt_AEAD_state_s *)s,
+    iv, iv_len, ad, ad_len, cipher, cipher_len, tag, dst);
+}
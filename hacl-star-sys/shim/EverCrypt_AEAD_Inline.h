@@ -0,0 +1,115 @@
+/* EverCrypt_AEAD states owned by the caller: the key is expanded into caller
+ * memory instead of the KRML_HOST_MALLOC'd buffers of EverCrypt_AEAD_create_in,
+ * and nothing needs EverCrypt_AEAD_free. The cpu checks EverCrypt makes on
+ * every call are exposed instead, for the caller to make once. */
+
+#ifndef __EverCrypt_AEAD_Inline_H
+#define __EverCrypt_AEAD_Inline_H
+
+#include "EverCrypt_AEAD.h"
+
+/* Expanded key bytes (key schedule, GHASH keys and scratch) per algorithm. */
+#define EverCrypt_AEAD_Inline_EK_LEN_AES128_GCM 480
+#define EverCrypt_AEAD_Inline_EK_LEN_AES256_GCM 544
+#define EverCrypt_AEAD_Inline_EK_LEN_CHACHA20_POLY1305 32
+
+/* Hacl_Chacha20Poly1305_32_aead_encrypt, or a vectorized kernel with the same
+ * output. */
+typedef void
+(*EverCrypt_AEAD_Inline_chacha20poly1305_encrypt)(
+  uint8_t *k,
+  uint8_t *n,
+  uint32_t aadlen,
+  uint8_t *aad,
+  uint32_t mlen,
+  uint8_t *m,
+  uint8_t *cipher,
+  uint8_t *mac
+);
+
+/* Hacl_Chacha20Poly1305_32_aead_decrypt, or a vectorized kernel: 0 if `mac`
+ * verifies. */
+typedef uint32_t
+(*EverCrypt_AEAD_Inline_chacha20poly1305_decrypt)(
+  uint8_t *k,
+  uint8_t *n,
+  uint32_t aadlen,
+  uint8_t *aad,
+  uint32_t mlen,
+  uint8_t *m,
+  uint8_t *cipher,
+  uint8_t *mac
+);
+
+/* Same layout as EverCrypt_AEAD_state_s, which the header keeps opaque. */
+typedef struct EverCrypt_AEAD_Inline_state_s
+{
+  Spec_Cipher_Expansion_impl impl;
+  uint8_t *ek;
+}
+EverCrypt_AEAD_Inline_state;
+
+/* The functions below read EverCrypt_AutoConfig2 on x86_64, so they are only
+ * meaningful once EverCrypt_AutoConfig2_init has run, and reflect features
+ * disabled since. */
+
+/* Whether the Vale AES-GCM kernels can run: AES-NI, PCLMULQDQ, AVX, SSE and
+ * MOVBE, as in EverCrypt_AEAD_create_in. */
+bool EverCrypt_AEAD_Inline_has_aes_gcm(void);
+
+/* Lanes of the ChaCha20-Poly1305 kernels: 8 (AVX2), 4 (AVX, NEON, wasm simd128)
+ * or 1. */
+uint32_t EverCrypt_AEAD_Inline_chacha20poly1305_lanes(void);
+
+/* Kernels of EverCrypt_AEAD_Inline_chacha20poly1305_lanes. */
+EverCrypt_AEAD_Inline_chacha20poly1305_encrypt
+EverCrypt_AEAD_Inline_chacha20poly1305_encrypt_kernel(void);
+
+EverCrypt_AEAD_Inline_chacha20poly1305_decrypt
+EverCrypt_AEAD_Inline_chacha20poly1305_decrypt_kernel(void);
+
+/* Like EverCrypt_AEAD_create_in, but expands `k` into `ek`, which must hold
+ * EverCrypt_AEAD_Inline_EK_LEN_* bytes, 16-byte aligned, and sets `*dst` to it.
+ * The cpu is not checked: AES-GCM keys must only be expanded where
+ * EverCrypt_AEAD_Inline_has_aes_gcm holds (other targets get
+ * UnsupportedAlgorithm). */
+EverCrypt_Error_error_code
+EverCrypt_AEAD_Inline_init(
+  Spec_Agile_AEAD_alg a,
+  EverCrypt_AEAD_Inline_state *dst,
+  uint8_t *ek,
+  uint8_t *k
+);
+
+/* EverCrypt_AEAD_encrypt on a caller-owned state. The scratch part of `ek` is
+ * written, so a state must not be used by two calls at once. A ChaCha20-Poly1305
+ * state takes EverCrypt's per-call kernel choice here; `ek` can be passed to the
+ * kernels above instead. */
+EverCrypt_Error_error_code
+EverCrypt_AEAD_Inline_encrypt(
+  EverCrypt_AEAD_Inline_state *s,
+  uint8_t *iv,
+  uint32_t iv_len,
+  uint8_t *ad,
+  uint32_t ad_len,
+  uint8_t *plain,
+  uint32_t plain_len,
+  uint8_t *cipher,
+  uint8_t *tag
+);
+
+/* EverCrypt_AEAD_decrypt on a caller-owned state. */
+EverCrypt_Error_error_code
+EverCrypt_AEAD_Inline_decrypt(
+  EverCrypt_AEAD_Inline_state *s,
+  uint8_t *iv,
+  uint32_t iv_len,
+  uint8_t *ad,
+  uint32_t ad_len,
+  uint8_t *cipher,
+  uint32_t cipher_len,
+  uint8_t *tag,
+  uint8_t *dst
+);
+
+#endif
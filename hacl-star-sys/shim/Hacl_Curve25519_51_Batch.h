@@ -0,0 +1,16 @@
+/* Entry points into the static Montgomery ladder of Hacl_Curve25519_51.c,
+ * for callers that normalize many projective results with one inversion. */
+
+#ifndef __Hacl_Curve25519_51_Batch_H
+#define __Hacl_Curve25519_51_Batch_H
+
+#include "Hacl_Curve25519_51.h"
+
+/* Runs the ladder of `Hacl_Curve25519_51_scalarmult` and leaves the result
+ * projective: out[0..5] = X, out[5..10] = Z, both in 51-bit limbs. */
+void Hacl_Curve25519_51_ladder(uint64_t *out, uint8_t *priv, uint8_t *pub);
+
+/* Encodes a field element (the affine u coordinate) into 32 bytes. */
+void Hacl_Curve25519_51_store(uint8_t *o, uint64_t *f);
+
+#endif
@@ -0,0 +1,24 @@
+/* Pieces of Hacl_Ed25519.c for signatures whose hashes are computed by the
+ * caller: Ed25519ph and Ed25519ctx (RFC 8032, section 5.1) prepend dom2 to
+ * every hash, and a prehash can be streamed instead of held in one buffer. */
+
+#ifndef __Hacl_Ed25519_Ctx_H
+#define __Hacl_Ed25519_Ctx_H
+
+#include "Hacl_Ed25519.h"
+
+/* Reduces a 64-byte SHA-512 output modulo the group order into 32 bytes. */
+void Hacl_Ed25519_Ctx_reduce(uint8_t *out, uint8_t *hash);
+
+/* Compresses [s]B for a 32-byte scalar s. */
+void Hacl_Ed25519_Ctx_point_mul_g_compress(uint8_t *out, uint8_t *s);
+
+/* Computes S = r + h * a modulo the group order, where r and h are reduced
+ * and a is the expanded secret scalar. */
+void Hacl_Ed25519_Ctx_sign_finish(uint8_t *s, uint8_t *r, uint8_t *h, uint8_t *a);
+
+/* Hacl_Ed25519_verify with the challenge h = SHA-512(dom2 || R || A || M)
+ * already reduced by the caller. */
+bool Hacl_Ed25519_Ctx_verify_finish(uint8_t *pub, uint8_t *signature, uint8_t *h);
+
+#endif
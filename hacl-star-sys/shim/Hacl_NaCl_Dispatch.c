@@ -0,0 +1,305 @@
+/* Compiled in place of Hacl_NaCl.c, which is included verbatim, so that the
+ * secretbox below can reuse its secretbox_init. HSalsa20 and the first block,
+ * which give the Poly1305 key, stay scalar. Hacl_Salsa20.c is included here
+ * too, since its statics clash with Hacl_Chacha20.c in a unity build. */
+
+#include "Hacl_Salsa20.c"
+#include "Hacl_NaCl.c"
+#include "Hacl_NaCl_Dispatch.h"
+#include "EverCrypt_AutoConfig2.h"
+
+#if EVERCRYPT_TARGETCONFIG_X64
+/* for poly1305_vale */
+#include "EverCrypt_Poly1305.c"
+#include "Hacl_Salsa20_Vec128.h"
+#include "Hacl_Salsa20_Vec256.h"
+#elif defined(__aarch64__) || defined(__wasm_simd128__)
+#include "Hacl_Poly1305_128.h"
+#include "Hacl_Salsa20_Vec128.h"
+#endif
+
+uint32_t Hacl_NaCl_Dispatch_salsa20_lanes(void)
+{
+  #if EVERCRYPT_TARGETCONFIG_X64
+  if (EverCrypt_AutoConfig2_has_avx2())
+  {
+    return (uint32_t)8U;
+  }
+  if (EverCrypt_AutoConfig2_has_avx())
+  {
+    return (uint32_t)4U;
+  }
+  return (uint32_t)1U;
+  #elif defined(__aarch64__) || defined(__wasm_simd128__)
+  return (uint32_t)4U;
+  #else
+  return (uint32_t)1U;
+  #endif
+}
+
+uint32_t Hacl_NaCl_Dispatch_poly1305(void)
+{
+  #if EVERCRYPT_TARGETCONFIG_X64
+  if (EverCrypt_AutoConfig2_has_avx2())
+  {
+    return Hacl_NaCl_Dispatch_POLY1305_VEC256;
+  }
+  if (EverCrypt_AutoConfig2_has_avx())
+  {
+    return Hacl_NaCl_Dispatch_POLY1305_VEC128;
+  }
+  if (EverCrypt_AutoConfig2_wants_vale())
+  {
+    return Hacl_NaCl_Dispatch_POLY1305_VALE;
+  }
+  return Hacl_NaCl_Dispatch_POLY1305_PORTABLE;
+  #elif defined(__aarch64__) || defined(__wasm_simd128__)
+  return Hacl_NaCl_Dispatch_POLY1305_VEC128;
+  #else
+  return Hacl_NaCl_Dispatch_POLY1305_PORTABLE;
+  #endif
+}
+
+uint32_t Hacl_NaCl_Dispatch_poly1305_short(void)
+{
+  uint32_t impl = Hacl_NaCl_Dispatch_poly1305();
+  #if EVERCRYPT_TARGETCONFIG_X64
+  if (impl != Hacl_NaCl_Dispatch_POLY1305_PORTABLE && EverCrypt_AutoConfig2_wants_vale())
+  {
+    return Hacl_NaCl_Dispatch_POLY1305_VALE;
+  }
+  #endif
+  return impl;
+}
+
+/* A wide kernel computes whole groups of blocks, so short inputs stay on a
+ * narrower one: below about one group the padding costs more than the lanes
+ * gain. */
+#if EVERCRYPT_TARGETCONFIG_X64
+static void
+salsa20_256(uint32_t len, uint8_t *out, uint8_t *text, uint8_t *key, uint8_t *n, uint32_t ctr)
+{
+  if (len > (uint32_t)256U)
+  {
+    Hacl_Salsa20_Vec256_salsa20_encrypt_256(len, out, text, key, n, ctr);
+    return;
+  }
+  if (len > (uint32_t)64U)
+  {
+    Hacl_Salsa20_Vec128_salsa20_encrypt_128(len, out, text, key, n, ctr);
+    return;
+  }
+  Hacl_Salsa20_salsa20_encrypt(len, out, text, key, n, ctr);
+}
+#endif
+
+#if EVERCRYPT_TARGETCONFIG_X64 || defined(__aarch64__) || defined(__wasm_simd128__)
+static void
+salsa20_128(uint32_t len, uint8_t *out, uint8_t *text, uint8_t *key, uint8_t *n, uint32_t ctr)
+{
+  if (len > (uint32_t)64U)
+  {
+    Hacl_Salsa20_Vec128_salsa20_encrypt_128(len, out, text, key, n, ctr);
+    return;
+  }
+  Hacl_Salsa20_salsa20_encrypt(len, out, text, key, n, ctr);
+}
+#endif
+
+Hacl_NaCl_Dispatch_salsa20_xor Hacl_NaCl_Dispatch_salsa20_kernel(void)
+{
+  switch (Hacl_NaCl_Dispatch_salsa20_lanes())
+  {
+    #if EVERCRYPT_TARGETCONFIG_X64
+    case 8U:
+      {
+        return salsa20_256;
+      }
+    #endif
+    #if EVERCRYPT_TARGETCONFIG_X64 || defined(__aarch64__) || defined(__wasm_simd128__)
+    case 4U:
+      {
+        return salsa20_128;
+      }
+    #endif
+    default:
+      {
+        return Hacl_Salsa20_salsa20_encrypt;
+      }
+  }
+}
+
+/* The vector kernels start by computing powers of r, which below about 1 KiB
+ * costs more than the Vale kernel spends on the whole message. */
+#if EVERCRYPT_TARGETCONFIG_X64
+static void poly1305_mac_vale(uint8_t *tag, uint32_t len, uint8_t *text, uint8_t *key)
+{
+  poly1305_vale(tag, text, len, key);
+}
+
+static void poly1305_mac_vale_256(uint8_t *tag, uint32_t len, uint8_t *text, uint8_t *key)
+{
+  if (len < (uint32_t)1024U)
+  {
+    poly1305_vale(tag, text, len, key);
+    return;
+  }
+  Hacl_Poly1305_256_poly1305_mac(tag, len, text, key);
+}
+
+static void poly1305_mac_vale_128(uint8_t *tag, uint32_t len, uint8_t *text, uint8_t *key)
+{
+  if (len < (uint32_t)1024U)
+  {
+    poly1305_vale(tag, text, len, key);
+    return;
+  }
+  Hacl_Poly1305_128_poly1305_mac(tag, len, text, key);
+}
+#endif
+
+Hacl_NaCl_Dispatch_poly1305_mac Hacl_NaCl_Dispatch_poly1305_kernel(void)
+{
+  uint32_t impl = Hacl_NaCl_Dispatch_poly1305();
+  #if EVERCRYPT_TARGETCONFIG_X64
+  uint32_t short_impl = Hacl_NaCl_Dispatch_poly1305_short();
+  #endif
+  switch (impl)
+  {
+    #if EVERCRYPT_TARGETCONFIG_X64
+    case Hacl_NaCl_Dispatch_POLY1305_VEC256:
+      {
+        if (short_impl == Hacl_NaCl_Dispatch_POLY1305_VALE)
+        {
+          return poly1305_mac_vale_256;
+        }
+        return Hacl_Poly1305_256_poly1305_mac;
+      }
+    case Hacl_NaCl_Dispatch_POLY1305_VALE:
+      {
+        return poly1305_mac_vale;
+      }
+    #endif
+    #if EVERCRYPT_TARGETCONFIG_X64 || defined(__aarch64__) || defined(__wasm_simd128__)
+    case Hacl_NaCl_Dispatch_POLY1305_VEC128:
+      {
+        #if EVERCRYPT_TARGETCONFIG_X64
+        if (short_impl == Hacl_NaCl_Dispatch_POLY1305_VALE)
+        {
+          return poly1305_mac_vale_128;
+        }
+        #endif
+        return Hacl_Poly1305_128_poly1305_mac;
+      }
+    #endif
+    default:
+      {
+        return Hacl_Poly1305_32_poly1305_mac;
+      }
+  }
+}
+
+/* secretbox_detached and secretbox_open_detached of Hacl_NaCl.c, with the
+ * Salsa20 after the first block and the Poly1305 done by the given kernels. */
+void
+Hacl_NaCl_Dispatch_secretbox_detached(
+  Hacl_NaCl_Dispatch_salsa20_xor salsa20_xor,
+  Hacl_NaCl_Dispatch_poly1305_mac poly1305_mac,
+  uint8_t *c,
+  uint8_t *tag,
+  uint8_t *m,
+  uint32_t mlen,
+  uint8_t *n,
+  uint8_t *k
+)
+{
+  uint8_t xkeys[96U] = { 0U };
+  secretbox_init(xkeys, k, n);
+  uint8_t *mkey = xkeys + (uint32_t)32U;
+  uint8_t *n1 = n + (uint32_t)16U;
+  uint8_t *subkey = xkeys;
+  uint8_t *ekey0 = xkeys + (uint32_t)64U;
+  uint32_t mlen0;
+  if (mlen <= (uint32_t)32U)
+  {
+    mlen0 = mlen;
+  }
+  else
+  {
+    mlen0 = (uint32_t)32U;
+  }
+  uint32_t mlen1 = mlen - mlen0;
+  uint8_t *m0 = m;
+  uint8_t *m1 = m + mlen0;
+  uint8_t block0[32U] = { 0U };
+  memcpy(block0, m0, mlen0 * sizeof (uint8_t));
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)32U; i++)
+  {
+    uint8_t *os = block0;
+    uint8_t x = block0[i] ^ ekey0[i];
+    os[i] = x;
+  }
+  uint8_t *c0 = c;
+  uint8_t *c1 = c + mlen0;
+  memcpy(c0, block0, mlen0 * sizeof (uint8_t));
+  salsa20_xor(mlen1, c1, m1, subkey, n1, (uint32_t)1U);
+  poly1305_mac(tag, mlen, c, mkey);
+}
+
+uint32_t
+Hacl_NaCl_Dispatch_secretbox_open_detached(
+  Hacl_NaCl_Dispatch_salsa20_xor salsa20_xor,
+  Hacl_NaCl_Dispatch_poly1305_mac poly1305_mac,
+  uint8_t *m,
+  uint8_t *c,
+  uint8_t *tag,
+  uint32_t mlen,
+  uint8_t *n,
+  uint8_t *k
+)
+{
+  uint8_t xkeys[96U] = { 0U };
+  secretbox_init(xkeys, k, n);
+  uint8_t *mkey = xkeys + (uint32_t)32U;
+  uint8_t tag_[16U] = { 0U };
+  poly1305_mac(tag_, mlen, c, mkey);
+  uint8_t res = (uint8_t)255U;
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)16U; i++)
+  {
+    uint8_t uu____0 = FStar_UInt8_eq_mask(tag[i], tag_[i]);
+    res = uu____0 & res;
+  }
+  uint8_t z = res;
+  if (z == (uint8_t)255U)
+  {
+    uint8_t *subkey = xkeys;
+    uint8_t *ekey0 = xkeys + (uint32_t)64U;
+    uint8_t *n1 = n + (uint32_t)16U;
+    uint32_t mlen0;
+    if (mlen <= (uint32_t)32U)
+    {
+      mlen0 = mlen;
+    }
+    else
+    {
+      mlen0 = (uint32_t)32U;
+    }
+    uint32_t mlen1 = mlen - mlen0;
+    uint8_t *c0 = c;
+    uint8_t *c1 = c + mlen0;
+    uint8_t block0[32U] = { 0U };
+    memcpy(block0, c0, mlen0 * sizeof (uint8_t));
+    for (uint32_t i = (uint32_t)0U; i < (uint32_t)32U; i++)
+    {
+      uint8_t *os = block0;
+      uint8_t x = block0[i] ^ ekey0[i];
+      os[i] = x;
+    }
+    uint8_t *m0 = m;
+    uint8_t *m1 = m + mlen0;
+    memcpy(m0, block0, mlen0 * sizeof (uint8_t));
+    salsa20_xor(mlen1, m1, c1, subkey, n1, (uint32_t)1U);
+    return (uint32_t)0U;
+  }
+  return (uint32_t)0xffffffffU;
+}
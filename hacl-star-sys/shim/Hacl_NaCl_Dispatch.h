@@ -0,0 +1,78 @@
+/* NaCl secretbox with its Salsa20 and Poly1305 kernels passed in by the caller,
+ * which picks them once among the portable, vectorized and (for Poly1305) Vale
+ * ones. The Hacl_NaCl_crypto_* functions stay those of Hacl_NaCl.c. */
+
+#ifndef __Hacl_NaCl_Dispatch_H
+#define __Hacl_NaCl_Dispatch_H
+
+#include "Hacl_NaCl.h"
+
+/* Poly1305 kernels, in the order of hacl_star_sys::dispatch::Poly1305. */
+#define Hacl_NaCl_Dispatch_POLY1305_PORTABLE 0U
+#define Hacl_NaCl_Dispatch_POLY1305_VALE 1U
+#define Hacl_NaCl_Dispatch_POLY1305_VEC128 2U
+#define Hacl_NaCl_Dispatch_POLY1305_VEC256 3U
+
+/* Hacl_Salsa20_salsa20_encrypt, or a vectorized kernel with the same output. */
+typedef void
+(*Hacl_NaCl_Dispatch_salsa20_xor)(
+  uint32_t len,
+  uint8_t *out,
+  uint8_t *text,
+  uint8_t *key,
+  uint8_t *n,
+  uint32_t ctr
+);
+
+/* Hacl_Poly1305_32_poly1305_mac, or another kernel with the same output. */
+typedef void
+(*Hacl_NaCl_Dispatch_poly1305_mac)(uint8_t *tag, uint32_t len, uint8_t *text, uint8_t *key);
+
+/* The functions below read EverCrypt_AutoConfig2 on x86_64, so they are only
+ * meaningful once EverCrypt_AutoConfig2_init has run, and reflect features
+ * disabled since. */
+
+/* Blocks per Salsa20 kernel call: 8 (AVX2), 4 (AVX, NEON, wasm simd128) or 1. */
+uint32_t Hacl_NaCl_Dispatch_salsa20_lanes(void);
+
+/* Poly1305 kernel, one of Hacl_NaCl_Dispatch_POLY1305_*: on x86_64 the order of
+ * EverCrypt_Poly1305_poly1305 (AVX2, AVX, Vale, portable) under the same flags;
+ * vec128 on aarch64 and wasm simd128, where it is baseline. */
+uint32_t Hacl_NaCl_Dispatch_poly1305(void);
+
+/* Poly1305 kernel of Hacl_NaCl_Dispatch_poly1305_kernel for messages under 1 KiB:
+ * Vale instead of a vector kernel whenever it is enabled, else the same. */
+uint32_t Hacl_NaCl_Dispatch_poly1305_short(void);
+
+/* Kernel of Hacl_NaCl_Dispatch_salsa20_lanes; shorter inputs stay on a
+ * narrower one (up to 64 bytes scalar, up to 256 bytes at most 4 lanes). */
+Hacl_NaCl_Dispatch_salsa20_xor Hacl_NaCl_Dispatch_salsa20_kernel(void);
+
+/* Kernel of Hacl_NaCl_Dispatch_poly1305 and Hacl_NaCl_Dispatch_poly1305_short. */
+Hacl_NaCl_Dispatch_poly1305_mac Hacl_NaCl_Dispatch_poly1305_kernel(void);
+
+void
+Hacl_NaCl_Dispatch_secretbox_detached(
+  Hacl_NaCl_Dispatch_salsa20_xor salsa20_xor,
+  Hacl_NaCl_Dispatch_poly1305_mac poly1305_mac,
+  uint8_t *c,
+  uint8_t *tag,
+  uint8_t *m,
+  uint32_t mlen,
+  uint8_t *n,
+  uint8_t *k
+);
+
+uint32_t
+Hacl_NaCl_Dispatch_secretbox_open_detached(
+  Hacl_NaCl_Dispatch_salsa20_xor salsa20_xor,
+  Hacl_NaCl_Dispatch_poly1305_mac poly1305_mac,
+  uint8_t *m,
+  uint8_t *c,
+  uint8_t *tag,
+  uint32_t mlen,
+  uint8_t *n,
+  uint8_t *k
+);
+
+#endif
@@ -0,0 +1,209 @@
+/* Four SHA-512 streams in the lanes of one set of vec256 registers: the 80
+ * rounds of a block run once for all four. The state and the blocks are moved
+ * between the per-input layout and the lanes with 4x4 transposes of 64-bit
+ * words, so a block costs four 32-byte loads per lane, and four blocks take
+ * about the time Hacl_Hash_SHA2_update_multi_512 spends on one. */
+
+#include "Hacl_SHA2_Vec256.h"
+
+static const
+uint64_t
+k384_512_256[80U] =
+  {
+    (uint64_t)0x428a2f98d728ae22U, (uint64_t)0x7137449123ef65cdU, (uint64_t)0xb5c0fbcfec4d3b2fU,
+    (uint64_t)0xe9b5dba58189dbbcU, (uint64_t)0x3956c25bf348b538U, (uint64_t)0x59f111f1b605d019U,
+    (uint64_t)0x923f82a4af194f9bU, (uint64_t)0xab1c5ed5da6d8118U, (uint64_t)0xd807aa98a3030242U,
+    (uint64_t)0x12835b0145706fbeU, (uint64_t)0x243185be4ee4b28cU, (uint64_t)0x550c7dc3d5ffb4e2U,
+    (uint64_t)0x72be5d74f27b896fU, (uint64_t)0x80deb1fe3b1696b1U, (uint64_t)0x9bdc06a725c71235U,
+    (uint64_t)0xc19bf174cf692694U, (uint64_t)0xe49b69c19ef14ad2U, (uint64_t)0xefbe4786384f25e3U,
+    (uint64_t)0x0fc19dc68b8cd5b5U, (uint64_t)0x240ca1cc77ac9c65U, (uint64_t)0x2de92c6f592b0275U,
+    (uint64_t)0x4a7484aa6ea6e483U, (uint64_t)0x5cb0a9dcbd41fbd4U, (uint64_t)0x76f988da831153b5U,
+    (uint64_t)0x983e5152ee66dfabU, (uint64_t)0xa831c66d2db43210U, (uint64_t)0xb00327c898fb213fU,
+    (uint64_t)0xbf597fc7beef0ee4U, (uint64_t)0xc6e00bf33da88fc2U, (uint64_t)0xd5a79147930aa725U,
+    (uint64_t)0x06ca6351e003826fU, (uint64_t)0x142929670a0e6e70U, (uint64_t)0x27b70a8546d22ffcU,
+    (uint64_t)0x2e1b21385c26c926U, (uint64_t)0x4d2c6dfc5ac42aedU, (uint64_t)0x53380d139d95b3dfU,
+    (uint64_t)0x650a73548baf63deU, (uint64_t)0x766a0abb3c77b2a8U, (uint64_t)0x81c2c92e47edaee6U,
+    (uint64_t)0x92722c851482353bU, (uint64_t)0xa2bfe8a14cf10364U, (uint64_t)0xa81a664bbc423001U,
+    (uint64_t)0xc24b8b70d0f89791U, (uint64_t)0xc76c51a30654be30U, (uint64_t)0xd192e819d6ef5218U,
+    (uint64_t)0xd69906245565a910U, (uint64_t)0xf40e35855771202aU, (uint64_t)0x106aa07032bbd1b8U,
+    (uint64_t)0x19a4c116b8d2d0c8U, (uint64_t)0x1e376c085141ab53U, (uint64_t)0x2748774cdf8eeb99U,
+    (uint64_t)0x34b0bcb5e19b48a8U, (uint64_t)0x391c0cb3c5c95a63U, (uint64_t)0x4ed8aa4ae3418acbU,
+    (uint64_t)0x5b9cca4f7763e373U, (uint64_t)0x682e6ff3d6b2b8a3U, (uint64_t)0x748f82ee5defb2fcU,
+    (uint64_t)0x78a5636f43172f60U, (uint64_t)0x84c87814a1f0ab72U, (uint64_t)0x8cc702081a6439ecU,
+    (uint64_t)0x90befffa23631e28U, (uint64_t)0xa4506cebde82bde9U, (uint64_t)0xbef9a3f7b2c67915U,
+    (uint64_t)0xc67178f2e372532bU, (uint64_t)0xca273eceea26619cU, (uint64_t)0xd186b8c721c0c207U,
+    (uint64_t)0xeada7dd6cde0eb1eU, (uint64_t)0xf57d4f7fee6ed178U, (uint64_t)0x06f067aa72176fbaU,
+    (uint64_t)0x0a637dc5a2c898a6U, (uint64_t)0x113f9804bef90daeU, (uint64_t)0x1b710b35131c471bU,
+    (uint64_t)0x28db77f523047d84U, (uint64_t)0x32caab7b40c72493U, (uint64_t)0x3c9ebe0a15c9bebcU,
+    (uint64_t)0x431d67c49c100d4cU, (uint64_t)0x4cc5d4becb3e42b6U, (uint64_t)0x597f299cfc657e2aU,
+    (uint64_t)0x5fcb6fab3ad6faecU, (uint64_t)0x6c44198c4a475817U
+  };
+
+/* r[l] holds words 0..3 of row l on entry and the four words of column l (lane l
+ * of every row) on exit. */
+static inline void transpose4x4_64(Lib_IntVector_Intrinsics_vec256 *r)
+{
+  Lib_IntVector_Intrinsics_vec256
+  t0 = Lib_IntVector_Intrinsics_vec256_interleave_low64(r[0U], r[1U]);
+  Lib_IntVector_Intrinsics_vec256
+  t1 = Lib_IntVector_Intrinsics_vec256_interleave_high64(r[0U], r[1U]);
+  Lib_IntVector_Intrinsics_vec256
+  t2 = Lib_IntVector_Intrinsics_vec256_interleave_low64(r[2U], r[3U]);
+  Lib_IntVector_Intrinsics_vec256
+  t3 = Lib_IntVector_Intrinsics_vec256_interleave_high64(r[2U], r[3U]);
+  r[0U] = Lib_IntVector_Intrinsics_vec256_interleave_low128(t0, t2);
+  r[1U] = Lib_IntVector_Intrinsics_vec256_interleave_low128(t1, t3);
+  r[2U] = Lib_IntVector_Intrinsics_vec256_interleave_high128(t0, t2);
+  r[3U] = Lib_IntVector_Intrinsics_vec256_interleave_high128(t1, t3);
+}
+
+static inline Lib_IntVector_Intrinsics_vec256
+big_sigma0_512(Lib_IntVector_Intrinsics_vec256 x)
+{
+  return
+    Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_rotate_right64(x,
+        (uint32_t)28U),
+      Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_rotate_right64(x,
+          (uint32_t)34U),
+        Lib_IntVector_Intrinsics_vec256_rotate_right64(x, (uint32_t)39U)));
+}
+
+static inline Lib_IntVector_Intrinsics_vec256
+big_sigma1_512(Lib_IntVector_Intrinsics_vec256 x)
+{
+  return
+    Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_rotate_right64(x,
+        (uint32_t)14U),
+      Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_rotate_right64(x,
+          (uint32_t)18U),
+        Lib_IntVector_Intrinsics_vec256_rotate_right64(x, (uint32_t)41U)));
+}
+
+static inline Lib_IntVector_Intrinsics_vec256
+small_sigma0_512(Lib_IntVector_Intrinsics_vec256 x)
+{
+  return
+    Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_rotate_right64(x,
+        (uint32_t)1U),
+      Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_rotate_right64(x,
+          (uint32_t)8U),
+        Lib_IntVector_Intrinsics_vec256_shift_right64(x, (uint32_t)7U)));
+}
+
+static inline Lib_IntVector_Intrinsics_vec256
+small_sigma1_512(Lib_IntVector_Intrinsics_vec256 x)
+{
+  return
+    Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_rotate_right64(x,
+        (uint32_t)19U),
+      Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_rotate_right64(x,
+          (uint32_t)61U),
+        Lib_IntVector_Intrinsics_vec256_shift_right64(x, (uint32_t)6U)));
+}
+
+/* One block in every lane: word i of blocks[l] goes to lane l of ws[i]. */
+static inline void update_4(Lib_IntVector_Intrinsics_vec256 *hash, uint8_t **blocks)
+{
+  Lib_IntVector_Intrinsics_vec256 ws[80U];
+  for (uint32_t j = (uint32_t)0U; j < (uint32_t)4U; j++)
+  {
+    for (uint32_t l = (uint32_t)0U; l < (uint32_t)4U; l++)
+    {
+      ws[(uint32_t)4U * j + l] =
+        Lib_IntVector_Intrinsics_vec256_load64_be(blocks[l] + (uint32_t)32U * j);
+    }
+    transpose4x4_64(ws + (uint32_t)4U * j);
+  }
+  for (uint32_t i = (uint32_t)16U; i < (uint32_t)80U; i++)
+  {
+    Lib_IntVector_Intrinsics_vec256
+    t0 =
+      Lib_IntVector_Intrinsics_vec256_add64(small_sigma1_512(ws[i - (uint32_t)2U]),
+        ws[i - (uint32_t)7U]);
+    Lib_IntVector_Intrinsics_vec256
+    t1 =
+      Lib_IntVector_Intrinsics_vec256_add64(small_sigma0_512(ws[i - (uint32_t)15U]),
+        ws[i - (uint32_t)16U]);
+    ws[i] = Lib_IntVector_Intrinsics_vec256_add64(t0, t1);
+  }
+  Lib_IntVector_Intrinsics_vec256 a = hash[0U];
+  Lib_IntVector_Intrinsics_vec256 b = hash[1U];
+  Lib_IntVector_Intrinsics_vec256 c = hash[2U];
+  Lib_IntVector_Intrinsics_vec256 d = hash[3U];
+  Lib_IntVector_Intrinsics_vec256 e = hash[4U];
+  Lib_IntVector_Intrinsics_vec256 f = hash[5U];
+  Lib_IntVector_Intrinsics_vec256 g = hash[6U];
+  Lib_IntVector_Intrinsics_vec256 h = hash[7U];
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)80U; i++)
+  {
+    /* ch = g ^ (e & (f ^ g)), maj = (a & b) ^ (c & (a ^ b)) */
+    Lib_IntVector_Intrinsics_vec256
+    ch =
+      Lib_IntVector_Intrinsics_vec256_xor(g,
+        Lib_IntVector_Intrinsics_vec256_and(e, Lib_IntVector_Intrinsics_vec256_xor(f, g)));
+    Lib_IntVector_Intrinsics_vec256
+    maj =
+      Lib_IntVector_Intrinsics_vec256_xor(Lib_IntVector_Intrinsics_vec256_and(a, b),
+        Lib_IntVector_Intrinsics_vec256_and(c, Lib_IntVector_Intrinsics_vec256_xor(a, b)));
+    Lib_IntVector_Intrinsics_vec256
+    kw =
+      Lib_IntVector_Intrinsics_vec256_add64(Lib_IntVector_Intrinsics_vec256_load64(k384_512_256[i]),
+        ws[i]);
+    Lib_IntVector_Intrinsics_vec256
+    t1 =
+      Lib_IntVector_Intrinsics_vec256_add64(Lib_IntVector_Intrinsics_vec256_add64(h,
+          big_sigma1_512(e)),
+        Lib_IntVector_Intrinsics_vec256_add64(ch, kw));
+    Lib_IntVector_Intrinsics_vec256
+    t2 = Lib_IntVector_Intrinsics_vec256_add64(big_sigma0_512(a), maj);
+    h = g;
+    g = f;
+    f = e;
+    e = Lib_IntVector_Intrinsics_vec256_add64(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = Lib_IntVector_Intrinsics_vec256_add64(t1, t2);
+  }
+  hash[0U] = Lib_IntVector_Intrinsics_vec256_add64(hash[0U], a);
+  hash[1U] = Lib_IntVector_Intrinsics_vec256_add64(hash[1U], b);
+  hash[2U] = Lib_IntVector_Intrinsics_vec256_add64(hash[2U], c);
+  hash[3U] = Lib_IntVector_Intrinsics_vec256_add64(hash[3U], d);
+  hash[4U] = Lib_IntVector_Intrinsics_vec256_add64(hash[4U], e);
+  hash[5U] = Lib_IntVector_Intrinsics_vec256_add64(hash[5U], f);
+  hash[6U] = Lib_IntVector_Intrinsics_vec256_add64(hash[6U], g);
+  hash[7U] = Lib_IntVector_Intrinsics_vec256_add64(hash[7U], h);
+}
+
+void Hacl_SHA2_Vec256_sha512_update_multi_4(uint64_t **st, uint8_t **blocks, uint32_t n_blocks)
+{
+  /* hash[i] holds word i of every state, the layout of ws */
+  Lib_IntVector_Intrinsics_vec256 hash[8U];
+  for (uint32_t j = (uint32_t)0U; j < (uint32_t)2U; j++)
+  {
+    for (uint32_t l = (uint32_t)0U; l < (uint32_t)4U; l++)
+    {
+      hash[(uint32_t)4U * j + l] =
+        Lib_IntVector_Intrinsics_vec256_load_le((uint8_t *)(st[l] + (uint32_t)4U * j));
+    }
+    transpose4x4_64(hash + (uint32_t)4U * j);
+  }
+  for (uint32_t i = (uint32_t)0U; i < n_blocks; i++)
+  {
+    uint8_t *b[4U];
+    for (uint32_t l = (uint32_t)0U; l < (uint32_t)4U; l++)
+    {
+      b[l] = blocks[l] + i * (uint32_t)128U;
+    }
+    update_4(hash, b);
+  }
+  for (uint32_t j = (uint32_t)0U; j < (uint32_t)2U; j++)
+  {
+    transpose4x4_64(hash + (uint32_t)4U * j);
+    for (uint32_t l = (uint32_t)0U; l < (uint32_t)4U; l++)
+    {
+      Lib_IntVector_Intrinsics_vec256_store_le((uint8_t *)(st[l] + (uint32_t)4U * j),
+        hash[(uint32_t)4U * j + l]);
+    }
+  }
+}
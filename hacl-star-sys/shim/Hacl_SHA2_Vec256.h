@@ -0,0 +1,19 @@
+/* SHA-512 of four independent inputs at a time, one 64-bit word of each input
+ * per vec256 lane. */
+
+#ifndef __Hacl_SHA2_Vec256_H
+#define __Hacl_SHA2_Vec256_H
+
+#include "evercrypt_targetconfig.h"
+#include "libintvector.h"
+#include "kremlin/internal/types.h"
+#include "kremlin/lowstar_endianness.h"
+#include <string.h>
+#include "kremlin/internal/target.h"
+
+/* Hacl_Hash_SHA2_update_multi_512(st[i], blocks[i], n_blocks) for i < 4: each
+ * st[i] is an 8-word SHA-384/512 state and each blocks[i] holds n_blocks
+ * 128-byte blocks. The st[i] must be distinct; the blocks[i] may be shared. */
+void Hacl_SHA2_Vec256_sha512_update_multi_4(uint64_t **st, uint8_t **blocks, uint32_t n_blocks);
+
+#endif
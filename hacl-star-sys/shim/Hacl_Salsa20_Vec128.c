@@ -0,0 +1,158 @@
+/* Four-way Salsa20, laid out like Hacl_Chacha20_Vec128.c: ctx[i] holds word i
+ * of four consecutive blocks, so the rounds run on whole vectors and the
+ * keystream is transposed back to block order only when it is XORed in. */
+
+#include "Hacl_Salsa20_Vec128.h"
+
+static inline void
+quarter_round_128(
+  Lib_IntVector_Intrinsics_vec128 *st,
+  uint32_t a,
+  uint32_t b,
+  uint32_t c,
+  uint32_t d
+)
+{
+  Lib_IntVector_Intrinsics_vec128 t0 = Lib_IntVector_Intrinsics_vec128_add32(st[a], st[d]);
+  st[b] =
+    Lib_IntVector_Intrinsics_vec128_xor(st[b],
+      Lib_IntVector_Intrinsics_vec128_rotate_left32(t0, (uint32_t)7U));
+  Lib_IntVector_Intrinsics_vec128 t1 = Lib_IntVector_Intrinsics_vec128_add32(st[b], st[a]);
+  st[c] =
+    Lib_IntVector_Intrinsics_vec128_xor(st[c],
+      Lib_IntVector_Intrinsics_vec128_rotate_left32(t1, (uint32_t)9U));
+  Lib_IntVector_Intrinsics_vec128 t2 = Lib_IntVector_Intrinsics_vec128_add32(st[c], st[b]);
+  st[d] =
+    Lib_IntVector_Intrinsics_vec128_xor(st[d],
+      Lib_IntVector_Intrinsics_vec128_rotate_left32(t2, (uint32_t)13U));
+  Lib_IntVector_Intrinsics_vec128 t3 = Lib_IntVector_Intrinsics_vec128_add32(st[d], st[c]);
+  st[a] =
+    Lib_IntVector_Intrinsics_vec128_xor(st[a],
+      Lib_IntVector_Intrinsics_vec128_rotate_left32(t3, (uint32_t)18U));
+}
+
+static inline void double_round_128(Lib_IntVector_Intrinsics_vec128 *st)
+{
+  quarter_round_128(st, (uint32_t)0U, (uint32_t)4U, (uint32_t)8U, (uint32_t)12U);
+  quarter_round_128(st, (uint32_t)5U, (uint32_t)9U, (uint32_t)13U, (uint32_t)1U);
+  quarter_round_128(st, (uint32_t)10U, (uint32_t)14U, (uint32_t)2U, (uint32_t)6U);
+  quarter_round_128(st, (uint32_t)15U, (uint32_t)3U, (uint32_t)7U, (uint32_t)11U);
+  quarter_round_128(st, (uint32_t)0U, (uint32_t)1U, (uint32_t)2U, (uint32_t)3U);
+  quarter_round_128(st, (uint32_t)5U, (uint32_t)6U, (uint32_t)7U, (uint32_t)4U);
+  quarter_round_128(st, (uint32_t)10U, (uint32_t)11U, (uint32_t)8U, (uint32_t)9U);
+  quarter_round_128(st, (uint32_t)15U, (uint32_t)12U, (uint32_t)13U, (uint32_t)14U);
+}
+
+static inline void
+salsa20_core_128(
+  Lib_IntVector_Intrinsics_vec128 *k,
+  Lib_IntVector_Intrinsics_vec128 *ctx,
+  uint32_t ctr
+)
+{
+  memcpy(k, ctx, (uint32_t)16U * sizeof (Lib_IntVector_Intrinsics_vec128));
+  uint32_t ctr_u32 = (uint32_t)4U * ctr;
+  Lib_IntVector_Intrinsics_vec128 cv = Lib_IntVector_Intrinsics_vec128_load32(ctr_u32);
+  k[8U] = Lib_IntVector_Intrinsics_vec128_add32(k[8U], cv);
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)10U; i++)
+  {
+    double_round_128(k);
+  }
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)16U; i++)
+  {
+    k[i] = Lib_IntVector_Intrinsics_vec128_add32(k[i], ctx[i]);
+  }
+  k[8U] = Lib_IntVector_Intrinsics_vec128_add32(k[8U], cv);
+}
+
+static inline void
+salsa20_init_128(Lib_IntVector_Intrinsics_vec128 *ctx, uint8_t *key, uint8_t *n, uint32_t ctr)
+{
+  uint32_t ctx1[16U] = { 0U };
+  ctx1[0U] = (uint32_t)0x61707865U;
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)4U; i++)
+  {
+    ctx1[(uint32_t)1U + i] = load32_le(key + i * (uint32_t)4U);
+    ctx1[(uint32_t)11U + i] = load32_le(key + (uint32_t)16U + i * (uint32_t)4U);
+  }
+  ctx1[5U] = (uint32_t)0x3320646eU;
+  ctx1[6U] = load32_le(n);
+  ctx1[7U] = load32_le(n + (uint32_t)4U);
+  ctx1[8U] = ctr;
+  ctx1[9U] = (uint32_t)0U;
+  ctx1[10U] = (uint32_t)0x79622d32U;
+  ctx1[15U] = (uint32_t)0x6b206574U;
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)16U; i++)
+  {
+    ctx[i] = Lib_IntVector_Intrinsics_vec128_load32(ctx1[i]);
+  }
+  /* the block counter is word 8 alone, wrapping without a carry into word 9 */
+  Lib_IntVector_Intrinsics_vec128
+  ctr1 =
+    Lib_IntVector_Intrinsics_vec128_load32s((uint32_t)0U,
+      (uint32_t)1U,
+      (uint32_t)2U,
+      (uint32_t)3U);
+  ctx[8U] = Lib_IntVector_Intrinsics_vec128_add32(ctx[8U], ctr1);
+}
+
+/* XORs the four keystream blocks of k into 256 bytes of text. */
+static inline void
+xor_blocks_128(uint8_t *out, uint8_t *text, Lib_IntVector_Intrinsics_vec128 *k)
+{
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)4U; i++)
+  {
+    Lib_IntVector_Intrinsics_vec128 v0 = k[(uint32_t)4U * i];
+    Lib_IntVector_Intrinsics_vec128 v1 = k[(uint32_t)4U * i + (uint32_t)1U];
+    Lib_IntVector_Intrinsics_vec128 v2 = k[(uint32_t)4U * i + (uint32_t)2U];
+    Lib_IntVector_Intrinsics_vec128 v3 = k[(uint32_t)4U * i + (uint32_t)3U];
+    Lib_IntVector_Intrinsics_vec128 v0_ = Lib_IntVector_Intrinsics_vec128_interleave_low32(v0, v1);
+    Lib_IntVector_Intrinsics_vec128 v1_ = Lib_IntVector_Intrinsics_vec128_interleave_high32(v0, v1);
+    Lib_IntVector_Intrinsics_vec128 v2_ = Lib_IntVector_Intrinsics_vec128_interleave_low32(v2, v3);
+    Lib_IntVector_Intrinsics_vec128 v3_ = Lib_IntVector_Intrinsics_vec128_interleave_high32(v2, v3);
+    Lib_IntVector_Intrinsics_vec128 b[4U];
+    b[0U] = Lib_IntVector_Intrinsics_vec128_interleave_low64(v0_, v2_);
+    b[1U] = Lib_IntVector_Intrinsics_vec128_interleave_high64(v0_, v2_);
+    b[2U] = Lib_IntVector_Intrinsics_vec128_interleave_low64(v1_, v3_);
+    b[3U] = Lib_IntVector_Intrinsics_vec128_interleave_high64(v1_, v3_);
+    for (uint32_t j = (uint32_t)0U; j < (uint32_t)4U; j++)
+    {
+      uint32_t off = j * (uint32_t)64U + i * (uint32_t)16U;
+      Lib_IntVector_Intrinsics_vec128 x = Lib_IntVector_Intrinsics_vec128_load_le(text + off);
+      Lib_IntVector_Intrinsics_vec128_store_le(out + off,
+        Lib_IntVector_Intrinsics_vec128_xor(x, b[j]));
+    }
+  }
+}
+
+void
+Hacl_Salsa20_Vec128_salsa20_encrypt_128(
+  uint32_t len,
+  uint8_t *out,
+  uint8_t *text,
+  uint8_t *key,
+  uint8_t *n,
+  uint32_t ctr
+)
+{
+  Lib_IntVector_Intrinsics_vec128 ctx[16U];
+  for (uint32_t _i = 0U; _i < (uint32_t)16U; ++_i)
+    ctx[_i] = Lib_IntVector_Intrinsics_vec128_zero;
+  salsa20_init_128(ctx, key, n, ctr);
+  uint32_t rem = len % (uint32_t)256U;
+  uint32_t nb = len / (uint32_t)256U;
+  Lib_IntVector_Intrinsics_vec128 k[16U];
+  for (uint32_t i = (uint32_t)0U; i < nb; i++)
+  {
+    salsa20_core_128(k, ctx, i);
+    xor_blocks_128(out + i * (uint32_t)256U, text + i * (uint32_t)256U, k);
+  }
+  if (rem > (uint32_t)0U)
+  {
+    uint8_t plain[256U] = { 0U };
+    memcpy(plain, text + nb * (uint32_t)256U, rem * sizeof (uint8_t));
+    salsa20_core_128(k, ctx, nb);
+    xor_blocks_128(plain, plain, k);
+    memcpy(out + nb * (uint32_t)256U, plain, rem * sizeof (uint8_t));
+  }
+}
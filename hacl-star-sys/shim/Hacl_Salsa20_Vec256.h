@@ -0,0 +1,21 @@
+/* Salsa20 over eight blocks at a time, one 32-bit state word of each block per
+ * vec256 lane. Same interface and output as Hacl_Salsa20_salsa20_encrypt. */
+
+#ifndef __Hacl_Salsa20_Vec256_H
+#define __Hacl_Salsa20_Vec256_H
+
+#include "Hacl_Salsa20.h"
+
+/* XORs len bytes of text with the Salsa20 stream of (key, n), starting at block
+ * ctr, into out; text and out may be the same buffer. */
+void
+Hacl_Salsa20_Vec256_salsa20_encrypt_256(
+  uint32_t len,
+  uint8_t *out,
+  uint8_t *text,
+  uint8_t *key,
+  uint8_t *n,
+  uint32_t ctr
+);
+
+#endif
@@ -0,0 +1,273 @@
+/* Compiled in place of MerkleTree.c, which is included verbatim so that batched
+ * insertion can use its vector helpers. */
+
+#include "MerkleTree.c"
+#include "MerkleTree_Batch.h"
+#include "Hacl_Blake2s_32.h"
+#include "Hacl_Blake2b_32.h"
+#include "EverCrypt_AutoConfig2.h"
+
+#if EVERCRYPT_TARGETCONFIG_X64
+#include "MerkleTree_Vec128.h"
+#include "MerkleTree_Vec256.h"
+#include "MerkleTree_ShaNI.h"
+#elif defined(__aarch64__) || defined(__wasm_simd128__)
+#include "MerkleTree_Vec128.h"
+#endif
+
+void mt_blake2s_compress(uint8_t *src1, uint8_t *src2, uint8_t *dst)
+{
+  uint8_t cb[64U] = { 0U };
+  memcpy(cb, src1, (uint32_t)32U * sizeof (uint8_t));
+  memcpy(cb + (uint32_t)32U, src2, (uint32_t)32U * sizeof (uint8_t));
+  Hacl_Blake2s_32_blake2s((uint32_t)32U, dst, (uint32_t)64U, cb, (uint32_t)0U, NULL);
+}
+
+void mt_blake2b_compress(uint8_t *src1, uint8_t *src2, uint8_t *dst)
+{
+  uint8_t cb[128U] = { 0U };
+  memcpy(cb, src1, (uint32_t)64U * sizeof (uint8_t));
+  memcpy(cb + (uint32_t)64U, src2, (uint32_t)64U * sizeof (uint8_t));
+  Hacl_Blake2b_32_blake2b((uint32_t)64U, dst, (uint32_t)128U, cb, (uint32_t)0U, NULL);
+}
+
+void mt_sha256_node(uint8_t *src1, uint8_t *src2, uint8_t *dst)
+{
+  uint8_t cb[64U] = { 0U };
+  memcpy(cb, src1, (uint32_t)32U * sizeof (uint8_t));
+  memcpy(cb + (uint32_t)32U, src2, (uint32_t)32U * sizeof (uint8_t));
+  uint32_t s[8U] = { 0U };
+  Hacl_Hash_Core_SHA2_init_256(s);
+  Hacl_Hash_Core_SHA2_update_256(s, cb);
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)8U; i++)
+  {
+    store32_be(dst + i * (uint32_t)4U, s[i]);
+  }
+}
+
+/* Nodes per call of the vector kernels: 8 with AVX2, 4 with AVX, NEON or wasm
+ * simd128, 1 otherwise. */
+static uint32_t batch_lanes(void)
+{
+  #if EVERCRYPT_TARGETCONFIG_X64
+  if (EverCrypt_AutoConfig2_has_avx2())
+  {
+    return (uint32_t)8U;
+  }
+  if (EverCrypt_AutoConfig2_has_avx())
+  {
+    return (uint32_t)4U;
+  }
+  return (uint32_t)1U;
+  #elif defined(__aarch64__) || defined(__wasm_simd128__)
+  return (uint32_t)4U;
+  #else
+  return (uint32_t)1U;
+  #endif
+}
+
+mt_kernel mt_sha256_kernel(void)
+{
+  #if EVERCRYPT_TARGETCONFIG_X64
+  if (EverCrypt_AutoConfig2_has_shaext() && EverCrypt_AutoConfig2_has_sse())
+  {
+    return
+      (
+        (mt_kernel){
+          .node = MerkleTree_ShaNI_sha256_compress_1,
+          .lanes = (uint32_t)2U,
+          .batch = MerkleTree_ShaNI_sha256_compress_2
+        }
+      );
+  }
+  #endif
+  switch (batch_lanes())
+  {
+    #if EVERCRYPT_TARGETCONFIG_X64
+    case 8U:
+      {
+        return
+          (
+            (mt_kernel){
+              .node = mt_sha256_node,
+              .lanes = (uint32_t)8U,
+              .batch = MerkleTree_Vec256_sha256_compress_8
+            }
+          );
+      }
+    #endif
+    #if EVERCRYPT_TARGETCONFIG_X64 || defined(__aarch64__) || defined(__wasm_simd128__)
+    case 4U:
+      {
+        return
+          (
+            (mt_kernel){
+              .node = mt_sha256_node,
+              .lanes = (uint32_t)4U,
+              .batch = MerkleTree_Vec128_sha256_compress_4
+            }
+          );
+      }
+    #endif
+    default:
+      {
+        return ((mt_kernel){ .node = mt_sha256_node, .lanes = (uint32_t)1U, .batch = NULL });
+      }
+  }
+}
+
+mt_kernel mt_blake2s_kernel(void)
+{
+  switch (batch_lanes())
+  {
+    #if EVERCRYPT_TARGETCONFIG_X64
+    case 8U:
+      {
+        return
+          (
+            (mt_kernel){
+              .node = mt_blake2s_compress,
+              .lanes = (uint32_t)8U,
+              .batch = MerkleTree_Vec256_blake2s_compress_8
+            }
+          );
+      }
+    #endif
+    #if EVERCRYPT_TARGETCONFIG_X64 || defined(__aarch64__) || defined(__wasm_simd128__)
+    case 4U:
+      {
+        return
+          (
+            (mt_kernel){
+              .node = mt_blake2s_compress,
+              .lanes = (uint32_t)4U,
+              .batch = MerkleTree_Vec128_blake2s_compress_4
+            }
+          );
+      }
+    #endif
+    default:
+      {
+        return ((mt_kernel){ .node = mt_blake2s_compress, .lanes = (uint32_t)1U, .batch = NULL });
+      }
+  }
+}
+
+bool mt_insert_batch_pre(const MerkleTree_Low_merkle_tree *mt, uint32_t n, uint8_t *vs)
+{
+  MerkleTree_Low_merkle_tree mt1 = *(MerkleTree_Low_merkle_tree *)mt;
+  return
+    n
+    <= MerkleTree_Low_uint32_32_max - mt1.j
+    && MerkleTree_Low_uint64_max - mt1.offset >= (uint64_t)mt1.j + (uint64_t)n;
+}
+
+/* dst[l] = k->node(src1[l], src2[l]) for l < n <= k->lanes, in one batch call
+ * when there are lanes nodes. */
+static void hash_lanes(const mt_kernel *k, uint32_t n, uint8_t **src1, uint8_t **src2, uint8_t **dst)
+{
+  if (n == k->lanes && k->batch != NULL)
+  {
+    k->batch(src1, src2, dst);
+    return;
+  }
+  for (uint32_t l = (uint32_t)0U; l < n; l++)
+  {
+    k->node(src1[l], src2[l], dst[l]);
+  }
+}
+
+void mt_hash_pairs(const mt_kernel *k, uint32_t hsz, uint32_t n, uint8_t *src, uint8_t *dst)
+{
+  uint32_t lanes = k->lanes;
+  for (uint32_t p = (uint32_t)0U; p < n; p = p + lanes)
+  {
+    uint32_t m = lanes;
+    if (n - p < lanes)
+    {
+      m = n - p;
+    }
+    uint8_t *left[8U];
+    uint8_t *right[8U];
+    uint8_t *out[8U];
+    for (uint32_t l = (uint32_t)0U; l < m; l++)
+    {
+      left[l] = src + (uint32_t)2U * (p + l) * hsz;
+      right[l] = left[l] + hsz;
+      out[l] = dst + (p + l) * hsz;
+    }
+    hash_lanes(k, m, left, right, out);
+  }
+}
+
+void
+mt_insert_batch(MerkleTree_Low_merkle_tree *mt, const mt_kernel *k, uint32_t n, uint8_t *vs)
+{
+  MerkleTree_Low_merkle_tree mtv = *mt;
+  MerkleTree_Low_Datastructures_hash_vv hs = mtv.hs;
+  uint32_t hsz = mtv.hash_size;
+  regional__uint32_t__uint8_t_
+  rg = { .state = hsz, .dummy = NULL, .r_alloc = hash_r_alloc, .r_free = hash_r_free };
+  uint32_t lanes = k->lanes;
+  MerkleTree_Low_Datastructures_hash_vec
+  lv0 = index__LowStar_Vector_vector_str__uint8_t_(hs, (uint32_t)0U);
+  for (uint32_t k = (uint32_t)0U; k < n; k++)
+  {
+    lv0 = insert_copy___uint8_t__uint32_t(rg, hash_copy, lv0, vs + k * hsz);
+  }
+  assign__LowStar_Vector_vector_str__uint8_t__uint32_t(hs, (uint32_t)0U, lv0);
+  /* level lv holds its nodes from offset_of(i >> lv) on; the new complete nodes
+     of level lv + 1 are the parents p with j0 >> (lv + 1) <= p < j1 >> (lv + 1) */
+  uint32_t j0 = mtv.j;
+  uint32_t j1 = mtv.j + n;
+  for
+  (uint32_t lv = (uint32_t)0U;
+    j0 >> (lv + (uint32_t)1U) < j1 >> (lv + (uint32_t)1U);
+    lv++)
+  {
+    MerkleTree_Low_Datastructures_hash_vec
+    src = index__LowStar_Vector_vector_str__uint8_t_(hs, lv);
+    MerkleTree_Low_Datastructures_hash_vec
+    dst = index__LowStar_Vector_vector_str__uint8_t_(hs, lv + (uint32_t)1U);
+    uint32_t ofs = MerkleTree_Low_offset_of(mtv.i >> lv);
+    uint32_t p1 = j1 >> (lv + (uint32_t)1U);
+    for (uint32_t p = j0 >> (lv + (uint32_t)1U); p < p1; p = p + lanes)
+    {
+      uint32_t m = lanes;
+      if (p1 - p < lanes)
+      {
+        m = p1 - p;
+      }
+      uint8_t *left[8U];
+      uint8_t *right[8U];
+      uint8_t *out[8U];
+      for (uint32_t l = (uint32_t)0U; l < m; l++)
+      {
+        left[l] = index___uint8_t_(src, (uint32_t)2U * (p + l) - ofs);
+        right[l] = index___uint8_t_(src, (uint32_t)2U * (p + l) + (uint32_t)1U - ofs);
+        out[l] = hash_r_alloc(hsz);
+      }
+      hash_lanes(k, m, left, right, out);
+      for (uint32_t l = (uint32_t)0U; l < m; l++)
+      {
+        dst = insert___uint8_t__uint32_t(dst, out[l]);
+      }
+    }
+    assign__LowStar_Vector_vector_str__uint8_t__uint32_t(hs, lv + (uint32_t)1U, dst);
+  }
+  *mt
+  =
+    (
+      (MerkleTree_Low_merkle_tree){
+        .hash_size = mtv.hash_size,
+        .offset = mtv.offset,
+        .i = mtv.i,
+        .j = j1,
+        .hs = mtv.hs,
+        .rhs_ok = false,
+        .rhs = mtv.rhs,
+        .mroot = mtv.mroot,
+        .hash_fun = mtv.hash_fun
+      }
+    );
+}
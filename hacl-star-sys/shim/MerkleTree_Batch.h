@@ -0,0 +1,57 @@
+/* Batched insertion for MerkleTree and the BLAKE2 node hashes. */
+
+#ifndef __MerkleTree_Batch_H
+#define __MerkleTree_Batch_H
+
+#include "MerkleTree.h"
+
+/* BLAKE2s-256 of src1 || src2 (32-byte hashes), for mt_create_custom. */
+void mt_blake2s_compress(uint8_t *src1, uint8_t *src2, uint8_t *dst);
+
+/* BLAKE2b-512 of src1 || src2 (64-byte hashes), for mt_create_custom. */
+void mt_blake2b_compress(uint8_t *src1, uint8_t *src2, uint8_t *dst);
+
+/* mt_sha256_compress, without EverCrypt_Hash's generic state: one compression on
+ * the fixed IV, in portable C. dst may be src1 or src2. */
+void mt_sha256_node(uint8_t *src1, uint8_t *src2, uint8_t *dst);
+
+/* How the nodes of a tree are hashed: `node` hashes one, and `batch`, if not
+ * NULL, hashes `lanes` (at most 8) at once: dst[l] = node(src1[l], src2[l]) for
+ * l < lanes. { hash_fun, 1, NULL } is a kernel for any hash_fun. */
+typedef struct mt_kernel_s
+{
+  void (*node)(uint8_t *src1, uint8_t *src2, uint8_t *dst);
+  uint32_t lanes;
+  void (*batch)(uint8_t **src1, uint8_t **src2, uint8_t **dst);
+}
+mt_kernel;
+
+/* The functions below read EverCrypt_AutoConfig2 on x86_64, so they are only
+ * meaningful once EverCrypt_AutoConfig2_init has run, and reflect features
+ * disabled since. */
+
+/* Kernel of mt_sha256_compress trees: the SHA extensions (two nodes at a time)
+ * where EverCrypt_AutoConfig2 reports them with SSE, else 8 nodes with AVX2, 4
+ * with AVX, on aarch64 and on wasm simd128, and mt_sha256_node alone otherwise. */
+mt_kernel mt_sha256_kernel(void);
+
+/* Kernel of mt_blake2s_compress trees: 8 nodes with AVX2, 4 with AVX, on aarch64
+ * and on wasm simd128, mt_blake2s_compress alone otherwise. */
+mt_kernel mt_blake2s_kernel(void);
+
+/* dst + k * hsz = k->node(src + 2 * k * hsz, src + (2 * k + 1) * hsz) for
+ * k < n: the n parents of 2 * n consecutive nodes, hashed as in
+ * mt_insert_batch. dst must not overlap src. */
+void mt_hash_pairs(const mt_kernel *k, uint32_t hsz, uint32_t n, uint8_t *src, uint8_t *dst);
+
+/* Precondition predicate for mt_insert_batch */
+bool mt_insert_batch_pre(const MerkleTree_Low_merkle_tree *mt, uint32_t n, uint8_t *vs);
+
+/* Inserts the n hashes laid out back to back in vs, leaving the tree as n calls
+ * to mt_insert would, provided k hashes nodes as mt's hash_fun does. Each level
+ * is finished before the next, so the new nodes of a level are hashed k->lanes
+ * at a time. vs is not modified. */
+void
+mt_insert_batch(MerkleTree_Low_merkle_tree *mt, const mt_kernel *k, uint32_t n, uint8_t *vs);
+
+#endif
@@ -0,0 +1,124 @@
+/* A Merkle node is one SHA-256 compression of the block src1 || src2 on the
+ * standard IV, with no length padding. The IV is kept here already in the ABEF /
+ * CDGH layout sha256rnds2 works on, and the 64-byte block is loaded straight from
+ * the two children, so a node costs the 64 rounds and nothing of EverCrypt_Hash's
+ * state setup. Two nodes are interleaved round by round: sha256rnds2 has a
+ * latency of several cycles and one stream leaves the unit idle between rounds. */
+
+#include "MerkleTree_ShaNI.h"
+#include <immintrin.h>
+
+static const
+uint32_t
+k224_256_shani[64U] =
+  {
+    (uint32_t)0x428a2f98U, (uint32_t)0x71374491U, (uint32_t)0xb5c0fbcfU, (uint32_t)0xe9b5dba5U,
+    (uint32_t)0x3956c25bU, (uint32_t)0x59f111f1U, (uint32_t)0x923f82a4U, (uint32_t)0xab1c5ed5U,
+    (uint32_t)0xd807aa98U, (uint32_t)0x12835b01U, (uint32_t)0x243185beU, (uint32_t)0x550c7dc3U,
+    (uint32_t)0x72be5d74U, (uint32_t)0x80deb1feU, (uint32_t)0x9bdc06a7U, (uint32_t)0xc19bf174U,
+    (uint32_t)0xe49b69c1U, (uint32_t)0xefbe4786U, (uint32_t)0x0fc19dc6U, (uint32_t)0x240ca1ccU,
+    (uint32_t)0x2de92c6fU, (uint32_t)0x4a7484aaU, (uint32_t)0x5cb0a9dcU, (uint32_t)0x76f988daU,
+    (uint32_t)0x983e5152U, (uint32_t)0xa831c66dU, (uint32_t)0xb00327c8U, (uint32_t)0xbf597fc7U,
+    (uint32_t)0xc6e00bf3U, (uint32_t)0xd5a79147U, (uint32_t)0x06ca6351U, (uint32_t)0x14292967U,
+    (uint32_t)0x27b70a85U, (uint32_t)0x2e1b2138U, (uint32_t)0x4d2c6dfcU, (uint32_t)0x53380d13U,
+    (uint32_t)0x650a7354U, (uint32_t)0x766a0abbU, (uint32_t)0x81c2c92eU, (uint32_t)0x92722c85U,
+    (uint32_t)0xa2bfe8a1U, (uint32_t)0xa81a664bU, (uint32_t)0xc24b8b70U, (uint32_t)0xc76c51a3U,
+    (uint32_t)0xd192e819U, (uint32_t)0xd6990624U, (uint32_t)0xf40e3585U, (uint32_t)0x106aa070U,
+    (uint32_t)0x19a4c116U, (uint32_t)0x1e376c08U, (uint32_t)0x2748774cU, (uint32_t)0x34b0bcb5U,
+    (uint32_t)0x391c0cb3U, (uint32_t)0x4ed8aa4aU, (uint32_t)0x5b9cca4fU, (uint32_t)0x682e6ff3U,
+    (uint32_t)0x748f82eeU, (uint32_t)0x78a5636fU, (uint32_t)0x84c87814U, (uint32_t)0x8cc70208U,
+    (uint32_t)0x90befffaU, (uint32_t)0xa4506cebU, (uint32_t)0xbef9a3f7U, (uint32_t)0xc67178f2U
+  };
+
+/* Rounds 4q to 4q + 3 of every lane, with w[l][q % 4] holding message quad q.
+ * Quad q + 1 of the schedule is finished (sha256msg2) between the two halves of
+ * the rounds and quad q + 3 started (sha256msg1) after them, as in Intel's
+ * reference code. n and q are constants at every call, so the lane loop unrolls
+ * and the schedule words stay in registers. */
+static inline void
+rounds_shani(uint32_t n, uint32_t q, __m128i *s0, __m128i *s1, __m128i (*w)[4U])
+{
+  __m128i k = _mm_loadu_si128((const __m128i *)(k224_256_shani + (uint32_t)4U * q));
+  for (uint32_t l = (uint32_t)0U; l < n; l++)
+  {
+    __m128i *wl = w[l];
+    __m128i msg = _mm_add_epi32(wl[q % (uint32_t)4U], k);
+    s1[l] = _mm_sha256rnds2_epu32(s1[l], s0[l], msg);
+    if (q >= (uint32_t)3U && q <= (uint32_t)14U)
+    {
+      __m128i
+      tmp = _mm_alignr_epi8(wl[q % (uint32_t)4U], wl[(q + (uint32_t)3U) % (uint32_t)4U], 4);
+      wl[(q + (uint32_t)1U) % (uint32_t)4U] =
+        _mm_sha256msg2_epu32(_mm_add_epi32(wl[(q + (uint32_t)1U) % (uint32_t)4U], tmp),
+          wl[q % (uint32_t)4U]);
+    }
+    s0[l] = _mm_sha256rnds2_epu32(s0[l], s1[l], _mm_shuffle_epi32(msg, 0x0E));
+    if (q >= (uint32_t)1U && q <= (uint32_t)12U)
+    {
+      wl[(q + (uint32_t)3U) % (uint32_t)4U] =
+        _mm_sha256msg1_epu32(wl[(q + (uint32_t)3U) % (uint32_t)4U], wl[q % (uint32_t)4U]);
+    }
+  }
+}
+
+/* The n nodes from the IV: the four message quads of each lane, the 16 quads of
+ * rounds, then the feed-forward. */
+static inline void
+compress_lanes(uint32_t n, uint8_t **src1, uint8_t **src2, uint8_t **dst)
+{
+  const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+  const __m128i abef = _mm_set_epi32(0x6a09e667, (int)0xbb67ae85U, 0x510e527f, (int)0x9b05688cU);
+  const __m128i cdgh = _mm_set_epi32(0x3c6ef372, (int)0xa54ff53aU, 0x1f83d9ab, 0x5be0cd19);
+  __m128i s0[2U];
+  __m128i s1[2U];
+  __m128i w[2U][4U];
+  for (uint32_t l = (uint32_t)0U; l < n; l++)
+  {
+    s0[l] = abef;
+    s1[l] = cdgh;
+    w[l][0U] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src1[l]), bswap);
+    w[l][1U] =
+      _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src1[l] + (uint32_t)16U)),
+        bswap);
+    w[l][2U] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src2[l]), bswap);
+    w[l][3U] =
+      _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src2[l] + (uint32_t)16U)),
+        bswap);
+  }
+  rounds_shani(n, (uint32_t)0U, s0, s1, w);
+  rounds_shani(n, (uint32_t)1U, s0, s1, w);
+  rounds_shani(n, (uint32_t)2U, s0, s1, w);
+  rounds_shani(n, (uint32_t)3U, s0, s1, w);
+  rounds_shani(n, (uint32_t)4U, s0, s1, w);
+  rounds_shani(n, (uint32_t)5U, s0, s1, w);
+  rounds_shani(n, (uint32_t)6U, s0, s1, w);
+  rounds_shani(n, (uint32_t)7U, s0, s1, w);
+  rounds_shani(n, (uint32_t)8U, s0, s1, w);
+  rounds_shani(n, (uint32_t)9U, s0, s1, w);
+  rounds_shani(n, (uint32_t)10U, s0, s1, w);
+  rounds_shani(n, (uint32_t)11U, s0, s1, w);
+  rounds_shani(n, (uint32_t)12U, s0, s1, w);
+  rounds_shani(n, (uint32_t)13U, s0, s1, w);
+  rounds_shani(n, (uint32_t)14U, s0, s1, w);
+  rounds_shani(n, (uint32_t)15U, s0, s1, w);
+  for (uint32_t l = (uint32_t)0U; l < n; l++)
+  {
+    /* ABEF, CDGH back to ABCD, EFGH, each word big-endian */
+    __m128i feba = _mm_shuffle_epi32(_mm_add_epi32(s0[l], abef), 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(_mm_add_epi32(s1[l], cdgh), 0xB1);
+    __m128i abcd = _mm_blend_epi16(feba, dchg, 0xF0);
+    __m128i efgh = _mm_alignr_epi8(dchg, feba, 8);
+    _mm_storeu_si128((__m128i *)dst[l], _mm_shuffle_epi8(abcd, bswap));
+    _mm_storeu_si128((__m128i *)(dst[l] + (uint32_t)16U), _mm_shuffle_epi8(efgh, bswap));
+  }
+}
+
+void MerkleTree_ShaNI_sha256_compress_1(uint8_t *src1, uint8_t *src2, uint8_t *dst)
+{
+  compress_lanes((uint32_t)1U, &src1, &src2, &dst);
+}
+
+void MerkleTree_ShaNI_sha256_compress_2(uint8_t **src1, uint8_t **src2, uint8_t **dst)
+{
+  compress_lanes((uint32_t)2U, src1, src2, dst);
+}
@@ -0,0 +1,18 @@
+/* Merkle SHA-256 node hash on the x86 SHA extensions, one or two nodes per call.
+ * Same output as mt_sha256_compress. */
+
+#ifndef __MerkleTree_ShaNI_H
+#define __MerkleTree_ShaNI_H
+
+#include "kremlin/internal/types.h"
+#include <string.h>
+#include "kremlin/internal/target.h"
+
+/* dst = mt_sha256_compress(src1, src2); dst may be src1 or src2. */
+void MerkleTree_ShaNI_sha256_compress_1(uint8_t *src1, uint8_t *src2, uint8_t *dst);
+
+/* dst[i] = mt_sha256_compress(src1[i], src2[i]) for i < 2; dst[i] may be
+ * src1[i] or src2[i]. */
+void MerkleTree_ShaNI_sha256_compress_2(uint8_t **src1, uint8_t **src2, uint8_t **dst);
+
+#endif
@@ -0,0 +1,320 @@
+/* Multi-buffer node hashes for mt_insert_batch: lane i of every vector belongs
+ * to node i, so the 64 SHA-256 rounds (or 10 BLAKE2s rounds) run once for four
+ * nodes. Nodes are gathered into lanes word by word and scattered back the same
+ * way; with one block per node that is small next to the rounds. */
+
+#include "MerkleTree_Vec128.h"
+
+static const
+uint32_t
+k224_256_128[64U] =
+  {
+    (uint32_t)0x428a2f98U, (uint32_t)0x71374491U, (uint32_t)0xb5c0fbcfU, (uint32_t)0xe9b5dba5U,
+    (uint32_t)0x3956c25bU, (uint32_t)0x59f111f1U, (uint32_t)0x923f82a4U, (uint32_t)0xab1c5ed5U,
+    (uint32_t)0xd807aa98U, (uint32_t)0x12835b01U, (uint32_t)0x243185beU, (uint32_t)0x550c7dc3U,
+    (uint32_t)0x72be5d74U, (uint32_t)0x80deb1feU, (uint32_t)0x9bdc06a7U, (uint32_t)0xc19bf174U,
+    (uint32_t)0xe49b69c1U, (uint32_t)0xefbe4786U, (uint32_t)0x0fc19dc6U, (uint32_t)0x240ca1ccU,
+    (uint32_t)0x2de92c6fU, (uint32_t)0x4a7484aaU, (uint32_t)0x5cb0a9dcU, (uint32_t)0x76f988daU,
+    (uint32_t)0x983e5152U, (uint32_t)0xa831c66dU, (uint32_t)0xb00327c8U, (uint32_t)0xbf597fc7U,
+    (uint32_t)0xc6e00bf3U, (uint32_t)0xd5a79147U, (uint32_t)0x06ca6351U, (uint32_t)0x14292967U,
+    (uint32_t)0x27b70a85U, (uint32_t)0x2e1b2138U, (uint32_t)0x4d2c6dfcU, (uint32_t)0x53380d13U,
+    (uint32_t)0x650a7354U, (uint32_t)0x766a0abbU, (uint32_t)0x81c2c92eU, (uint32_t)0x92722c85U,
+    (uint32_t)0xa2bfe8a1U, (uint32_t)0xa81a664bU, (uint32_t)0xc24b8b70U, (uint32_t)0xc76c51a3U,
+    (uint32_t)0xd192e819U, (uint32_t)0xd6990624U, (uint32_t)0xf40e3585U, (uint32_t)0x106aa070U,
+    (uint32_t)0x19a4c116U, (uint32_t)0x1e376c08U, (uint32_t)0x2748774cU, (uint32_t)0x34b0bcb5U,
+    (uint32_t)0x391c0cb3U, (uint32_t)0x4ed8aa4aU, (uint32_t)0x5b9cca4fU, (uint32_t)0x682e6ff3U,
+    (uint32_t)0x748f82eeU, (uint32_t)0x78a5636fU, (uint32_t)0x84c87814U, (uint32_t)0x8cc70208U,
+    (uint32_t)0x90befffaU, (uint32_t)0xa4506cebU, (uint32_t)0xbef9a3f7U, (uint32_t)0xc67178f2U
+  };
+
+/* the SHA-256 initial state, which is also the BLAKE2s IV */
+static const
+uint32_t
+h256_128[8U] =
+  {
+    (uint32_t)0x6a09e667U, (uint32_t)0xbb67ae85U, (uint32_t)0x3c6ef372U, (uint32_t)0xa54ff53aU,
+    (uint32_t)0x510e527fU, (uint32_t)0x9b05688cU, (uint32_t)0x1f83d9abU, (uint32_t)0x5be0cd19U
+  };
+
+static const
+uint32_t
+sigma_128[160U] =
+  {
+    (uint32_t)0U, (uint32_t)1U, (uint32_t)2U, (uint32_t)3U, (uint32_t)4U, (uint32_t)5U,
+    (uint32_t)6U, (uint32_t)7U, (uint32_t)8U, (uint32_t)9U, (uint32_t)10U, (uint32_t)11U,
+    (uint32_t)12U, (uint32_t)13U, (uint32_t)14U, (uint32_t)15U, (uint32_t)14U, (uint32_t)10U,
+    (uint32_t)4U, (uint32_t)8U, (uint32_t)9U, (uint32_t)15U, (uint32_t)13U, (uint32_t)6U,
+    (uint32_t)1U, (uint32_t)12U, (uint32_t)0U, (uint32_t)2U, (uint32_t)11U, (uint32_t)7U,
+    (uint32_t)5U, (uint32_t)3U, (uint32_t)11U, (uint32_t)8U, (uint32_t)12U, (uint32_t)0U,
+    (uint32_t)5U, (uint32_t)2U, (uint32_t)15U, (uint32_t)13U, (uint32_t)10U, (uint32_t)14U,
+    (uint32_t)3U, (uint32_t)6U, (uint32_t)7U, (uint32_t)1U, (uint32_t)9U, (uint32_t)4U,
+    (uint32_t)7U, (uint32_t)9U, (uint32_t)3U, (uint32_t)1U, (uint32_t)13U, (uint32_t)12U,
+    (uint32_t)11U, (uint32_t)14U, (uint32_t)2U, (uint32_t)6U, (uint32_t)5U, (uint32_t)10U,
+    (uint32_t)4U, (uint32_t)0U, (uint32_t)15U, (uint32_t)8U, (uint32_t)9U, (uint32_t)0U,
+    (uint32_t)5U, (uint32_t)7U, (uint32_t)2U, (uint32_t)4U, (uint32_t)10U, (uint32_t)15U,
+    (uint32_t)14U, (uint32_t)1U, (uint32_t)11U, (uint32_t)12U, (uint32_t)6U, (uint32_t)8U,
+    (uint32_t)3U, (uint32_t)13U, (uint32_t)2U, (uint32_t)12U, (uint32_t)6U, (uint32_t)10U,
+    (uint32_t)0U, (uint32_t)11U, (uint32_t)8U, (uint32_t)3U, (uint32_t)4U, (uint32_t)13U,
+    (uint32_t)7U, (uint32_t)5U, (uint32_t)15U, (uint32_t)14U, (uint32_t)1U, (uint32_t)9U,
+    (uint32_t)12U, (uint32_t)5U, (uint32_t)1U, (uint32_t)15U, (uint32_t)14U, (uint32_t)13U,
+    (uint32_t)4U, (uint32_t)10U, (uint32_t)0U, (uint32_t)7U, (uint32_t)6U, (uint32_t)3U,
+    (uint32_t)9U, (uint32_t)2U, (uint32_t)8U, (uint32_t)11U, (uint32_t)13U, (uint32_t)11U,
+    (uint32_t)7U, (uint32_t)14U, (uint32_t)12U, (uint32_t)1U, (uint32_t)3U, (uint32_t)9U,
+    (uint32_t)5U, (uint32_t)0U, (uint32_t)15U, (uint32_t)4U, (uint32_t)8U, (uint32_t)6U,
+    (uint32_t)2U, (uint32_t)10U, (uint32_t)6U, (uint32_t)15U, (uint32_t)14U, (uint32_t)9U,
+    (uint32_t)11U, (uint32_t)3U, (uint32_t)0U, (uint32_t)8U, (uint32_t)12U, (uint32_t)2U,
+    (uint32_t)13U, (uint32_t)7U, (uint32_t)1U, (uint32_t)4U, (uint32_t)10U, (uint32_t)5U,
+    (uint32_t)10U, (uint32_t)2U, (uint32_t)8U, (uint32_t)4U, (uint32_t)7U, (uint32_t)6U,
+    (uint32_t)1U, (uint32_t)5U, (uint32_t)15U, (uint32_t)11U, (uint32_t)9U, (uint32_t)14U,
+    (uint32_t)3U, (uint32_t)12U, (uint32_t)13U, (uint32_t)0U
+  };
+
+/* Word i of the block src1[l] || src2[l] in lane l, read big- or little-endian. */
+static inline void
+load_blocks_128(
+  Lib_IntVector_Intrinsics_vec128 *ws,
+  uint8_t **src1,
+  uint8_t **src2,
+  bool be
+)
+{
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)16U; i++)
+  {
+    uint32_t w[4U] = { 0U };
+    for (uint32_t l = (uint32_t)0U; l < (uint32_t)4U; l++)
+    {
+      uint8_t *b;
+      if (i < (uint32_t)8U)
+      {
+        b = src1[l] + i * (uint32_t)4U;
+      }
+      else
+      {
+        b = src2[l] + (i - (uint32_t)8U) * (uint32_t)4U;
+      }
+      if (be)
+      {
+        w[l] = load32_be(b);
+      }
+      else
+      {
+        w[l] = load32_le(b);
+      }
+    }
+    ws[i] = Lib_IntVector_Intrinsics_vec128_load32s(w[0U], w[1U], w[2U], w[3U]);
+  }
+}
+
+/* Word i of dst[l] from lane l of st[i]. */
+static inline void
+store_hashes_128(uint8_t **dst, Lib_IntVector_Intrinsics_vec128 *st, bool be)
+{
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)8U; i++)
+  {
+    uint32_t w[4U];
+    Lib_IntVector_Intrinsics_vec128_store_le((uint8_t *)w, st[i]);
+    for (uint32_t l = (uint32_t)0U; l < (uint32_t)4U; l++)
+    {
+      if (be)
+      {
+        store32_be(dst[l] + i * (uint32_t)4U, w[l]);
+      }
+      else
+      {
+        store32_le(dst[l] + i * (uint32_t)4U, w[l]);
+      }
+    }
+  }
+}
+
+static inline Lib_IntVector_Intrinsics_vec128
+big_sigma0_128(Lib_IntVector_Intrinsics_vec128 x)
+{
+  return
+    Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_rotate_right32(x,
+        (uint32_t)2U),
+      Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_rotate_right32(x,
+          (uint32_t)13U),
+        Lib_IntVector_Intrinsics_vec128_rotate_right32(x, (uint32_t)22U)));
+}
+
+static inline Lib_IntVector_Intrinsics_vec128
+big_sigma1_128(Lib_IntVector_Intrinsics_vec128 x)
+{
+  return
+    Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_rotate_right32(x,
+        (uint32_t)6U),
+      Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_rotate_right32(x,
+          (uint32_t)11U),
+        Lib_IntVector_Intrinsics_vec128_rotate_right32(x, (uint32_t)25U)));
+}
+
+static inline Lib_IntVector_Intrinsics_vec128
+small_sigma0_128(Lib_IntVector_Intrinsics_vec128 x)
+{
+  return
+    Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_rotate_right32(x,
+        (uint32_t)7U),
+      Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_rotate_right32(x,
+          (uint32_t)18U),
+        Lib_IntVector_Intrinsics_vec128_shift_right32(x, (uint32_t)3U)));
+}
+
+static inline Lib_IntVector_Intrinsics_vec128
+small_sigma1_128(Lib_IntVector_Intrinsics_vec128 x)
+{
+  return
+    Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_rotate_right32(x,
+        (uint32_t)17U),
+      Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_rotate_right32(x,
+          (uint32_t)19U),
+        Lib_IntVector_Intrinsics_vec128_shift_right32(x, (uint32_t)10U)));
+}
+
+void MerkleTree_Vec128_sha256_compress_4(uint8_t **src1, uint8_t **src2, uint8_t **dst)
+{
+  Lib_IntVector_Intrinsics_vec128 ws[64U];
+  load_blocks_128(ws, src1, src2, true);
+  for (uint32_t i = (uint32_t)16U; i < (uint32_t)64U; i++)
+  {
+    Lib_IntVector_Intrinsics_vec128
+    t0 =
+      Lib_IntVector_Intrinsics_vec128_add32(small_sigma1_128(ws[i - (uint32_t)2U]),
+        ws[i - (uint32_t)7U]);
+    Lib_IntVector_Intrinsics_vec128
+    t1 =
+      Lib_IntVector_Intrinsics_vec128_add32(small_sigma0_128(ws[i - (uint32_t)15U]),
+        ws[i - (uint32_t)16U]);
+    ws[i] = Lib_IntVector_Intrinsics_vec128_add32(t0, t1);
+  }
+  Lib_IntVector_Intrinsics_vec128 st[8U];
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)8U; i++)
+  {
+    st[i] = Lib_IntVector_Intrinsics_vec128_load32(h256_128[i]);
+  }
+  Lib_IntVector_Intrinsics_vec128 a = st[0U];
+  Lib_IntVector_Intrinsics_vec128 b = st[1U];
+  Lib_IntVector_Intrinsics_vec128 c = st[2U];
+  Lib_IntVector_Intrinsics_vec128 d = st[3U];
+  Lib_IntVector_Intrinsics_vec128 e = st[4U];
+  Lib_IntVector_Intrinsics_vec128 f = st[5U];
+  Lib_IntVector_Intrinsics_vec128 g = st[6U];
+  Lib_IntVector_Intrinsics_vec128 h = st[7U];
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)64U; i++)
+  {
+    /* ch = g ^ (e & (f ^ g)), maj = (a & b) ^ (c & (a ^ b)) */
+    Lib_IntVector_Intrinsics_vec128
+    ch =
+      Lib_IntVector_Intrinsics_vec128_xor(g,
+        Lib_IntVector_Intrinsics_vec128_and(e, Lib_IntVector_Intrinsics_vec128_xor(f, g)));
+    Lib_IntVector_Intrinsics_vec128
+    maj =
+      Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_and(a, b),
+        Lib_IntVector_Intrinsics_vec128_and(c, Lib_IntVector_Intrinsics_vec128_xor(a, b)));
+    Lib_IntVector_Intrinsics_vec128
+    kw =
+      Lib_IntVector_Intrinsics_vec128_add32(Lib_IntVector_Intrinsics_vec128_load32(k224_256_128[i]),
+        ws[i]);
+    Lib_IntVector_Intrinsics_vec128
+    t1 =
+      Lib_IntVector_Intrinsics_vec128_add32(Lib_IntVector_Intrinsics_vec128_add32(h,
+          big_sigma1_128(e)),
+        Lib_IntVector_Intrinsics_vec128_add32(ch, kw));
+    Lib_IntVector_Intrinsics_vec128
+    t2 = Lib_IntVector_Intrinsics_vec128_add32(big_sigma0_128(a), maj);
+    h = g;
+    g = f;
+    f = e;
+    e = Lib_IntVector_Intrinsics_vec128_add32(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = Lib_IntVector_Intrinsics_vec128_add32(t1, t2);
+  }
+  st[0U] = Lib_IntVector_Intrinsics_vec128_add32(st[0U], a);
+  st[1U] = Lib_IntVector_Intrinsics_vec128_add32(st[1U], b);
+  st[2U] = Lib_IntVector_Intrinsics_vec128_add32(st[2U], c);
+  st[3U] = Lib_IntVector_Intrinsics_vec128_add32(st[3U], d);
+  st[4U] = Lib_IntVector_Intrinsics_vec128_add32(st[4U], e);
+  st[5U] = Lib_IntVector_Intrinsics_vec128_add32(st[5U], f);
+  st[6U] = Lib_IntVector_Intrinsics_vec128_add32(st[6U], g);
+  st[7U] = Lib_IntVector_Intrinsics_vec128_add32(st[7U], h);
+  store_hashes_128(dst, st, true);
+}
+
+static inline void
+blake2s_g_128(
+  Lib_IntVector_Intrinsics_vec128 *v,
+  uint32_t a,
+  uint32_t b,
+  uint32_t c,
+  uint32_t d,
+  Lib_IntVector_Intrinsics_vec128 x,
+  Lib_IntVector_Intrinsics_vec128 y
+)
+{
+  v[a] =
+    Lib_IntVector_Intrinsics_vec128_add32(Lib_IntVector_Intrinsics_vec128_add32(v[a], v[b]),
+      x);
+  v[d] =
+    Lib_IntVector_Intrinsics_vec128_rotate_right32(Lib_IntVector_Intrinsics_vec128_xor(v[d],
+        v[a]),
+      (uint32_t)16U);
+  v[c] = Lib_IntVector_Intrinsics_vec128_add32(v[c], v[d]);
+  v[b] =
+    Lib_IntVector_Intrinsics_vec128_rotate_right32(Lib_IntVector_Intrinsics_vec128_xor(v[b],
+        v[c]),
+      (uint32_t)12U);
+  v[a] =
+    Lib_IntVector_Intrinsics_vec128_add32(Lib_IntVector_Intrinsics_vec128_add32(v[a], v[b]),
+      y);
+  v[d] =
+    Lib_IntVector_Intrinsics_vec128_rotate_right32(Lib_IntVector_Intrinsics_vec128_xor(v[d],
+        v[a]),
+      (uint32_t)8U);
+  v[c] = Lib_IntVector_Intrinsics_vec128_add32(v[c], v[d]);
+  v[b] =
+    Lib_IntVector_Intrinsics_vec128_rotate_right32(Lib_IntVector_Intrinsics_vec128_xor(v[b],
+        v[c]),
+      (uint32_t)7U);
+}
+
+void MerkleTree_Vec128_blake2s_compress_4(uint8_t **src1, uint8_t **src2, uint8_t **dst)
+{
+  Lib_IntVector_Intrinsics_vec128 m[16U];
+  load_blocks_128(m, src1, src2, false);
+  /* unkeyed BLAKE2s-256 of the 64 bytes, whose only block is the last one:
+     parameter word 0x01010020, counter 64, final flag set */
+  uint32_t h0[8U];
+  memcpy(h0, h256_128, (uint32_t)8U * sizeof (uint32_t));
+  h0[0U] = h0[0U] ^ (uint32_t)0x01010020U;
+  Lib_IntVector_Intrinsics_vec128 v[16U];
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)8U; i++)
+  {
+    v[i] = Lib_IntVector_Intrinsics_vec128_load32(h0[i]);
+    v[i + (uint32_t)8U] = Lib_IntVector_Intrinsics_vec128_load32(h256_128[i]);
+  }
+  v[12U] =
+    Lib_IntVector_Intrinsics_vec128_load32(h256_128[4U] ^ (uint32_t)64U);
+  v[14U] = Lib_IntVector_Intrinsics_vec128_load32(~h256_128[6U]);
+  for (uint32_t r = (uint32_t)0U; r < (uint32_t)10U; r++)
+  {
+    const uint32_t *s = sigma_128 + r * (uint32_t)16U;
+    blake2s_g_128(v, (uint32_t)0U, (uint32_t)4U, (uint32_t)8U, (uint32_t)12U, m[s[0U]], m[s[1U]]);
+    blake2s_g_128(v, (uint32_t)1U, (uint32_t)5U, (uint32_t)9U, (uint32_t)13U, m[s[2U]], m[s[3U]]);
+    blake2s_g_128(v, (uint32_t)2U, (uint32_t)6U, (uint32_t)10U, (uint32_t)14U, m[s[4U]], m[s[5U]]);
+    blake2s_g_128(v, (uint32_t)3U, (uint32_t)7U, (uint32_t)11U, (uint32_t)15U, m[s[6U]], m[s[7U]]);
+    blake2s_g_128(v, (uint32_t)0U, (uint32_t)5U, (uint32_t)10U, (uint32_t)15U, m[s[8U]], m[s[9U]]);
+    blake2s_g_128(v, (uint32_t)1U, (uint32_t)6U, (uint32_t)11U, (uint32_t)12U, m[s[10U]], m[s[11U]]);
+    blake2s_g_128(v, (uint32_t)2U, (uint32_t)7U, (uint32_t)8U, (uint32_t)13U, m[s[12U]], m[s[13U]]);
+    blake2s_g_128(v, (uint32_t)3U, (uint32_t)4U, (uint32_t)9U, (uint32_t)14U, m[s[14U]], m[s[15U]]);
+  }
+  Lib_IntVector_Intrinsics_vec128 st[8U];
+  for (uint32_t i = (uint32_t)0U; i < (uint32_t)8U; i++)
+  {
+    st[i] =
+      Lib_IntVector_Intrinsics_vec128_xor(Lib_IntVector_Intrinsics_vec128_load32(h0[i]),
+        Lib_IntVector_Intrinsics_vec128_xor(v[i], v[i + (uint32_t)8U]));
+  }
+  store_hashes_128(dst, st, false);
+}
@@ -0,0 +1,22 @@
+/* Merkle node hashes eight nodes at a time, one 32-bit word of each node per
+ * vec256 lane. Same output as mt_sha256_compress and mt_blake2s_compress. */
+
+#ifndef __MerkleTree_Vec256_H
+#define __MerkleTree_Vec256_H
+
+#include "evercrypt_targetconfig.h"
+#include "libintvector.h"
+#include "kremlin/internal/types.h"
+#include "kremlin/lowstar_endianness.h"
+#include <string.h>
+#include "kremlin/internal/target.h"
+
+/* dst[i] = mt_sha256_compress(src1[i], src2[i]) for i < 8; dst[i] may be
+ * src1[i] or src2[i]. */
+void MerkleTree_Vec256_sha256_compress_8(uint8_t **src1, uint8_t **src2, uint8_t **dst);
+
+/* dst[i] = mt_blake2s_compress(src1[i], src2[i]) for i < 8; dst[i] may be
+ * src1[i] or src2[i]. */
+void MerkleTree_Vec256_blake2s_compress_8(uint8_t **src1, uint8_t **src2, uint8_t **dst);
+
+#endif
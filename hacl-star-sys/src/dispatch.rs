@@ -0,0 +1,481 @@
+//! Backend selection, done once.
+//!
+//! The first call to `table` runs `EverCrypt_AutoConfig2_init`, applies the
+//! overrides from `HACL_DISABLE` (a comma separated list of `Feature` names, e.g.
+//! `HACL_DISABLE=avx2,shaext`) and builds a static table of function pointers.
+//! Callers that keep a pointer from the table pay one indirect call per block and
+//! no feature check.
+//!
+//! A table is never written once published: `disable` builds a new one and swaps
+//! the current pointer, so readers holding the old `&'static Table` (or pointers
+//! copied out of it) keep a consistent, unchanging view.
+
+use core::{ fmt, ptr };
+use core::sync::atomic::{ AtomicBool, AtomicPtr, Ordering };
+use crate::imp::{ aead, autoconfig2::*, hash, merkle, nacl, poly1305 };
+
+
+/// Number of `Feature`s.
+const FEATURES: usize = 12;
+
+/// Cpu feature (or implementation family) that can be turned off for A/B runs.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Feature {
+    Avx512,
+    Avx2,
+    Avx,
+    Shaext,
+    Sse,
+    Bmi2,
+    Adx,
+    Aesni,
+    Pclmulqdq,
+    Movbe,
+    Rdrand,
+    /// All Vale assembly.
+    Vale,
+}
+
+impl Feature {
+    pub fn from_name(name: &str) -> Option<Feature> {
+        Some(match name {
+            "avx512" => Feature::Avx512,
+            "avx2" => Feature::Avx2,
+            "avx" => Feature::Avx,
+            "shaext" => Feature::Shaext,
+            "sse" => Feature::Sse,
+            "bmi2" => Feature::Bmi2,
+            "adx" => Feature::Adx,
+            "aesni" => Feature::Aesni,
+            "pclmulqdq" => Feature::Pclmulqdq,
+            "movbe" => Feature::Movbe,
+            "rdrand" => Feature::Rdrand,
+            "vale" => Feature::Vale,
+            _ => return None
+        })
+    }
+
+    fn disabler(self) -> unsafe extern "C" fn() {
+        match self {
+            Feature::Avx512 => EverCrypt_AutoConfig2_disable_avx512,
+            Feature::Avx2 => EverCrypt_AutoConfig2_disable_avx2,
+            Feature::Avx => EverCrypt_AutoConfig2_disable_avx,
+            Feature::Shaext => EverCrypt_AutoConfig2_disable_shaext,
+            Feature::Sse => EverCrypt_AutoConfig2_disable_sse,
+            Feature::Bmi2 => EverCrypt_AutoConfig2_disable_bmi2,
+            Feature::Adx => EverCrypt_AutoConfig2_disable_adx,
+            Feature::Aesni => EverCrypt_AutoConfig2_disable_aesni,
+            Feature::Pclmulqdq => EverCrypt_AutoConfig2_disable_pclmulqdq,
+            Feature::Movbe => EverCrypt_AutoConfig2_disable_movbe,
+            Feature::Rdrand => EverCrypt_AutoConfig2_disable_rdrand,
+            Feature::Vale => EverCrypt_AutoConfig2_disable_vale,
+        }
+    }
+}
+
+/// Poly1305 kernel, see `hacl_star::poly1305::Backend`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Poly1305 {
+    Portable,
+    Vale,
+    Vec128,
+    Vec256,
+}
+
+/// `update_multi` over a SHA2-224/256 state.
+pub type Sha256UpdateMulti = unsafe extern "C" fn(s: *mut u32, blocks: *mut u8, n_blocks: u32);
+
+/// `update_multi` over four SHA-384/512 states at once, `n_blocks` blocks each.
+pub type Sha512UpdateMulti4 = unsafe extern "C" fn(s: *mut *mut u64, blocks: *mut *mut u8, n_blocks: u32);
+
+/// Salsa20 of the NaCl secretbox and box, as `Hacl_Salsa20_salsa20_encrypt`.
+pub type Salsa20Xor = unsafe extern "C" fn(len: u32, out: *mut u8, text: *mut u8, key: *mut u8, n: *mut u8, ctr: u32);
+
+/// Poly1305 of the NaCl secretbox and box, as `Hacl_Poly1305_32_poly1305_mac`.
+pub type Poly1305Mac = unsafe extern "C" fn(tag: *mut u8, len: u32, text: *mut u8, key: *mut u8);
+
+/// ChaCha20-Poly1305 encryption, as `Hacl_Chacha20Poly1305_32_aead_encrypt`.
+pub type Chacha20Poly1305Encrypt = unsafe extern "C" fn(
+    k: *mut u8, n: *mut u8, aadlen: u32, aad: *mut u8, mlen: u32, m: *mut u8, cipher: *mut u8, mac: *mut u8
+);
+
+/// ChaCha20-Poly1305 decryption, as `Hacl_Chacha20Poly1305_32_aead_decrypt`: 0 if
+/// the tag verifies.
+pub type Chacha20Poly1305Decrypt = unsafe extern "C" fn(
+    k: *mut u8, n: *mut u8, aadlen: u32, aad: *mut u8, mlen: u32, m: *mut u8, cipher: *mut u8, mac: *mut u8
+) -> u32;
+
+#[derive(Clone, Copy)]
+pub struct Table {
+    /// Poly1305 kernel of `hacl_star::poly1305` states.
+    pub poly1305: Poly1305,
+    pub sha256_update_multi: Sha256UpdateMulti,
+    /// Name of the `sha256_update_multi` implementation.
+    pub sha256: &'static str,
+    pub salsa20_xor: Salsa20Xor,
+    /// Name of the `salsa20_xor` implementation: `vec256`, `vec128` or
+    /// `portable`. The vector ones leave inputs of up to one block group to a
+    /// narrower kernel.
+    pub salsa20: &'static str,
+    pub nacl_poly1305_mac: Poly1305Mac,
+    /// Name of the `nacl_poly1305_mac` implementation: that of `poly1305`, or
+    /// `vale+vec256` (resp. `vale+vec128`) when messages under 1 KiB go to Vale,
+    /// where the vector kernel would spend longer computing powers of r.
+    pub nacl_poly1305: &'static str,
+    pub merkle_sha256: merkle::mt_kernel,
+    pub merkle_blake2s: merkle::mt_kernel,
+    /// Name of the `merkle_sha256` kernel: `shaext` (two nodes per call), else
+    /// `vec256`, `vec128` or `portable` as for Salsa20, which `merkle_blake2s`
+    /// always follows.
+    pub merkle: &'static str,
+    pub sha512x4_update_multi: Sha512UpdateMulti4,
+    /// Name of the `sha512x4_update_multi` implementation: `vec256` or `portable`,
+    /// which runs the four states one after the other.
+    pub sha512x4: &'static str,
+    pub chacha20poly1305_encrypt: Chacha20Poly1305Encrypt,
+    pub chacha20poly1305_decrypt: Chacha20Poly1305Decrypt,
+    /// Name of the ChaCha20-Poly1305 kernels of `hacl_star::aead`: `vec256`,
+    /// `vec128` or `portable`.
+    pub chacha20poly1305: &'static str,
+    /// Whether `hacl_star::aead` has AES-GCM, which is Vale only (AES-NI,
+    /// PCLMULQDQ, AVX, SSE and MOVBE).
+    pub aes_gcm: bool,
+}
+
+/// What `table` selected, printed as
+/// `poly1305: vec256, sha256: shaext, salsa20: vec256, nacl_poly1305: vale+vec256, merkle: shaext, sha512x4: vec256,
+/// chacha20poly1305: vec256, aes_gcm: vale`, where `aes_gcm` is `vale` or `none`.
+#[derive(Clone, Copy, Debug)]
+pub struct Backends {
+    pub poly1305: Poly1305,
+    pub sha256: &'static str,
+    pub salsa20: &'static str,
+    pub nacl_poly1305: &'static str,
+    pub merkle: &'static str,
+    pub sha512x4: &'static str,
+    pub chacha20poly1305: &'static str,
+    pub aes_gcm: bool,
+}
+
+impl fmt::Display for Backends {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        let poly1305 = match self.poly1305 {
+            Poly1305::Portable => "portable",
+            Poly1305::Vale => "vale",
+            Poly1305::Vec128 => "vec128",
+            Poly1305::Vec256 => "vec256",
+        };
+
+        let aes_gcm = if self.aes_gcm { "vale" } else { "none" };
+
+        write!(
+            f,
+            "poly1305: {}, sha256: {}, salsa20: {}, nacl_poly1305: {}, merkle: {}, sha512x4: {}, \
+             chacha20poly1305: {}, aes_gcm: {}",
+            poly1305, self.sha256, self.salsa20, self.nacl_poly1305, self.merkle, self.sha512x4,
+            self.chacha20poly1305, aes_gcm
+        )
+    }
+}
+
+const PORTABLE: Table = Table {
+    poly1305: Poly1305::Portable,
+    sha256_update_multi: hash::Hacl_Hash_SHA2_update_multi_256,
+    sha256: "portable",
+    salsa20_xor: nacl::Hacl_Salsa20_salsa20_encrypt,
+    salsa20: "portable",
+    nacl_poly1305_mac: poly1305::Hacl_Poly1305_32_poly1305_mac,
+    nacl_poly1305: "portable",
+    merkle_sha256: merkle::mt_kernel { node: Some(merkle::mt_sha256_node), lanes: 1, batch: None },
+    merkle_blake2s: merkle::mt_kernel { node: Some(merkle::mt_blake2s_compress), lanes: 1, batch: None },
+    merkle: "portable",
+    sha512x4_update_multi: sha512x4_update_multi_portable,
+    sha512x4: "portable",
+    chacha20poly1305_encrypt: aead::Hacl_Chacha20Poly1305_32_aead_encrypt,
+    chacha20poly1305_decrypt: aead::Hacl_Chacha20Poly1305_32_aead_decrypt,
+    chacha20poly1305: "portable",
+    aes_gcm: false,
+};
+
+/// Every table built: the first, then at most one per `Feature` disabled. Entry
+/// `BUILT` is written under `LOCK` before `CURRENT` points to it, and no entry
+/// is written again.
+static mut TABLES: [Table; 1 + FEATURES] = [PORTABLE; 1 + FEATURES];
+
+/// The table in use, null until the first `table` call.
+static CURRENT: AtomicPtr<Table> = AtomicPtr::new(ptr::null_mut());
+
+/// Held while a table is built; guards `BUILT` and `DISABLED`.
+static LOCK: AtomicBool = AtomicBool::new(false);
+static mut BUILT: usize = 0;
+/// Bit `feature as usize` of every feature turned off so far.
+static mut DISABLED: u32 = 0;
+
+#[inline]
+pub fn table() -> &'static Table {
+    let current = CURRENT.load(Ordering::Acquire);
+
+    if current.is_null() {
+        configure(None)
+    } else {
+        unsafe { &*current }
+    }
+}
+
+pub fn backends() -> Backends {
+    let table = table();
+    Backends {
+        poly1305: table.poly1305,
+        sha256: table.sha256,
+        salsa20: table.salsa20,
+        nacl_poly1305: table.nacl_poly1305,
+        merkle: table.merkle,
+        sha512x4: table.sha512x4,
+        chacha20poly1305: table.chacha20poly1305,
+        aes_gcm: table.aes_gcm,
+    }
+}
+
+/// Turns `feature` off and publishes a table selected without it.
+///
+/// Only what reads the table after this returns sees the change: states created
+/// before it (e.g. `Sha256`, `Sha512x4`, Poly1305 states) keep the kernels they
+/// copied out of the old table, which stays valid and unchanged.
+pub fn disable(feature: Feature) {
+    configure(Some(feature));
+}
+
+/// Builds and publishes the next table, if the first is missing or `feature` is
+/// newly turned off, and returns the current one.
+fn configure(feature: Option<Feature>) -> &'static Table {
+    while LOCK.compare_exchange_weak(false, true, Ordering::Acquire, Ordering::Relaxed).is_err() {
+        core::hint::spin_loop();
+    }
+
+    let current = CURRENT.load(Ordering::Acquire);
+    let table = unsafe {
+        let mut changed = current.is_null();
+        if changed {
+            init();
+        }
+        if let Some(feature) = feature {
+            changed |= turn_off(feature);
+        }
+
+        if changed {
+            let built = BUILT;
+            assert!(built < 1 + FEATURES);
+            let next = ptr::addr_of_mut!(TABLES[built]);
+            next.write(select());
+            BUILT = built + 1;
+            CURRENT.store(next, Ordering::Release);
+            &*next
+        } else {
+            &*current
+        }
+    };
+
+    LOCK.store(false, Ordering::Release);
+    table
+}
+
+fn init() {
+    #[cfg(target_arch = "x86_64")]
+    unsafe {
+        EverCrypt_AutoConfig2_init();
+    }
+
+    with_env("HACL_DISABLE", |names| {
+        for name in names.split(|&b| b == b',') {
+            let name = core::str::from_utf8(name).unwrap_or("").trim();
+            if let Some(feature) = Feature::from_name(name) {
+                unsafe { turn_off(feature) };
+            }
+        }
+    });
+}
+
+/// Clears the cpu flag of `feature`; false if it was already off. Under `LOCK`.
+unsafe fn turn_off(feature: Feature) -> bool {
+    let bit = 1 << feature as u32;
+    if DISABLED & bit != 0 {
+        return false;
+    }
+
+    DISABLED |= bit;
+    feature.disabler()();
+    true
+}
+
+fn select() -> Table {
+    let (sha256_update_multi, sha256) = select_sha256();
+    let (sha512x4_update_multi, sha512x4) = select_sha512x4();
+    let (salsa20_xor, salsa20) = select_salsa20();
+    let (nacl_poly1305_mac, nacl_poly1305) = select_nacl_poly1305();
+    let (chacha20poly1305_encrypt, chacha20poly1305_decrypt, chacha20poly1305) = select_chacha20poly1305();
+    let (merkle_sha256, merkle_blake2s, merkle) = select_merkle();
+
+    Table {
+        poly1305: select_poly1305(),
+        sha256_update_multi,
+        sha256,
+        salsa20_xor,
+        salsa20,
+        nacl_poly1305_mac,
+        nacl_poly1305,
+        merkle_sha256,
+        merkle_blake2s,
+        merkle,
+        sha512x4_update_multi,
+        sha512x4,
+        chacha20poly1305_encrypt,
+        chacha20poly1305_decrypt,
+        chacha20poly1305,
+        aes_gcm: unsafe { aead::EverCrypt_AEAD_Inline_has_aes_gcm() },
+    }
+}
+
+/// The rule lives in the NaCl shim, which also uses it for `nacl_poly1305_mac`: on
+/// x86_64 AVX2, AVX, Vale, portable; NEON is baseline on aarch64, and wasm
+/// `simd128` is fixed at build time, since a module using it does not even load
+/// on a runtime without it.
+fn select_poly1305() -> Poly1305 {
+    match unsafe { nacl::Hacl_NaCl_Dispatch_poly1305() } {
+        nacl::Hacl_NaCl_Dispatch_POLY1305_VALE => Poly1305::Vale,
+        nacl::Hacl_NaCl_Dispatch_POLY1305_VEC128 => Poly1305::Vec128,
+        nacl::Hacl_NaCl_Dispatch_POLY1305_VEC256 => Poly1305::Vec256,
+        _ => Poly1305::Portable
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+fn select_sha256() -> (Sha256UpdateMulti, &'static str) {
+    unsafe {
+        if EverCrypt_AutoConfig2_has_shaext()
+            && EverCrypt_AutoConfig2_has_sse()
+            && EverCrypt_AutoConfig2_wants_vale()
+        {
+            (sha256_update_multi_shaext, "shaext")
+        } else {
+            (hash::Hacl_Hash_SHA2_update_multi_256, "portable")
+        }
+    }
+}
+
+#[cfg(not(target_arch = "x86_64"))]
+fn select_sha256() -> (Sha256UpdateMulti, &'static str) {
+    (hash::Hacl_Hash_SHA2_update_multi_256, "portable")
+}
+
+fn select_salsa20() -> (Salsa20Xor, &'static str) {
+    unsafe {
+        let kernel = nacl::Hacl_NaCl_Dispatch_salsa20_kernel();
+        match kernel {
+            Some(kernel) => (kernel, lanes(nacl::Hacl_NaCl_Dispatch_salsa20_lanes())),
+            None => (PORTABLE.salsa20_xor, PORTABLE.salsa20)
+        }
+    }
+}
+
+fn select_nacl_poly1305() -> (Poly1305Mac, &'static str) {
+    unsafe {
+        let kernel = nacl::Hacl_NaCl_Dispatch_poly1305_kernel();
+        let name = match (nacl::Hacl_NaCl_Dispatch_poly1305_short(), nacl::Hacl_NaCl_Dispatch_poly1305()) {
+            (nacl::Hacl_NaCl_Dispatch_POLY1305_VALE, nacl::Hacl_NaCl_Dispatch_POLY1305_VEC256) => "vale+vec256",
+            (nacl::Hacl_NaCl_Dispatch_POLY1305_VALE, nacl::Hacl_NaCl_Dispatch_POLY1305_VEC128) => "vale+vec128",
+            (_, nacl::Hacl_NaCl_Dispatch_POLY1305_VALE) => "vale",
+            (_, nacl::Hacl_NaCl_Dispatch_POLY1305_VEC256) => "vec256",
+            (_, nacl::Hacl_NaCl_Dispatch_POLY1305_VEC128) => "vec128",
+            _ => "portable"
+        };
+        match kernel {
+            Some(kernel) => (kernel, name),
+            None => (PORTABLE.nacl_poly1305_mac, PORTABLE.nacl_poly1305)
+        }
+    }
+}
+
+fn select_chacha20poly1305() -> (Chacha20Poly1305Encrypt, Chacha20Poly1305Decrypt, &'static str) {
+    unsafe {
+        let encrypt = aead::EverCrypt_AEAD_Inline_chacha20poly1305_encrypt_kernel();
+        let decrypt = aead::EverCrypt_AEAD_Inline_chacha20poly1305_decrypt_kernel();
+        match (encrypt, decrypt) {
+            (Some(encrypt), Some(decrypt)) => (encrypt, decrypt, lanes(aead::EverCrypt_AEAD_Inline_chacha20poly1305_lanes())),
+            _ => (PORTABLE.chacha20poly1305_encrypt, PORTABLE.chacha20poly1305_decrypt, PORTABLE.chacha20poly1305)
+        }
+    }
+}
+
+fn select_merkle() -> (merkle::mt_kernel, merkle::mt_kernel, &'static str) {
+    unsafe {
+        let sha256 = merkle::mt_sha256_kernel();
+        let name = match sha256.lanes {
+            2 => "shaext",
+            n => lanes(n)
+        };
+        (sha256, merkle::mt_blake2s_kernel(), name)
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+fn select_sha512x4() -> (Sha512UpdateMulti4, &'static str) {
+    if unsafe { EverCrypt_AutoConfig2_has_avx2() } {
+        (crate::imp::sha2_vec256::Hacl_SHA2_Vec256_sha512_update_multi_4, "vec256")
+    } else {
+        (sha512x4_update_multi_portable, "portable")
+    }
+}
+
+#[cfg(not(target_arch = "x86_64"))]
+fn select_sha512x4() -> (Sha512UpdateMulti4, &'static str) {
+    (sha512x4_update_multi_portable, "portable")
+}
+
+fn lanes(lanes: u32) -> &'static str {
+    match lanes {
+        8 => "vec256",
+        4 => "vec128",
+        _ => "portable"
+    }
+}
+
+/// Vale `sha256_update` with the round constants `EverCrypt_Hash` passes it.
+#[cfg(target_arch = "x86_64")]
+unsafe extern "C" fn sha256_update_multi_shaext(s: *mut u32, blocks: *mut u8, n_blocks: u32) {
+    hash::sha256_update(s, blocks, n_blocks as u64, K224_256.as_ptr() as *mut u32);
+}
+
+unsafe extern "C" fn sha512x4_update_multi_portable(s: *mut *mut u64, blocks: *mut *mut u8, n_blocks: u32) {
+    for i in 0..4 {
+        hash::Hacl_Hash_SHA2_update_multi_512(*s.add(i), *blocks.add(i), n_blocks);
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+static K224_256: [u32; 64] = [
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+];
+
+#[cfg(any(unix, windows))]
+fn with_env<F: FnOnce(&[u8])>(name: &str, f: F) {
+    let mut key = [0; 32];
+    key[..name.len()].copy_from_slice(name.as_bytes());
+
+    unsafe {
+        let value = libc::getenv(key.as_ptr() as *const libc::c_char);
+        if !value.is_null() {
+            let len = libc::strlen(value);
+            f(core::slice::from_raw_parts(value as *const u8, len));
+        }
+    }
+}
+
+#[cfg(not(any(unix, windows)))]
+fn with_env<F: FnOnce(&[u8])>(_name: &str, _f: F) {}
@@ -0,0 +1,125 @@
+/* automatically generated by rust-bindgen */
+
+pub const EverCrypt_AEAD_Inline_EK_LEN_AES128_GCM: u32 = 480;
+pub const EverCrypt_AEAD_Inline_EK_LEN_AES256_GCM: u32 = 544;
+pub const EverCrypt_AEAD_Inline_EK_LEN_CHACHA20_POLY1305: u32 = 32;
+pub const EverCrypt_Error_Success: u32 = 0;
+pub const EverCrypt_Error_UnsupportedAlgorithm: u32 = 1;
+pub const EverCrypt_Error_InvalidKey: u32 = 2;
+pub const EverCrypt_Error_AuthenticationFailure: u32 = 3;
+pub const EverCrypt_Error_InvalidIVLength: u32 = 4;
+pub const EverCrypt_Error_DecodeError: u32 = 5;
+pub const Spec_Cipher_Expansion_Hacl_CHACHA20: u32 = 0;
+pub const Spec_Cipher_Expansion_Vale_AES128: u32 = 1;
+pub const Spec_Cipher_Expansion_Vale_AES256: u32 = 2;
+pub const Spec_Agile_AEAD_AES128_GCM: u32 = 0;
+pub const Spec_Agile_AEAD_AES256_GCM: u32 = 1;
+pub const Spec_Agile_AEAD_CHACHA20_POLY1305: u32 = 2;
+pub const Spec_Agile_AEAD_AES128_CCM: u32 = 3;
+pub const Spec_Agile_AEAD_AES256_CCM: u32 = 4;
+pub const Spec_Agile_AEAD_AES128_CCM8: u32 = 5;
+pub const Spec_Agile_AEAD_AES256_CCM8: u32 = 6;
+pub type EverCrypt_Error_error_code = u8;
+pub type Spec_Cipher_Expansion_impl = u8;
+pub type Spec_Agile_AEAD_alg = u8;
+pub type EverCrypt_AEAD_Inline_chacha20poly1305_encrypt = ::core::option::Option<
+    unsafe extern "C" fn(
+        k: *mut u8,
+        n: *mut u8,
+        aadlen: u32,
+        aad: *mut u8,
+        mlen: u32,
+        m: *mut u8,
+        cipher: *mut u8,
+        mac: *mut u8,
+    ),
+>;
+pub type EverCrypt_AEAD_Inline_chacha20poly1305_decrypt = ::core::option::Option<
+    unsafe extern "C" fn(
+        k: *mut u8,
+        n: *mut u8,
+        aadlen: u32,
+        aad: *mut u8,
+        mlen: u32,
+        m: *mut u8,
+        cipher: *mut u8,
+        mac: *mut u8,
+    ) -> u32,
+>;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EverCrypt_AEAD_Inline_state_s {
+    pub impl_: Spec_Cipher_Expansion_impl,
+    pub ek: *mut u8,
+}
+pub type EverCrypt_AEAD_Inline_state = EverCrypt_AEAD_Inline_state_s;
+extern "C" {
+    pub fn Hacl_Chacha20Poly1305_32_aead_encrypt(
+        k: *mut u8,
+        n: *mut u8,
+        aadlen: u32,
+        aad: *mut u8,
+        mlen: u32,
+        m: *mut u8,
+        cipher: *mut u8,
+        mac: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Chacha20Poly1305_32_aead_decrypt(
+        k: *mut u8,
+        n: *mut u8,
+        aadlen: u32,
+        aad: *mut u8,
+        mlen: u32,
+        m: *mut u8,
+        cipher: *mut u8,
+        mac: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn EverCrypt_AEAD_Inline_has_aes_gcm() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AEAD_Inline_chacha20poly1305_lanes() -> u32;
+}
+extern "C" {
+    pub fn EverCrypt_AEAD_Inline_chacha20poly1305_encrypt_kernel() -> EverCrypt_AEAD_Inline_chacha20poly1305_encrypt;
+}
+extern "C" {
+    pub fn EverCrypt_AEAD_Inline_chacha20poly1305_decrypt_kernel() -> EverCrypt_AEAD_Inline_chacha20poly1305_decrypt;
+}
+extern "C" {
+    pub fn EverCrypt_AEAD_Inline_init(
+        a: Spec_Agile_AEAD_alg,
+        dst: *mut EverCrypt_AEAD_Inline_state,
+        ek: *mut u8,
+        k: *mut u8,
+    ) -> EverCrypt_Error_error_code;
+}
+extern "C" {
+    pub fn EverCrypt_AEAD_Inline_encrypt(
+        s: *mut EverCrypt_AEAD_Inline_state,
+        iv: *mut u8,
+        iv_len: u32,
+        ad: *mut u8,
+        ad_len: u32,
+        plain: *mut u8,
+        plain_len: u32,
+        cipher: *mut u8,
+        tag: *mut u8,
+    ) -> EverCrypt_Error_error_code;
+}
+extern "C" {
+    pub fn EverCrypt_AEAD_Inline_decrypt(
+        s: *mut EverCrypt_AEAD_Inline_state,
+        iv: *mut u8,
+        iv_len: u32,
+        ad: *mut u8,
+        ad_len: u32,
+        cipher: *mut u8,
+        cipher_len: u32,
+        tag: *mut u8,
+        dst: *mut u8,
+    ) -> EverCrypt_Error_error_code;
+}
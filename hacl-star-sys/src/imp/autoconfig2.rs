@@ -0,0 +1,99 @@
+/* automatically generated by rust-bindgen */
+
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_shaext() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_aesni() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_pclmulqdq() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_avx2() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_avx() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_bmi2() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_adx() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_sse() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_movbe() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_rdrand() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_has_avx512() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_wants_vale() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_wants_hacl() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_wants_openssl() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_wants_bcrypt() -> bool;
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_recall();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_init();
+}
+pub type EverCrypt_AutoConfig2_disabler = ::core::option::Option<unsafe extern "C" fn()>;
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_avx2();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_avx();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_bmi2();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_adx();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_shaext();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_aesni();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_pclmulqdq();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_sse();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_movbe();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_rdrand();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_avx512();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_vale();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_hacl();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_openssl();
+}
+extern "C" {
+    pub fn EverCrypt_AutoConfig2_disable_bcrypt();
+}
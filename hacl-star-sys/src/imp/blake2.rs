@@ -0,0 +1,140 @@
+/* automatically generated by rust-bindgen */
+
+pub type __uint8_t = crate::libc::c_uchar;
+pub type __uint32_t = crate::libc::c_uint;
+pub type __uint64_t = crate::libc::c_ulong;
+pub type FStar_UInt128_uint128 = crate::FStar_UInt128_uint128;
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Copy, Clone)]
+pub struct Lib_IntVector_Intrinsics_vec128(pub [u64; 2]);
+extern "C" {
+    pub fn Hacl_Blake2s_32_blake2s_init(
+        wv: *mut u32,
+        hash: *mut u32,
+        kk: u32,
+        k: *mut u8,
+        nn: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2s_32_blake2s_update_multi(
+        len: u32,
+        wv: *mut u32,
+        hash: *mut u32,
+        prev: u64,
+        blocks: *mut u8,
+        nb: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2s_32_blake2s_update_last(
+        len: u32,
+        wv: *mut u32,
+        hash: *mut u32,
+        prev: u64,
+        rem: u32,
+        d: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2s_32_blake2s_finish(nn: u32, output: *mut u8, hash: *mut u32);
+}
+extern "C" {
+    pub fn Hacl_Blake2s_32_blake2s(
+        nn: u32,
+        output: *mut u8,
+        ll: u32,
+        d: *mut u8,
+        kk: u32,
+        k: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2b_32_blake2b_init(
+        wv: *mut u64,
+        hash: *mut u64,
+        kk: u32,
+        k: *mut u8,
+        nn: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2b_32_blake2b_update_multi(
+        len: u32,
+        wv: *mut u64,
+        hash: *mut u64,
+        prev: FStar_UInt128_uint128,
+        blocks: *mut u8,
+        nb: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2b_32_blake2b_update_last(
+        len: u32,
+        wv: *mut u64,
+        hash: *mut u64,
+        prev: FStar_UInt128_uint128,
+        rem: u32,
+        d: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2b_32_blake2b_finish(nn: u32, output: *mut u8, hash: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_Blake2b_32_blake2b(
+        nn: u32,
+        output: *mut u8,
+        ll: u32,
+        d: *mut u8,
+        kk: u32,
+        k: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2s_128_blake2s_init(
+        wv: *mut Lib_IntVector_Intrinsics_vec128,
+        hash: *mut Lib_IntVector_Intrinsics_vec128,
+        kk: u32,
+        k: *mut u8,
+        nn: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2s_128_blake2s_update_multi(
+        len: u32,
+        wv: *mut Lib_IntVector_Intrinsics_vec128,
+        hash: *mut Lib_IntVector_Intrinsics_vec128,
+        prev: u64,
+        blocks: *mut u8,
+        nb: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2s_128_blake2s_update_last(
+        len: u32,
+        wv: *mut Lib_IntVector_Intrinsics_vec128,
+        hash: *mut Lib_IntVector_Intrinsics_vec128,
+        prev: u64,
+        rem: u32,
+        d: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2s_128_blake2s_finish(
+        nn: u32,
+        output: *mut u8,
+        hash: *mut Lib_IntVector_Intrinsics_vec128,
+    );
+}
+extern "C" {
+    pub fn Hacl_Blake2s_128_blake2s(
+        nn: u32,
+        output: *mut u8,
+        ll: u32,
+        d: *mut u8,
+        kk: u32,
+        k: *mut u8,
+    );
+}
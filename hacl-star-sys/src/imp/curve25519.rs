@@ -3,7 +3,31 @@
 pub type __uint8_t = crate::libc::c_uchar;
 pub type __uint32_t = crate::libc::c_uint;
 pub type __uint64_t = crate::libc::c_ulong;
-pub type FStar_UInt128_uint128 = [u64; 2];
+pub type FStar_UInt128_uint128 = crate::FStar_UInt128_uint128;
+extern "C" {
+    pub fn Hacl_Impl_Curve25519_Field51_fadd(out: *mut u64, f1: *mut u64, f2: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_Impl_Curve25519_Field51_fsub(out: *mut u64, f1: *mut u64, f2: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_Impl_Curve25519_Field51_fmul(
+        out: *mut u64,
+        f1: *mut u64,
+        f2: *mut u64,
+        uu___: *mut FStar_UInt128_uint128,
+    );
+}
+extern "C" {
+    pub fn Hacl_Impl_Curve25519_Field51_fmul1(out: *mut u64, f1: *mut u64, f2: u64);
+}
+extern "C" {
+    pub fn Hacl_Impl_Curve25519_Field51_fsqr(
+        out: *mut u64,
+        f: *mut u64,
+        uu___: *mut FStar_UInt128_uint128,
+    );
+}
 extern "C" {
     pub fn Hacl_Curve25519_51_fsquare_times(
         o: *mut u64,
@@ -24,3 +48,9 @@ extern "C" {
 extern "C" {
     pub fn Hacl_Curve25519_51_ecdh(out: *mut u8, priv_: *mut u8, pub_: *mut u8) -> bool;
 }
+extern "C" {
+    pub fn Hacl_Curve25519_51_ladder(out: *mut u64, priv_: *mut u8, pub_: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Curve25519_51_store(o: *mut u8, f: *mut u64);
+}
@@ -0,0 +1,76 @@
+/* automatically generated by rust-bindgen */
+
+pub const Spec_Hash_Definitions_SHA2_224: u32 = 0;
+pub const Spec_Hash_Definitions_SHA2_256: u32 = 1;
+pub const Spec_Hash_Definitions_SHA2_384: u32 = 2;
+pub const Spec_Hash_Definitions_SHA2_512: u32 = 3;
+pub const Spec_Hash_Definitions_SHA1: u32 = 4;
+pub const Spec_Hash_Definitions_MD5: u32 = 5;
+pub const Spec_Hash_Definitions_Blake2S: u32 = 6;
+pub const Spec_Hash_Definitions_Blake2B: u32 = 7;
+pub type Spec_Hash_Definitions_hash_alg = u8;
+pub type Hacl_HMAC_DRBG_supported_alg = Spec_Hash_Definitions_hash_alg;
+extern "C" {
+    pub static mut Hacl_HMAC_DRBG_reseed_interval: u32;
+}
+extern "C" {
+    pub static mut Hacl_HMAC_DRBG_max_output_length: u32;
+}
+extern "C" {
+    pub static mut Hacl_HMAC_DRBG_max_length: u32;
+}
+extern "C" {
+    pub static mut Hacl_HMAC_DRBG_max_personalization_string_length: u32;
+}
+extern "C" {
+    pub static mut Hacl_HMAC_DRBG_max_additional_input_length: u32;
+}
+extern "C" {
+    pub fn Hacl_HMAC_DRBG_min_length(a: Spec_Hash_Definitions_hash_alg) -> u32;
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct Hacl_HMAC_DRBG_state_s {
+    pub k: *mut u8,
+    pub v: *mut u8,
+    pub reseed_counter: *mut u32,
+}
+pub type Hacl_HMAC_DRBG_state = Hacl_HMAC_DRBG_state_s;
+extern "C" {
+    pub fn Hacl_HMAC_DRBG_create_in(a: Spec_Hash_Definitions_hash_alg) -> Hacl_HMAC_DRBG_state;
+}
+extern "C" {
+    pub fn Hacl_HMAC_DRBG_instantiate(
+        a: Spec_Hash_Definitions_hash_alg,
+        st: Hacl_HMAC_DRBG_state,
+        entropy_input_len: u32,
+        entropy_input: *mut u8,
+        nonce_len: u32,
+        nonce: *mut u8,
+        personalization_string_len: u32,
+        personalization_string: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_HMAC_DRBG_reseed(
+        a: Spec_Hash_Definitions_hash_alg,
+        st: Hacl_HMAC_DRBG_state,
+        entropy_input_len: u32,
+        entropy_input: *mut u8,
+        additional_input_input_len: u32,
+        additional_input_input: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_HMAC_DRBG_generate(
+        a: Spec_Hash_Definitions_hash_alg,
+        output: *mut u8,
+        st: Hacl_HMAC_DRBG_state,
+        n: u32,
+        additional_input_len: u32,
+        additional_input: *mut u8,
+    ) -> bool;
+}
+extern "C" {
+    pub fn Lib_RandomBuffer_System_randombytes(buf: *mut u8, len: u32) -> bool;
+}
@@ -0,0 +1,50 @@
+/* automatically generated by rust-bindgen */
+
+extern "C" {
+    pub fn Hacl_EC_Ed25519_mk_felem_zero(b: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_mk_felem_one(b: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_felem_add(a: *mut u64, b: *mut u64, out: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_felem_sub(a: *mut u64, b: *mut u64, out: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_felem_mul(a: *mut u64, b: *mut u64, out: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_felem_inv(a: *mut u64, out: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_felem_load(b: *mut u8, out: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_felem_store(a: *mut u64, out: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_mk_point_at_inf(p: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_mk_base_point(p: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_point_negate(p: *mut u64, out: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_point_add(p: *mut u64, q: *mut u64, out: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_point_mul(scalar: *mut u8, p: *mut u64, out: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_point_eq(p: *mut u64, q: *mut u64) -> bool;
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_point_compress(p: *mut u64, out: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_EC_Ed25519_point_decompress(s: *mut u8, out: *mut u64) -> bool;
+}
@@ -17,3 +17,15 @@ extern "C" {
 extern "C" {
     pub fn Hacl_Ed25519_sign_expanded(signature: *mut u8, ks: *mut u8, len: u32, msg: *mut u8);
 }
+extern "C" {
+    pub fn Hacl_Ed25519_Ctx_reduce(out: *mut u8, hash: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Ed25519_Ctx_point_mul_g_compress(out: *mut u8, s: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Ed25519_Ctx_sign_finish(s: *mut u8, r: *mut u8, h: *mut u8, a: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Ed25519_Ctx_verify_finish(pub_: *mut u8, signature: *mut u8, h: *mut u8) -> bool;
+}
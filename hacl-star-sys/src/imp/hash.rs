@@ -3,7 +3,7 @@
 pub type __uint8_t = crate::libc::c_uchar;
 pub type __uint32_t = crate::libc::c_uint;
 pub type __uint64_t = crate::libc::c_ulong;
-pub type FStar_UInt128_uint128 = [u64; 2];
+pub type FStar_UInt128_uint128 = crate::FStar_UInt128_uint128;
 pub type Spec_Hash_Definitions_hash_alg = u8;
 extern "C" {
     pub fn Hacl_Hash_Core_Blake2_update_blake2s_32(s: *mut u32, totlen: u64, block: *mut u8)
@@ -234,3 +234,6 @@ extern "C" {
 extern "C" {
     pub fn Hacl_Hash_Definitions_hash_len(a: Spec_Hash_Definitions_hash_alg) -> u32;
 }
+extern "C" {
+    pub fn sha256_update(x0: *mut u32, x1: *mut u8, x2: u64, x3: *mut u32) -> u64;
+}
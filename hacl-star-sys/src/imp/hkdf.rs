@@ -0,0 +1,80 @@
+/* automatically generated by rust-bindgen */
+
+pub type __uint8_t = crate::libc::c_uchar;
+pub type __uint32_t = crate::libc::c_uint;
+extern "C" {
+    pub fn Hacl_HKDF_expand_sha2_256(
+        okm: *mut u8,
+        prk: *mut u8,
+        prklen: u32,
+        info: *mut u8,
+        infolen: u32,
+        len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HKDF_extract_sha2_256(
+        prk: *mut u8,
+        salt: *mut u8,
+        saltlen: u32,
+        ikm: *mut u8,
+        ikmlen: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HKDF_expand_sha2_512(
+        okm: *mut u8,
+        prk: *mut u8,
+        prklen: u32,
+        info: *mut u8,
+        infolen: u32,
+        len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HKDF_extract_sha2_512(
+        prk: *mut u8,
+        salt: *mut u8,
+        saltlen: u32,
+        ikm: *mut u8,
+        ikmlen: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HKDF_expand_blake2s_32(
+        okm: *mut u8,
+        prk: *mut u8,
+        prklen: u32,
+        info: *mut u8,
+        infolen: u32,
+        len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HKDF_extract_blake2s_32(
+        prk: *mut u8,
+        salt: *mut u8,
+        saltlen: u32,
+        ikm: *mut u8,
+        ikmlen: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HKDF_expand_blake2b_32(
+        okm: *mut u8,
+        prk: *mut u8,
+        prklen: u32,
+        info: *mut u8,
+        infolen: u32,
+        len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HKDF_extract_blake2b_32(
+        prk: *mut u8,
+        salt: *mut u8,
+        saltlen: u32,
+        ikm: *mut u8,
+        ikmlen: u32,
+    );
+}
@@ -0,0 +1,58 @@
+/* automatically generated by rust-bindgen */
+
+pub type __uint8_t = crate::libc::c_uchar;
+pub type __uint32_t = crate::libc::c_uint;
+extern "C" {
+    pub fn Hacl_HMAC_legacy_compute_sha1(
+        dst: *mut u8,
+        key: *mut u8,
+        key_len: u32,
+        data: *mut u8,
+        data_len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HMAC_compute_sha2_256(
+        dst: *mut u8,
+        key: *mut u8,
+        key_len: u32,
+        data: *mut u8,
+        data_len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HMAC_compute_sha2_384(
+        dst: *mut u8,
+        key: *mut u8,
+        key_len: u32,
+        data: *mut u8,
+        data_len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HMAC_compute_sha2_512(
+        dst: *mut u8,
+        key: *mut u8,
+        key_len: u32,
+        data: *mut u8,
+        data_len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HMAC_compute_blake2s_32(
+        dst: *mut u8,
+        key: *mut u8,
+        key_len: u32,
+        data: *mut u8,
+        data_len: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_HMAC_compute_blake2b_32(
+        dst: *mut u8,
+        key: *mut u8,
+        key_len: u32,
+        data: *mut u8,
+        data_len: u32,
+    );
+}
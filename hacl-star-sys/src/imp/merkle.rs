@@ -0,0 +1,211 @@
+/* automatically generated by rust-bindgen */
+
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct MerkleTree_Low_Datastructures_hash_vec_s {
+    pub sz: u32,
+    pub cap: u32,
+    pub vs: *mut *mut u8,
+}
+pub type MerkleTree_Low_Datastructures_hash_vec = MerkleTree_Low_Datastructures_hash_vec_s;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct MerkleTree_Low_path_s {
+    pub hash_size: u32,
+    pub hashes: MerkleTree_Low_Datastructures_hash_vec,
+}
+pub type MerkleTree_Low_path = MerkleTree_Low_path_s;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct MerkleTree_Low_Datastructures_hash_vv_s {
+    pub sz: u32,
+    pub cap: u32,
+    pub vs: *mut MerkleTree_Low_Datastructures_hash_vec,
+}
+pub type MerkleTree_Low_Datastructures_hash_vv = MerkleTree_Low_Datastructures_hash_vv_s;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct MerkleTree_Low_merkle_tree_s {
+    pub hash_size: u32,
+    pub offset: u64,
+    pub i: u32,
+    pub j: u32,
+    pub hs: MerkleTree_Low_Datastructures_hash_vv,
+    pub rhs_ok: bool,
+    pub rhs: MerkleTree_Low_Datastructures_hash_vec,
+    pub mroot: *mut u8,
+    pub hash_fun: ::core::option::Option<
+        unsafe extern "C" fn(x0: *mut u8, x1: *mut u8, x2: *mut u8),
+    >,
+}
+pub type MerkleTree_Low_merkle_tree = MerkleTree_Low_merkle_tree_s;
+pub type mt_p = *mut MerkleTree_Low_merkle_tree;
+extern "C" {
+    pub fn mt_init_hash(hash_size: u32) -> *mut u8;
+}
+extern "C" {
+    pub fn mt_free_hash(h: *mut u8);
+}
+extern "C" {
+    pub fn mt_init_path(hash_size: u32) -> *mut MerkleTree_Low_path;
+}
+extern "C" {
+    pub fn mt_free_path(path1: *mut MerkleTree_Low_path);
+}
+extern "C" {
+    pub fn mt_get_path_length(path1: *const MerkleTree_Low_path) -> u32;
+}
+extern "C" {
+    pub fn mt_path_insert(path1: *mut MerkleTree_Low_path, hash1: *mut u8);
+}
+extern "C" {
+    pub fn mt_get_path_step(path1: *const MerkleTree_Low_path, i: u32) -> *mut u8;
+}
+extern "C" {
+    pub fn mt_get_path_step_pre(path1: *const MerkleTree_Low_path, i: u32) -> bool;
+}
+extern "C" {
+    pub fn mt_create_custom(
+        hash_size: u32,
+        i: *mut u8,
+        hash_fun: ::core::option::Option<
+            unsafe extern "C" fn(x0: *mut u8, x1: *mut u8, x2: *mut u8),
+        >,
+    ) -> *mut MerkleTree_Low_merkle_tree;
+}
+extern "C" {
+    pub fn mt_free(mt: *mut MerkleTree_Low_merkle_tree);
+}
+extern "C" {
+    pub fn mt_insert(mt: *mut MerkleTree_Low_merkle_tree, v: *mut u8);
+}
+extern "C" {
+    pub fn mt_insert_pre(mt: *const MerkleTree_Low_merkle_tree, v: *mut u8) -> bool;
+}
+extern "C" {
+    pub fn mt_get_root(mt: *const MerkleTree_Low_merkle_tree, root: *mut u8);
+}
+extern "C" {
+    pub fn mt_get_root_pre(mt: *const MerkleTree_Low_merkle_tree, root: *mut u8) -> bool;
+}
+extern "C" {
+    pub fn mt_get_path(
+        mt: *const MerkleTree_Low_merkle_tree,
+        idx: u64,
+        path1: *mut MerkleTree_Low_path,
+        root: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn mt_get_path_pre(
+        mt: *const MerkleTree_Low_merkle_tree,
+        idx: u64,
+        path1: *const MerkleTree_Low_path,
+        root: *mut u8,
+    ) -> bool;
+}
+extern "C" {
+    pub fn mt_flush(mt: *mut MerkleTree_Low_merkle_tree);
+}
+extern "C" {
+    pub fn mt_flush_pre(mt: *const MerkleTree_Low_merkle_tree) -> bool;
+}
+extern "C" {
+    pub fn mt_flush_to(mt: *mut MerkleTree_Low_merkle_tree, idx: u64);
+}
+extern "C" {
+    pub fn mt_flush_to_pre(mt: *const MerkleTree_Low_merkle_tree, idx: u64) -> bool;
+}
+extern "C" {
+    pub fn mt_retract_to(mt: *mut MerkleTree_Low_merkle_tree, idx: u64);
+}
+extern "C" {
+    pub fn mt_retract_to_pre(mt: *const MerkleTree_Low_merkle_tree, idx: u64) -> bool;
+}
+extern "C" {
+    pub fn mt_verify(
+        mt: *const MerkleTree_Low_merkle_tree,
+        tgt: u64,
+        max: u64,
+        path1: *const MerkleTree_Low_path,
+        root: *mut u8,
+    ) -> bool;
+}
+extern "C" {
+    pub fn mt_verify_pre(
+        mt: *const MerkleTree_Low_merkle_tree,
+        tgt: u64,
+        max: u64,
+        path1: *const MerkleTree_Low_path,
+        root: *mut u8,
+    ) -> bool;
+}
+extern "C" {
+    pub fn mt_serialize_size(mt: *const MerkleTree_Low_merkle_tree) -> u64;
+}
+extern "C" {
+    pub fn mt_serialize(mt: *const MerkleTree_Low_merkle_tree, buf: *mut u8, len: u64) -> u64;
+}
+extern "C" {
+    pub fn mt_deserialize(
+        buf: *const u8,
+        len: u64,
+        hash_fun: ::core::option::Option<
+            unsafe extern "C" fn(x0: *mut u8, x1: *mut u8, x2: *mut u8),
+        >,
+    ) -> *mut MerkleTree_Low_merkle_tree;
+}
+extern "C" {
+    pub fn mt_serialize_path(path1: *const MerkleTree_Low_path, buf: *mut u8, len: u64) -> u64;
+}
+extern "C" {
+    pub fn mt_deserialize_path(buf: *const u8, len: u64) -> *mut MerkleTree_Low_path;
+}
+pub type mt_p0 = *mut MerkleTree_Low_merkle_tree;
+extern "C" {
+    pub fn mt_sha256_compress(src1: *mut u8, src2: *mut u8, dst: *mut u8);
+}
+extern "C" {
+    pub fn mt_create(init: *mut u8) -> *mut MerkleTree_Low_merkle_tree;
+}
+extern "C" {
+    pub fn mt_blake2s_compress(src1: *mut u8, src2: *mut u8, dst: *mut u8);
+}
+extern "C" {
+    pub fn mt_blake2b_compress(src1: *mut u8, src2: *mut u8, dst: *mut u8);
+}
+extern "C" {
+    pub fn mt_sha256_node(src1: *mut u8, src2: *mut u8, dst: *mut u8);
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct mt_kernel_s {
+    pub node: ::core::option::Option<
+        unsafe extern "C" fn(src1: *mut u8, src2: *mut u8, dst: *mut u8),
+    >,
+    pub lanes: u32,
+    pub batch: ::core::option::Option<
+        unsafe extern "C" fn(src1: *mut *mut u8, src2: *mut *mut u8, dst: *mut *mut u8),
+    >,
+}
+pub type mt_kernel = mt_kernel_s;
+extern "C" {
+    pub fn mt_sha256_kernel() -> mt_kernel;
+}
+extern "C" {
+    pub fn mt_blake2s_kernel() -> mt_kernel;
+}
+extern "C" {
+    pub fn mt_hash_pairs(k: *const mt_kernel, hsz: u32, n: u32, src: *mut u8, dst: *mut u8);
+}
+extern "C" {
+    pub fn mt_insert_batch_pre(mt: *const MerkleTree_Low_merkle_tree, n: u32, vs: *mut u8) -> bool;
+}
+extern "C" {
+    pub fn mt_insert_batch(
+        mt: *mut MerkleTree_Low_merkle_tree,
+        k: *const mt_kernel,
+        n: u32,
+        vs: *mut u8,
+    );
+}
@@ -1,3 +1,14 @@
+pub mod aead;
+pub mod autoconfig2;
+pub mod blake2;
 pub mod curve25519;
+pub mod drbg;
+pub mod ec_ed25519;
 pub mod ed25519;
+pub mod hash;
+pub mod hkdf;
+pub mod hmac;
+pub mod merkle;
 pub mod nacl;
+pub mod poly1305;
+pub mod sha2_vec256;
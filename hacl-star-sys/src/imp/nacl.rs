@@ -1,3 +1,183 @@
 /* automatically generated by rust-bindgen */
 
-
+pub const Hacl_NaCl_Dispatch_POLY1305_PORTABLE: u32 = 0;
+pub const Hacl_NaCl_Dispatch_POLY1305_VALE: u32 = 1;
+pub const Hacl_NaCl_Dispatch_POLY1305_VEC128: u32 = 2;
+pub const Hacl_NaCl_Dispatch_POLY1305_VEC256: u32 = 3;
+pub type __uint8_t = crate::libc::c_uchar;
+pub type __uint32_t = crate::libc::c_uint;
+pub type Hacl_NaCl_Dispatch_salsa20_xor = ::core::option::Option<
+    unsafe extern "C" fn(len: u32, out: *mut u8, text: *mut u8, key: *mut u8, n: *mut u8, ctr: u32),
+>;
+pub type Hacl_NaCl_Dispatch_poly1305_mac =
+    ::core::option::Option<unsafe extern "C" fn(tag: *mut u8, len: u32, text: *mut u8, key: *mut u8)>;
+extern "C" {
+    pub fn Hacl_Salsa20_salsa20_encrypt(
+        len: u32,
+        out: *mut u8,
+        text: *mut u8,
+        key: *mut u8,
+        n: *mut u8,
+        ctr: u32,
+    );
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_secretbox_detached(
+        c: *mut u8,
+        tag: *mut u8,
+        m: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_secretbox_open_detached(
+        m: *mut u8,
+        c: *mut u8,
+        tag: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_secretbox_easy(
+        c: *mut u8,
+        m: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_secretbox_open_easy(
+        m: *mut u8,
+        c: *mut u8,
+        clen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_beforenm(k: *mut u8, pk: *mut u8, sk: *mut u8) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_detached_afternm(
+        c: *mut u8,
+        tag: *mut u8,
+        m: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_detached(
+        c: *mut u8,
+        tag: *mut u8,
+        m: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        pk: *mut u8,
+        sk: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_open_detached_afternm(
+        m: *mut u8,
+        c: *mut u8,
+        tag: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_open_detached(
+        m: *mut u8,
+        c: *mut u8,
+        tag: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        pk: *mut u8,
+        sk: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_easy_afternm(
+        c: *mut u8,
+        m: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_easy(
+        c: *mut u8,
+        m: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        pk: *mut u8,
+        sk: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_open_easy_afternm(
+        m: *mut u8,
+        c: *mut u8,
+        clen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_crypto_box_open_easy(
+        m: *mut u8,
+        c: *mut u8,
+        clen: u32,
+        n: *mut u8,
+        pk: *mut u8,
+        sk: *mut u8,
+    ) -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_Dispatch_salsa20_lanes() -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_Dispatch_poly1305() -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_Dispatch_poly1305_short() -> u32;
+}
+extern "C" {
+    pub fn Hacl_NaCl_Dispatch_salsa20_kernel() -> Hacl_NaCl_Dispatch_salsa20_xor;
+}
+extern "C" {
+    pub fn Hacl_NaCl_Dispatch_poly1305_kernel() -> Hacl_NaCl_Dispatch_poly1305_mac;
+}
+extern "C" {
+    pub fn Hacl_NaCl_Dispatch_secretbox_detached(
+        salsa20_xor: Hacl_NaCl_Dispatch_salsa20_xor,
+        poly1305_mac: Hacl_NaCl_Dispatch_poly1305_mac,
+        c: *mut u8,
+        tag: *mut u8,
+        m: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_NaCl_Dispatch_secretbox_open_detached(
+        salsa20_xor: Hacl_NaCl_Dispatch_salsa20_xor,
+        poly1305_mac: Hacl_NaCl_Dispatch_poly1305_mac,
+        m: *mut u8,
+        c: *mut u8,
+        tag: *mut u8,
+        mlen: u32,
+        n: *mut u8,
+        k: *mut u8,
+    ) -> u32;
+}
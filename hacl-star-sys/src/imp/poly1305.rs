@@ -0,0 +1,83 @@
+/* automatically generated by rust-bindgen */
+
+pub type __uint8_t = crate::libc::c_uchar;
+pub type __uint32_t = crate::libc::c_uint;
+pub type __uint64_t = crate::libc::c_ulong;
+#[repr(C)]
+#[repr(align(16))]
+#[derive(Debug, Copy, Clone)]
+pub struct Lib_IntVector_Intrinsics_vec128(pub [u64; 2]);
+#[repr(C)]
+#[repr(align(32))]
+#[derive(Debug, Copy, Clone)]
+pub struct Lib_IntVector_Intrinsics_vec256(pub [u64; 4]);
+extern "C" {
+    pub fn Hacl_Poly1305_32_poly1305_init(ctx: *mut u64, key: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Poly1305_32_poly1305_update1(ctx: *mut u64, text: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Poly1305_32_poly1305_update(ctx: *mut u64, len: u32, text: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Poly1305_32_poly1305_finish(tag: *mut u8, key: *mut u8, ctx: *mut u64);
+}
+extern "C" {
+    pub fn Hacl_Poly1305_32_poly1305_mac(tag: *mut u8, len: u32, text: *mut u8, key: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Poly1305_128_poly1305_init(ctx: *mut Lib_IntVector_Intrinsics_vec128, key: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Poly1305_128_poly1305_update1(
+        ctx: *mut Lib_IntVector_Intrinsics_vec128,
+        text: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Poly1305_128_poly1305_update(
+        ctx: *mut Lib_IntVector_Intrinsics_vec128,
+        len: u32,
+        text: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Poly1305_128_poly1305_finish(
+        tag: *mut u8,
+        key: *mut u8,
+        ctx: *mut Lib_IntVector_Intrinsics_vec128,
+    );
+}
+extern "C" {
+    pub fn Hacl_Poly1305_128_poly1305_mac(tag: *mut u8, len: u32, text: *mut u8, key: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Poly1305_256_poly1305_init(ctx: *mut Lib_IntVector_Intrinsics_vec256, key: *mut u8);
+}
+extern "C" {
+    pub fn Hacl_Poly1305_256_poly1305_update1(
+        ctx: *mut Lib_IntVector_Intrinsics_vec256,
+        text: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Poly1305_256_poly1305_update(
+        ctx: *mut Lib_IntVector_Intrinsics_vec256,
+        len: u32,
+        text: *mut u8,
+    );
+}
+extern "C" {
+    pub fn Hacl_Poly1305_256_poly1305_finish(
+        tag: *mut u8,
+        key: *mut u8,
+        ctx: *mut Lib_IntVector_Intrinsics_vec256,
+    );
+}
+extern "C" {
+    pub fn Hacl_Poly1305_256_poly1305_mac(tag: *mut u8, len: u32, text: *mut u8, key: *mut u8);
+}
+extern "C" {
+    pub fn x64_poly1305(x0: *mut u8, x1: *mut u8, x2: u64, x3: u64) -> u64;
+}
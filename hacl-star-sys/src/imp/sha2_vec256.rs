@@ -0,0 +1,9 @@
+/* automatically generated by rust-bindgen */
+
+extern "C" {
+    pub fn Hacl_SHA2_Vec256_sha512_update_multi_4(
+        st: *mut *mut u64,
+        blocks: *mut *mut u8,
+        n_blocks: u32,
+    );
+}
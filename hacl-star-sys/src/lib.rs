@@ -21,6 +21,42 @@ mod libc {
     pub type c_uchar = u8;
 }
 
+/// `FStar_UInt128_uint128` as laid out by `kremlin/internal/types.h` on this target.
+#[cfg(all(target_arch = "x86_64", target_env = "msvc"))]
+pub type FStar_UInt128_uint128 = core::arch::x86_64::__m128i;
+
+#[cfg(all(
+    any(target_pointer_width = "64", target_arch = "wasm32"),
+    not(all(target_arch = "x86_64", target_env = "msvc"))
+))]
+pub type FStar_UInt128_uint128 = u128;
+
+#[cfg(not(any(target_pointer_width = "64", target_arch = "wasm32")))]
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct FStar_UInt128_uint128 {
+    pub low: u64,
+    pub high: u64,
+}
+
+#[inline]
+pub fn uint128(x: u128) -> FStar_UInt128_uint128 {
+    #[cfg(all(target_arch = "x86_64", target_env = "msvc"))]
+    return unsafe { core::mem::transmute(x) };
+
+    #[cfg(all(
+        any(target_pointer_width = "64", target_arch = "wasm32"),
+        not(all(target_arch = "x86_64", target_env = "msvc"))
+    ))]
+    return x;
+
+    #[cfg(not(any(target_pointer_width = "64", target_arch = "wasm32")))]
+    return FStar_UInt128_uint128 {
+        low: x as u64,
+        high: (x >> 64) as u64,
+    };
+}
+
 #[cfg(any(
     not(feature = "bindgen"),
     all(feature = "bindgen", feature = "overwrite")
@@ -45,9 +81,21 @@ mod imp {
     import! {
         pub mod hash;
         pub mod ed25519;
+        pub mod ec_ed25519;
         pub mod curve25519;
         pub mod nacl;
+        pub mod poly1305;
+        pub mod autoconfig2;
+        pub mod blake2;
+        pub mod hmac;
+        pub mod hkdf;
+        pub mod drbg;
+        pub mod aead;
+        pub mod merkle;
+        pub mod sha2_vec256;
     }
 }
 
 pub use imp::*;
+
+pub mod dispatch;
@@ -0,0 +1,464 @@
+use core::ptr;
+use core::cell::UnsafeCell;
+use core::sync::atomic::{ AtomicBool, AtomicU32, AtomicU64, Ordering };
+use hacl_star_sys as ffi;
+use ffi::aead::*;
+use ffi::dispatch::{ Chacha20Poly1305Encrypt, Chacha20Poly1305Decrypt };
+use crate::wipe::wipe;
+
+
+pub const MAC_LENGTH: usize = 16;
+
+/// Largest expanded key (`EverCrypt_AEAD_Inline_EK_LEN_AES256_GCM`).
+const EK_LENGTH: usize = 544;
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Alg {
+    /// Vale AES-GCM, needs AES-NI, PCLMULQDQ, AVX, SSE and MOVBE.
+    Aes128Gcm,
+    Aes256Gcm,
+    /// RFC 8439, everywhere.
+    Chacha20Poly1305
+}
+
+impl Alg {
+    pub fn key_length(self) -> usize {
+        match self {
+            Alg::Aes128Gcm => 16,
+            Alg::Aes256Gcm | Alg::Chacha20Poly1305 => 32
+        }
+    }
+
+    fn as_ffi(self) -> Spec_Agile_AEAD_alg {
+        (match self {
+            Alg::Aes128Gcm => Spec_Agile_AEAD_AES128_GCM,
+            Alg::Aes256Gcm => Spec_Agile_AEAD_AES256_GCM,
+            Alg::Chacha20Poly1305 => Spec_Agile_AEAD_CHACHA20_POLY1305
+        }) as _
+    }
+}
+
+#[repr(C, align(16))]
+#[derive(Clone)]
+struct ExpandedKey([u8; EK_LENGTH]);
+
+/// Expanded AEAD key, held inline: unlike `EverCrypt_AEAD_create_in` nothing is
+/// allocated, so an `Aead` can sit in a connection struct, on the stack or in a
+/// preallocated slot, and re-keying with `rekey` reuses its storage.
+///
+/// The AES-GCM key also holds the scratch space of the Vale kernels, which is why
+/// `encrypt` and `decrypt` take `&mut self`.
+///
+/// ChaCha20-Poly1305 runs the kernels `rekey` copies out of `dispatch::table`, so
+/// no call checks the cpu.
+#[derive(Clone)]
+pub struct Aead {
+    alg: Alg,
+    impl_: Spec_Cipher_Expansion_impl,
+    keyed: bool,
+    chacha20poly1305_encrypt: Chacha20Poly1305Encrypt,
+    chacha20poly1305_decrypt: Chacha20Poly1305Decrypt,
+    ek: ExpandedKey
+}
+
+impl Aead {
+    /// Expands `key`, or returns `None` if `alg` is not supported by this cpu.
+    pub fn new(alg: Alg, key: &[u8]) -> Option<Aead> {
+        let mut aead = Aead::empty();
+
+        if aead.rekey(alg, key) {
+            Some(aead)
+        } else {
+            None
+        }
+    }
+
+    /// Replaces the key in place; returns `false` (and keeps no key) if `alg` is
+    /// not supported.
+    pub fn rekey(&mut self, alg: Alg, key: &[u8]) -> bool {
+        assert_eq!(key.len(), alg.key_length());
+
+        wipe(&mut self.ek.0);
+
+        let table = ffi::dispatch::table();
+        self.alg = alg;
+        self.chacha20poly1305_encrypt = table.chacha20poly1305_encrypt;
+        self.chacha20poly1305_decrypt = table.chacha20poly1305_decrypt;
+
+        if alg != Alg::Chacha20Poly1305 && !table.aes_gcm {
+            self.keyed = false;
+            return false;
+        }
+
+        let mut state = EverCrypt_AEAD_Inline_state { impl_: 0, ek: ptr::null_mut() };
+        let err = unsafe {
+            EverCrypt_AEAD_Inline_init(
+                alg.as_ffi(),
+                &mut state,
+                self.ek.0.as_mut_ptr(),
+                key.as_ptr() as _
+            )
+        };
+
+        self.impl_ = state.impl_;
+        self.keyed = err == EverCrypt_Error_Success as _;
+        self.keyed
+    }
+
+    const fn empty() -> Aead {
+        Aead {
+            alg: Alg::Chacha20Poly1305,
+            impl_: 0,
+            keyed: false,
+            chacha20poly1305_encrypt: Hacl_Chacha20Poly1305_32_aead_encrypt,
+            chacha20poly1305_decrypt: Hacl_Chacha20Poly1305_32_aead_decrypt,
+            ek: ExpandedKey([0; EK_LENGTH])
+        }
+    }
+
+    /// Wipes the key; the state is unusable until the next `rekey`.
+    pub fn clear(&mut self) {
+        wipe(&mut self.ek.0);
+        self.keyed = false;
+    }
+
+    #[inline]
+    pub fn alg(&self) -> Alg {
+        self.alg
+    }
+
+    /// Encrypts `m` in place and writes the tag into `mac`.
+    pub fn encrypt(&mut self, nonce: &[u8], aad: &[u8], m: &mut [u8], mac: &mut [u8; MAC_LENGTH]) {
+        self.check(nonce, aad, m);
+
+        if self.alg == Alg::Chacha20Poly1305 {
+            unsafe {
+                (self.chacha20poly1305_encrypt)(
+                    self.ek.0.as_mut_ptr(),
+                    nonce.as_ptr() as _,
+                    aad.len() as _,
+                    aad.as_ptr() as _,
+                    m.len() as _,
+                    m.as_ptr() as _,
+                    m.as_mut_ptr(),
+                    mac.as_mut_ptr()
+                );
+            }
+            return;
+        }
+
+        let err = unsafe {
+            EverCrypt_AEAD_Inline_encrypt(
+                &mut self.as_ffi(),
+                nonce.as_ptr() as _,
+                nonce.len() as _,
+                aad.as_ptr() as _,
+                aad.len() as _,
+                m.as_ptr() as _,
+                m.len() as _,
+                m.as_mut_ptr(),
+                mac.as_mut_ptr()
+            )
+        };
+
+        assert_eq!(err, EverCrypt_Error_Success as _);
+    }
+
+    /// Decrypts `c` in place if `mac` verifies. On failure `c` is zeroed.
+    pub fn decrypt(&mut self, nonce: &[u8], aad: &[u8], c: &mut [u8], mac: &[u8; MAC_LENGTH]) -> bool {
+        self.check(nonce, aad, c);
+
+        let ok = if self.alg == Alg::Chacha20Poly1305 {
+            unsafe {
+                (self.chacha20poly1305_decrypt)(
+                    self.ek.0.as_mut_ptr(),
+                    nonce.as_ptr() as _,
+                    aad.len() as _,
+                    aad.as_ptr() as _,
+                    c.len() as _,
+                    c.as_mut_ptr(),
+                    c.as_ptr() as _,
+                    mac.as_ptr() as _
+                ) == 0
+            }
+        } else {
+            self.decrypt_aes_gcm(nonce, aad, c, mac)
+        };
+
+        if ok {
+            true
+        } else {
+            wipe(c);
+            false
+        }
+    }
+
+    fn decrypt_aes_gcm(&mut self, nonce: &[u8], aad: &[u8], c: &mut [u8], mac: &[u8; MAC_LENGTH]) -> bool {
+        let err = unsafe {
+            EverCrypt_AEAD_Inline_decrypt(
+                &mut self.as_ffi(),
+                nonce.as_ptr() as _,
+                nonce.len() as _,
+                aad.as_ptr() as _,
+                aad.len() as _,
+                c.as_ptr() as _,
+                c.len() as _,
+                mac.as_ptr() as _,
+                c.as_mut_ptr()
+            )
+        };
+
+        err == EverCrypt_Error_Success as _
+    }
+
+    fn check(&self, nonce: &[u8], aad: &[u8], m: &[u8]) {
+        assert!(self.keyed);
+
+        match self.alg {
+            Alg::Chacha20Poly1305 => assert_eq!(nonce.len(), 12),
+            Alg::Aes128Gcm | Alg::Aes256Gcm => assert!(!nonce.is_empty() && nonce.len() <= u32::max_value() as usize)
+        }
+
+        assert!(aad.len() <= u32::max_value() as usize);
+        assert!(m.len() <= u32::max_value() as usize);
+    }
+
+    #[inline]
+    fn as_ffi(&mut self) -> EverCrypt_AEAD_Inline_state {
+        EverCrypt_AEAD_Inline_state {
+            impl_: self.impl_,
+            ek: self.ek.0.as_mut_ptr()
+        }
+    }
+}
+
+/// Slab of expanded keys for many concurrent sessions.
+///
+/// Slots come from the caller (a `Vec`, a boxed slice, an array or a `&mut` slice),
+/// so memory is fixed up front and nothing is allocated per key. The pool takes
+/// them by value or by unique borrow, so two pools never share a slot:
+///
+/// ```compile_fail,E0499
+/// use hacl_star::aead::{ AeadKeyPool, Slot };
+///
+/// let mut slots = [Slot::new(), Slot::new()];
+/// let pool = AeadKeyPool::new(&mut slots[..]);
+/// let other = AeadKeyPool::new(&mut slots[..]);
+/// drop(pool);
+/// ```
+/// `insert` expands a key into
+/// a free slot and returns a `Handle`; `remove` wipes the slot and recycles it, after
+/// which old handles to it, like handles of other pools, are rejected. The free list is lock-free and each slot
+/// has its own lock, so records under different handles never wait on each other.
+pub struct AeadKeyPool<S: AsRef<[Slot]> + AsMut<[Slot]>> {
+    slots: S,
+    /// Tag of this pool's handles.
+    id: u32,
+    /// Free list head: slot index in the low 32 bits, a pop counter above it
+    /// against ABA.
+    free: AtomicU64
+}
+
+/// Storage for one key of an `AeadKeyPool`.
+pub struct Slot {
+    lock: AtomicBool,
+    /// Odd while the slot holds a key, even while it is free; bumped by both
+    /// `insert` and `remove`, so each key gets a generation of its own.
+    generation: AtomicU32,
+    next: AtomicU32,
+    aead: UnsafeCell<Aead>
+}
+
+unsafe impl Sync for Slot {}
+
+/// Key of an `AeadKeyPool`, valid until it is removed.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub struct Handle {
+    pool: u32,
+    index: u32,
+    generation: u32
+}
+
+const NIL: u32 = u32::max_value();
+
+/// Source of `AeadKeyPool::id`.
+static POOLS: AtomicU32 = AtomicU32::new(0);
+
+impl Slot {
+    pub const fn new() -> Slot {
+        Slot {
+            lock: AtomicBool::new(false),
+            generation: AtomicU32::new(0),
+            next: AtomicU32::new(NIL),
+            aead: UnsafeCell::new(Aead::empty())
+        }
+    }
+
+    fn lock(&self) -> SlotGuard<'_> {
+        while self.lock.compare_exchange_weak(false, true, Ordering::Acquire, Ordering::Relaxed).is_err() {
+            core::hint::spin_loop();
+        }
+
+        SlotGuard(self)
+    }
+}
+
+impl Default for Slot {
+    fn default() -> Slot {
+        Slot::new()
+    }
+}
+
+struct SlotGuard<'a>(&'a Slot);
+
+impl<'a> SlotGuard<'a> {
+    #[inline]
+    fn aead(&mut self) -> &mut Aead {
+        unsafe { &mut *self.0.aead.get() }
+    }
+}
+
+impl<'a> Drop for SlotGuard<'a> {
+    fn drop(&mut self) {
+        self.0.lock.store(false, Ordering::Release);
+    }
+}
+
+impl<S: AsRef<[Slot]> + AsMut<[Slot]>> AeadKeyPool<S> {
+    pub fn new(mut slots: S) -> AeadKeyPool<S> {
+        let len = slots.as_mut().len();
+        assert!(len < NIL as usize);
+
+        for (i, slot) in slots.as_mut().iter_mut().enumerate() {
+            slot.aead.get_mut().clear();
+            // slots handed over from a dropped pool may still be marked in use
+            let generation = slot.generation.get_mut();
+            *generation = generation.wrapping_add(*generation & 1);
+            *slot.next.get_mut() = if i + 1 < len { i as u32 + 1 } else { NIL };
+        }
+
+        let head = if len > 0 { 0 } else { NIL };
+        let id = POOLS.fetch_add(1, Ordering::Relaxed);
+        AeadKeyPool { slots, id, free: AtomicU64::new(head as u64) }
+    }
+
+    /// Expands `key` into a free slot. Returns `None` if the pool is full or `alg`
+    /// is not supported by this cpu.
+    pub fn insert(&self, alg: Alg, key: &[u8]) -> Option<Handle> {
+        let index = self.pop()?;
+        let slot = &self.slots.as_ref()[index as usize];
+        let mut guard = slot.lock();
+
+        if guard.aead().rekey(alg, key) {
+            let generation = slot.generation.load(Ordering::Relaxed).wrapping_add(1);
+            slot.generation.store(generation, Ordering::Relaxed);
+            drop(guard);
+            Some(Handle { pool: self.id, index, generation })
+        } else {
+            drop(guard);
+            self.push(index);
+            None
+        }
+    }
+
+    /// Wipes the key of `handle` and frees its slot. Returns `false` if the handle
+    /// was already removed or is not from this pool.
+    pub fn remove(&self, handle: Handle) -> bool {
+        let slot = match self.slot(handle) {
+            Some(slot) => slot,
+            None => return false
+        };
+        let mut guard = slot.lock();
+
+        if !Self::holds(slot, handle) {
+            return false;
+        }
+
+        guard.aead().clear();
+        slot.generation.store(handle.generation.wrapping_add(1), Ordering::Relaxed);
+        drop(guard);
+        self.push(handle.index);
+        true
+    }
+
+    /// Runs `f` on the key of `handle`, or returns `None` if it was removed or is
+    /// not from this pool.
+    ///
+    /// Calls under the same handle are serialized, since AES-GCM works in the
+    /// scratch space of its slot.
+    pub fn with<R, F: FnOnce(&mut Aead) -> R>(&self, handle: Handle, f: F) -> Option<R> {
+        let slot = self.slot(handle)?;
+        let mut guard = slot.lock();
+
+        if !Self::holds(slot, handle) {
+            return None;
+        }
+
+        Some(f(guard.aead()))
+    }
+
+    #[inline]
+    fn slot(&self, handle: Handle) -> Option<&Slot> {
+        if handle.pool != self.id {
+            return None;
+        }
+
+        self.slots.as_ref().get(handle.index as usize)
+    }
+
+    /// Whether the locked `slot` still holds the key of `handle`.
+    #[inline]
+    fn holds(slot: &Slot, handle: Handle) -> bool {
+        handle.generation & 1 == 1 && slot.generation.load(Ordering::Relaxed) == handle.generation
+    }
+
+    fn pop(&self) -> Option<u32> {
+        let slots = self.slots.as_ref();
+        let mut head = self.free.load(Ordering::Acquire);
+
+        loop {
+            let index = head as u32;
+            if index == NIL {
+                return None;
+            }
+
+            let next = slots[index as usize].next.load(Ordering::Relaxed);
+            let new = ((head >> 32).wrapping_add(1) << 32) | next as u64;
+
+            match self.free.compare_exchange_weak(head, new, Ordering::Acquire, Ordering::Acquire) {
+                Ok(_) => return Some(index),
+                Err(current) => head = current
+            }
+        }
+    }
+
+    fn push(&self, index: u32) {
+        let slot = &self.slots.as_ref()[index as usize];
+        let mut head = self.free.load(Ordering::Relaxed);
+
+        loop {
+            slot.next.store(head as u32, Ordering::Relaxed);
+            let new = (head & !(NIL as u64)) | index as u64;
+
+            match self.free.compare_exchange_weak(head, new, Ordering::Release, Ordering::Relaxed) {
+                Ok(_) => return,
+                Err(current) => head = current
+            }
+        }
+    }
+}
+
+impl<S: AsRef<[Slot]> + AsMut<[Slot]>> Drop for AeadKeyPool<S> {
+    fn drop(&mut self) {
+        // borrowed slots outlive the pool, so they are wiped here
+        for slot in self.slots.as_mut() {
+            slot.aead.get_mut().clear();
+        }
+    }
+}
+
+impl Drop for Aead {
+    fn drop(&mut self) {
+        wipe(&mut self.ek.0);
+    }
+}
@@ -0,0 +1,254 @@
+use core::ptr;
+use hacl_star_sys as ffi;
+use crate::hash::Hash;
+
+
+/// Largest `n_blocks` handed to one `update_multi` call.
+const MAX_BLOCKS: usize = 1 << 20;
+
+macro_rules! blake2 {
+    (
+        pub struct $name:ident {
+            state: [ $s:ty; 16 ],
+            block: [ u8; $block:expr ]
+        }
+
+        const HASH_LENGTH = $outlen:expr;
+
+        impl $hash:path;
+        impl $init:path;
+        impl $update_multi:path;
+        impl $update_last:path;
+        impl $finish:path;
+        impl $len:path;
+    ) => {
+        /// Unkeyed, full-length hash. The last block is held back until `finish`
+        /// (or `flush`), since BLAKE2 compresses it with the final flag set.
+        #[derive(Clone)]
+        pub struct $name {
+            state: [$s; 16],
+            block: [u8; $block],
+            pos: usize,
+            len: u128,
+            flushed: Option<[$s; 16]>
+        }
+
+        impl $name {
+            pub const BLOCK_LENGTH: usize = $block;
+            pub const HASH_LENGTH: usize = $outlen;
+
+            pub fn hash(output: &mut [u8; $outlen], input: &[u8]) {
+                // the one-shot function takes a `u32` length
+                if input.len() > u32::max_value() as usize {
+                    let mut state = $name::default();
+                    state.update(input);
+                    state.finish(output);
+                    return;
+                }
+
+                unsafe {
+                    $hash(
+                        $outlen,
+                        output.as_mut_ptr(),
+                        input.len() as _,
+                        input.as_ptr() as _,
+                        0,
+                        ptr::null_mut()
+                    )
+                };
+            }
+        }
+
+        impl Default for $name {
+            fn default() -> Self {
+                let mut state = [0; 16];
+                let mut wv = [0; 16];
+                unsafe { $init(wv.as_mut_ptr(), state.as_mut_ptr(), 0, ptr::null_mut(), $outlen) };
+                $name { state, block: [0; $block], pos: 0, len: 0, flushed: None }
+            }
+        }
+
+        impl $name {
+            pub fn update(&mut self, buf: &[u8]) {
+                if buf.is_empty() {
+                    return;
+                }
+
+                self.flushed = None;
+
+                let len = buf.len();
+                let br = $block - self.pos;
+
+                if len > br {
+                    self.block[self.pos..][..br].copy_from_slice(&buf[..br]);
+                    let block = self.block;
+                    self.compress(&block);
+                    self.pos = 0;
+                } else {
+                    self.block[self.pos..][..len].copy_from_slice(buf);
+                    self.pos += len;
+                    return;
+                }
+
+                // keep at least one byte back for the final block
+                let buf = &buf[br..];
+                let len = buf.len();
+                let n = (len - 1) / $block;
+                let r = len - n * $block;
+
+                for chunk in buf[..n * $block].chunks(MAX_BLOCKS * $block) {
+                    self.compress(chunk);
+                }
+
+                self.block[..r].copy_from_slice(&buf[n * $block..]);
+                self.pos = r;
+            }
+
+            pub fn finish(mut self, buf: &mut [u8; $outlen]) {
+                if let Some(state) = self.flushed {
+                    // nothing followed `flush`, so the flushed block is the last one after all
+                    self.state = state;
+                    self.len -= $block;
+                    self.pos = $block;
+                }
+
+                let mut wv = [0; 16];
+
+                unsafe {
+                    $update_last(
+                        self.pos as _,
+                        wv.as_mut_ptr(),
+                        self.state.as_mut_ptr(),
+                        $len(self.len),
+                        self.pos as _,
+                        self.block.as_mut_ptr()
+                    );
+                    $finish($outlen, buf.as_mut_ptr(), self.state.as_mut_ptr());
+                }
+            }
+
+            fn compress(&mut self, blocks: &[u8]) {
+                let mut wv = [0; 16];
+
+                unsafe {
+                    $update_multi(
+                        blocks.len() as _,
+                        wv.as_mut_ptr(),
+                        self.state.as_mut_ptr(),
+                        $len(self.len),
+                        blocks.as_ptr() as _,
+                        (blocks.len() / $block) as _
+                    );
+                }
+                self.len += blocks.len() as u128;
+            }
+        }
+
+        impl Hash for $name {
+            const BLOCK_LENGTH: usize = $block;
+            const HASH_LENGTH: usize = $outlen;
+
+            #[inline]
+            fn update(&mut self, buf: &[u8]) {
+                $name::update(self, buf)
+            }
+
+            fn finish_into(self, output: &mut [u8]) {
+                let mut buf = [0; $outlen];
+                self.finish(&mut buf);
+                output[..$outlen].copy_from_slice(&buf);
+            }
+
+            fn flush(&mut self) {
+                if self.pos == $block {
+                    let state = self.state;
+                    let block = self.block;
+                    self.compress(&block);
+                    self.pos = 0;
+                    self.flushed = Some(state);
+                }
+            }
+        }
+    }
+}
+
+#[inline]
+fn len64(len: u128) -> u64 {
+    len as u64
+}
+
+#[cfg(not(all(target_arch = "wasm32", target_feature = "simd128")))]
+blake2!{
+    pub struct Blake2s {
+        state: [u32; 16],
+        block: [u8; 64]
+    }
+
+    const HASH_LENGTH = 32;
+
+    impl ffi::blake2::Hacl_Blake2s_32_blake2s;
+    impl ffi::blake2::Hacl_Blake2s_32_blake2s_init;
+    impl ffi::blake2::Hacl_Blake2s_32_blake2s_update_multi;
+    impl ffi::blake2::Hacl_Blake2s_32_blake2s_update_last;
+    impl ffi::blake2::Hacl_Blake2s_32_blake2s_finish;
+    impl len64;
+}
+
+#[cfg(all(target_arch = "wasm32", target_feature = "simd128"))]
+blake2!{
+    pub struct Blake2s {
+        state: [u32; 16],
+        block: [u8; 64]
+    }
+
+    const HASH_LENGTH = 32;
+
+    impl ffi::blake2::Hacl_Blake2s_128_blake2s;
+    impl blake2s_128::init;
+    impl blake2s_128::update_multi;
+    impl blake2s_128::update_last;
+    impl blake2s_128::finish;
+    impl len64;
+}
+
+/// `Hacl_Blake2s_128` on the `[u32; 16]` state of `Blake2s`: its four row vectors
+/// take the same 64 bytes. wasm loads do not fault when unaligned, so the state
+/// needs no 16-byte alignment there.
+#[cfg(all(target_arch = "wasm32", target_feature = "simd128"))]
+mod blake2s_128 {
+    use hacl_star_sys::blake2::*;
+
+    type Vec128 = *mut Lib_IntVector_Intrinsics_vec128;
+
+    pub unsafe fn init(wv: *mut u32, hash: *mut u32, kk: u32, k: *mut u8, nn: u32) {
+        Hacl_Blake2s_128_blake2s_init(wv as Vec128, hash as Vec128, kk, k, nn)
+    }
+
+    pub unsafe fn update_multi(len: u32, wv: *mut u32, hash: *mut u32, prev: u64, blocks: *mut u8, nb: u32) {
+        Hacl_Blake2s_128_blake2s_update_multi(len, wv as Vec128, hash as Vec128, prev, blocks, nb)
+    }
+
+    pub unsafe fn update_last(len: u32, wv: *mut u32, hash: *mut u32, prev: u64, rem: u32, d: *mut u8) {
+        Hacl_Blake2s_128_blake2s_update_last(len, wv as Vec128, hash as Vec128, prev, rem, d)
+    }
+
+    pub unsafe fn finish(nn: u32, output: *mut u8, hash: *mut u32) {
+        Hacl_Blake2s_128_blake2s_finish(nn, output, hash as Vec128)
+    }
+}
+
+blake2!{
+    pub struct Blake2b {
+        state: [u64; 16],
+        block: [u8; 128]
+    }
+
+    const HASH_LENGTH = 64;
+
+    impl ffi::blake2::Hacl_Blake2b_32_blake2b;
+    impl ffi::blake2::Hacl_Blake2b_32_blake2b_init;
+    impl ffi::blake2::Hacl_Blake2b_32_blake2b_update_multi;
+    impl ffi::blake2::Hacl_Blake2b_32_blake2b_update_last;
+    impl ffi::blake2::Hacl_Blake2b_32_blake2b_finish;
+    impl ffi::uint128;
+}
@@ -1,10 +1,8 @@
+use core::ptr;
+use core::sync::atomic::{ AtomicUsize, Ordering };
 use hacl_star_sys as ffi;
 use rand_core::{CryptoRng, RngCore};
 
-const BASEPOINT: [u8; 32] = [
-    9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-];
-
 pub const PUBLIC_LENGTH: usize = 32;
 pub const SECRET_LENGTH: usize = 32;
 
@@ -19,7 +17,7 @@ pub fn keypair<R: RngCore + CryptoRng>(mut rng: R) -> (SecretKey, PublicKey) {
     let mut pk = [0; SECRET_LENGTH];
 
     rng.fill_bytes(&mut sk);
-    scalarmult(&mut pk, &sk, &BASEPOINT);
+    scalarmult_base(&mut pk, &sk);
 
     (SecretKey(sk), PublicKey(pk))
 }
@@ -30,7 +28,7 @@ impl SecretKey {
         let SecretKey(sk) = self;
         let mut pk = [0; 32];
 
-        scalarmult(&mut pk, sk, &BASEPOINT);
+        scalarmult_base(&mut pk, sk);
 
         PublicKey(pk)
     }
@@ -51,3 +49,297 @@ pub fn scalarmult(mypublic: &mut [u8; 32], secret: &[u8; 32], basepoint: &[u8; 3
         );
     }
 }
+
+/// `scalarmult(mypublic, secret, &[9, 0, ..])` through the Edwards form of the curve.
+///
+/// The clamped scalar is split into 64 signed radix-16 digits, and each digit picks
+/// a precomputed affine multiple of the Ed25519 base point, so the product costs 64
+/// mixed additions and no doublings. The Edwards result maps back to Montgomery as
+/// `u = (Z + Y) / (Z - Y)`; the Ed25519 base point maps to `u = 9`.
+pub fn scalarmult_base(mypublic: &mut [u8; 32], secret: &[u8; 32]) {
+    let mut scalar = *secret;
+    scalar[0] &= 248;
+    scalar[31] &= 127;
+    scalar[31] |= 64;
+
+    // digits in [-8, 8), the top one in [0, 8] since the scalar is below 2^255
+    let mut digits = [0i8; 64];
+    for i in 0..32 {
+        digits[2 * i] = (scalar[i] & 15) as i8;
+        digits[2 * i + 1] = (scalar[i] >> 4) as i8;
+    }
+    for i in 0..63 {
+        let carry = (digits[i] + 8) >> 4;
+        digits[i] -= carry << 4;
+        digits[i + 1] += carry;
+    }
+
+    let table = base_table();
+
+    // extended (X, Y, Z, T) at the identity
+    let mut acc = [0; 20];
+    acc[5] = 1;
+    acc[10] = 1;
+
+    for (row, &digit) in table.iter().zip(digits.iter()) {
+        // constant time: scan the whole row, then conditionally negate
+        let sign = (digit >> 7) as u8 & 1;
+        let abs = (digit ^ -(sign as i8)) + sign as i8;
+
+        let mut point = NIELS_IDENTITY;
+        for (j, entry) in row.iter().enumerate() {
+            select(&mut point, entry, eq_mask(abs as u8, j as u8 + 1));
+        }
+
+        let mut negated = [0; 15];
+        negated[..5].copy_from_slice(&point[5..10]);
+        negated[5..10].copy_from_slice(&point[..5]);
+        negated[10..].copy_from_slice(&fe::sub(&[0; 5], &fe::part(&point, 2)));
+        select(&mut point, &negated, (sign as u64).wrapping_neg());
+
+        madd(&mut acc, &point);
+    }
+
+    let (y, z) = (fe::part(&acc, 1), fe::part(&acc, 2));
+    let mut u = fe::mul(&fe::add(&z, &y), &fe::inv(&fe::sub(&z, &y)));
+    unsafe {
+        ffi::curve25519::Hacl_Curve25519_51_store(mypublic.as_mut_ptr(), u.as_mut_ptr());
+    }
+}
+
+/// `(y + x, y - x, 2dxy)` of the identity.
+const NIELS_IDENTITY: [u64; 15] = [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0];
+
+/// `p += q` for extended `p` and affine `q` in `(y + x, y - x, 2dxy)` form, 7 multiplications.
+fn madd(p: &mut [u64; 20], q: &[u64; 15]) {
+    let (x1, y1, z1, t1) = (fe::part(p, 0), fe::part(p, 1), fe::part(p, 2), fe::part(p, 3));
+
+    let a = fe::mul(&fe::add(&y1, &x1), &fe::part(q, 0));
+    let b = fe::mul(&fe::sub(&y1, &x1), &fe::part(q, 1));
+    let c = fe::mul(&fe::part(q, 2), &t1);
+    let d = fe::reduce(&fe::add(&z1, &z1));
+
+    let (e, f, g, h) = (fe::sub(&a, &b), fe::sub(&d, &c), fe::add(&d, &c), fe::add(&a, &b));
+
+    p[..5].copy_from_slice(&fe::mul(&e, &f));
+    p[5..10].copy_from_slice(&fe::mul(&g, &h));
+    p[10..15].copy_from_slice(&fe::mul(&f, &g));
+    p[15..].copy_from_slice(&fe::mul(&e, &h));
+}
+
+/// `TABLE[i][j] = (j + 1) * 16^i * B` in `(y + x, y - x, 2dxy)` form, 60 KiB.
+static mut TABLE: [[[u64; 15]; 8]; 64] = [[[0; 15]; 8]; 64];
+
+/// 0 before `TABLE` is filled, 1 while one thread fills it, 2 once it is ready.
+static TABLE_STATE: AtomicUsize = AtomicUsize::new(0);
+
+fn base_table() -> &'static [[[u64; 15]; 8]; 64] {
+    use ffi::ec_ed25519::*;
+
+    loop {
+        match TABLE_STATE.compare_exchange(0, 1, Ordering::Acquire, Ordering::Acquire) {
+            Ok(_) => break,
+            Err(2) => return unsafe { &*ptr::addr_of!(TABLE) },
+            Err(_) => core::hint::spin_loop()
+        }
+    }
+
+    // 2d = -2 * 121665 / 121666
+    let d = fe::sub(&[0; 5], &fe::mul(&[121665, 0, 0, 0, 0], &fe::inv(&[121666, 0, 0, 0, 0])));
+    let d2 = fe::reduce(&fe::add(&d, &d));
+
+    let table = unsafe { &mut *ptr::addr_of_mut!(TABLE) };
+    let mut base = [0; 20];
+
+    unsafe {
+        Hacl_EC_Ed25519_mk_base_point(base.as_mut_ptr());
+
+        for row in table.iter_mut() {
+            let mut point = base;
+
+            for entry in row.iter_mut() {
+                let zinv = fe::inv(&fe::part(&point, 2));
+                let x = fe::mul(&fe::part(&point, 0), &zinv);
+                let y = fe::mul(&fe::part(&point, 1), &zinv);
+
+                entry[..5].copy_from_slice(&fe::reduce(&fe::add(&y, &x)));
+                entry[5..10].copy_from_slice(&fe::reduce(&fe::sub(&y, &x)));
+                entry[10..].copy_from_slice(&fe::mul(&fe::mul(&x, &y), &d2));
+
+                let mut prev = point;
+                Hacl_EC_Ed25519_point_add(prev.as_mut_ptr(), base.as_mut_ptr(), point.as_mut_ptr());
+            }
+
+            // next row: 16 * base, by four doublings (the addition law is complete)
+            for _ in 0..4 {
+                let mut prev = base;
+                Hacl_EC_Ed25519_point_add(prev.as_mut_ptr(), prev.as_mut_ptr(), base.as_mut_ptr());
+            }
+        }
+    }
+
+    TABLE_STATE.store(2, Ordering::Release);
+    table
+}
+
+#[inline]
+fn eq_mask(a: u8, b: u8) -> u64 {
+    let x = (a ^ b) as u64;
+    (x.wrapping_sub(1) >> 63).wrapping_neg()
+}
+
+#[inline]
+fn select(dst: &mut [u64; 15], src: &[u64; 15], mask: u64) {
+    for (d, s) in dst.iter_mut().zip(src.iter()) {
+        *d ^= (*d ^ *s) & mask;
+    }
+}
+
+/// Field arithmetic on `Hacl_Impl_Curve25519_Field51` limbs.
+mod fe {
+    use hacl_star_sys as ffi;
+    use ffi::curve25519::*;
+
+    pub type Fe = [u64; 5];
+
+    #[inline]
+    pub fn part(p: &[u64], i: usize) -> Fe {
+        let mut f = [0; 5];
+        f.copy_from_slice(&p[i * 5..][..5]);
+        f
+    }
+
+    #[inline]
+    pub fn add(a: &Fe, b: &Fe) -> Fe {
+        let (mut a, mut b, mut out) = (*a, *b, [0; 5]);
+        unsafe { Hacl_Impl_Curve25519_Field51_fadd(out.as_mut_ptr(), a.as_mut_ptr(), b.as_mut_ptr()) };
+        out
+    }
+
+    #[inline]
+    pub fn sub(a: &Fe, b: &Fe) -> Fe {
+        let (mut a, mut b, mut out) = (*a, *b, [0; 5]);
+        unsafe { Hacl_Impl_Curve25519_Field51_fsub(out.as_mut_ptr(), a.as_mut_ptr(), b.as_mut_ptr()) };
+        out
+    }
+
+    #[inline]
+    pub fn mul(a: &Fe, b: &Fe) -> Fe {
+        let (mut a, mut b, mut out) = (*a, *b, [0; 5]);
+        let mut tmp = [ffi::uint128(0); 10];
+        unsafe {
+            Hacl_Impl_Curve25519_Field51_fmul(out.as_mut_ptr(), a.as_mut_ptr(), b.as_mut_ptr(), tmp.as_mut_ptr())
+        };
+        out
+    }
+
+    /// Carries a sum or difference back into multiplication input range.
+    #[inline]
+    pub fn reduce(a: &Fe) -> Fe {
+        let (mut a, mut out) = (*a, [0; 5]);
+        unsafe { Hacl_Impl_Curve25519_Field51_fmul1(out.as_mut_ptr(), a.as_mut_ptr(), 1) };
+        out
+    }
+
+    pub fn inv(a: &Fe) -> Fe {
+        let (mut a, mut out) = (*a, [0; 5]);
+        let mut tmp = [ffi::uint128(0); 10];
+        unsafe { Hacl_Curve25519_51_finv(out.as_mut_ptr(), a.as_mut_ptr(), tmp.as_mut_ptr()) };
+        out
+    }
+}
+
+/// Results normalized by one shared inversion in `scalarmult_batch`.
+const BATCH_LENGTH: usize = 32;
+
+/// `scalarmult` over many `(secret, basepoint)` pairs.
+///
+/// Each ladder ends projective, and every `BATCH_LENGTH` of them share one `finv`
+/// (Montgomery's trick: invert the product of the `Z`s, then peel off each inverse
+/// with two multiplications), instead of paying an inversion per result.
+pub fn scalarmult_batch(outputs: &mut [[u8; 32]], secrets: &[[u8; 32]], basepoints: &[[u8; 32]]) {
+    assert_eq!(outputs.len(), secrets.len());
+    assert_eq!(outputs.len(), basepoints.len());
+
+    let chunks = outputs.chunks_mut(BATCH_LENGTH)
+        .zip(secrets.chunks(BATCH_LENGTH))
+        .zip(basepoints.chunks(BATCH_LENGTH));
+
+    for ((outputs, secrets), basepoints) in chunks {
+        scalarmult_chunk(outputs, secrets, basepoints);
+    }
+}
+
+fn scalarmult_chunk(outputs: &mut [[u8; 32]], secrets: &[[u8; 32]], basepoints: &[[u8; 32]]) {
+    use ffi::curve25519::{
+        Hacl_Curve25519_51_ladder as ladder,
+        Hacl_Curve25519_51_finv as finv,
+        Hacl_Curve25519_51_store as store,
+        Hacl_Impl_Curve25519_Field51_fmul as fmul
+    };
+
+    const ONE: [u64; 5] = [1, 0, 0, 0, 0];
+
+    let n = outputs.len();
+    let mut points = [[0; 10]; BATCH_LENGTH];
+    let mut products = [[0; 5]; BATCH_LENGTH];
+    let mut infinity = [0u64; BATCH_LENGTH];
+    let mut tmp = [ffi::uint128(0); 10];
+
+    unsafe {
+        for i in 0..n {
+            ladder(points[i].as_mut_ptr(), secrets[i].as_ptr() as _, basepoints[i].as_ptr() as _);
+
+            // a zero Z (low order input) would zero the whole product, so it is
+            // swapped for one here and its output cleared below, as `finv(0) = 0` does.
+            let mut z = [0; 32];
+            store(z.as_mut_ptr(), points[i][5..].as_mut_ptr());
+            let mask = is_zero(&z);
+            for (limb, one) in points[i][5..].iter_mut().zip(&ONE) {
+                *limb = (*limb & !mask) | (one & mask);
+            }
+            infinity[i] = mask;
+
+            let mut z = [0; 5];
+            z.copy_from_slice(&points[i][5..]);
+            if i == 0 {
+                products[0] = z;
+            } else {
+                let mut prev = products[i - 1];
+                fmul(products[i].as_mut_ptr(), prev.as_mut_ptr(), z.as_mut_ptr(), tmp.as_mut_ptr());
+            }
+        }
+
+        // inv = (Z_0 * .. * Z_{n-1})^-1
+        let mut inv = [0; 5];
+        finv(inv.as_mut_ptr(), products[n - 1].as_mut_ptr(), tmp.as_mut_ptr());
+
+        for i in (0..n).rev() {
+            let point = &mut points[i];
+            let mut zinv = [0; 5];
+
+            if i == 0 {
+                zinv = inv;
+            } else {
+                fmul(zinv.as_mut_ptr(), inv.as_mut_ptr(), products[i - 1].as_mut_ptr(), tmp.as_mut_ptr());
+                let mut next = inv;
+                fmul(inv.as_mut_ptr(), next.as_mut_ptr(), point[5..].as_mut_ptr(), tmp.as_mut_ptr());
+            }
+
+            let mut x = [0; 5];
+            fmul(x.as_mut_ptr(), point.as_mut_ptr(), zinv.as_mut_ptr(), tmp.as_mut_ptr());
+            store(outputs[i].as_mut_ptr(), x.as_mut_ptr());
+
+            for b in outputs[i].iter_mut() {
+                *b &= !infinity[i] as u8;
+            }
+        }
+    }
+}
+
+/// All-ones if the 32 bytes are zero, without branching on them.
+#[inline]
+fn is_zero(buf: &[u8; 32]) -> u64 {
+    let acc = buf.iter().fold(0, |acc, &b| acc | b);
+    ((acc as u64).wrapping_sub(1) >> 63).wrapping_neg()
+}
@@ -0,0 +1,319 @@
+use core::{ cmp, ptr };
+use core::num::NonZeroU32;
+#[cfg(unix)]
+use core::sync::atomic::{ AtomicUsize, Ordering };
+use rand_core::{ RngCore, CryptoRng, Error, impls };
+use hacl_star_sys as ffi;
+use ffi::drbg::*;
+use crate::wipe::wipe;
+
+
+const ALG: Spec_Hash_Definitions_hash_alg = Spec_Hash_Definitions_SHA2_256 as _;
+
+/// Output generated per refill, served to small requests from memory.
+const BUFFER_LENGTH: usize = 4096;
+
+/// `Hacl_HMAC_DRBG_max_output_length`, the largest single `generate`.
+const MAX_OUTPUT_LENGTH: usize = 65536;
+
+/// `Hacl_HMAC_DRBG_min_length` for SHA2-256.
+const ENTROPY_LENGTH: usize = 32;
+
+/// `Hacl_HMAC_DRBG_max_length`, the longest entropy input or nonce.
+const MAX_LENGTH: usize = 65536;
+
+/// `Hacl_HMAC_DRBG_max_personalization_string_length`.
+const MAX_PERSONALIZATION_LENGTH: usize = 65536;
+
+/// Error code reported when the system entropy source fails.
+pub const ENTROPY_ERROR: u32 = Error::CUSTOM_START;
+
+/// HMAC-DRBG (SHA2-256) seeded from `Lib_RandomBuffer_System`.
+///
+/// Output is produced in `BUFFER_LENGTH` batches, so a small request costs a copy,
+/// not a DRBG call. The generator reseeds from the system source whenever
+/// `Hacl_HMAC_DRBG_generate` reaches its reseed interval (1024 calls), and, on
+/// unix, on the first request in a child after `fork`, dropping the buffered
+/// output, so that parent and child never return the same bytes.
+pub struct Drbg {
+    state: State,
+    buf: [u8; BUFFER_LENGTH],
+    pos: usize,
+    /// `forks()` when the state was last seeded.
+    forks: usize
+}
+
+struct State {
+    k: [u8; 32],
+    v: [u8; 32],
+    reseed_counter: u32
+}
+
+impl Drbg {
+    pub fn new() -> Result<Drbg, Error> {
+        let mut seed = [0; ENTROPY_LENGTH + ENTROPY_LENGTH / 2];
+        system_entropy(&mut seed)?;
+
+        let (entropy, nonce) = seed.split_at(ENTROPY_LENGTH);
+        let drbg = Drbg::from_entropy(entropy, nonce, &[]);
+        wipe(&mut seed);
+
+        Ok(drbg)
+    }
+
+    /// Instantiates from caller entropy. Reseeds still draw from the system source.
+    ///
+    /// As `Hacl_HMAC_DRBG_instantiate` requires, `entropy` takes 32 to 65536 bytes,
+    /// `nonce` 16 to 65536 and `personalization` at most 65536.
+    pub fn from_entropy(entropy: &[u8], nonce: &[u8], personalization: &[u8]) -> Drbg {
+        assert!(entropy.len() >= ENTROPY_LENGTH && entropy.len() <= MAX_LENGTH);
+        assert!(nonce.len() >= ENTROPY_LENGTH / 2 && nonce.len() <= MAX_LENGTH);
+        assert!(personalization.len() <= MAX_PERSONALIZATION_LENGTH);
+
+        let mut state = State { k: [0; 32], v: [0; 32], reseed_counter: 0 };
+
+        unsafe {
+            Hacl_HMAC_DRBG_instantiate(
+                ALG,
+                state.as_ffi(),
+                entropy.len() as _,
+                entropy.as_ptr() as _,
+                nonce.len() as _,
+                nonce.as_ptr() as _,
+                personalization.len() as _,
+                personalization.as_ptr() as _
+            );
+        }
+
+        Drbg { state, buf: [0; BUFFER_LENGTH], pos: BUFFER_LENGTH, forks: forks() }
+    }
+
+    #[inline]
+    pub fn reseed(&mut self) -> Result<(), Error> {
+        self.state.reseed()
+    }
+
+    /// In a process forked since the last seeding, discards the buffer and the
+    /// state's future output, which the parent shares.
+    #[inline]
+    fn check_fork(&mut self) -> Result<(), Error> {
+        let forks = forks();
+        if forks != self.forks {
+            wipe(&mut self.buf);
+            self.pos = BUFFER_LENGTH;
+            self.state.reseed()?;
+            self.forks = forks;
+        }
+        Ok(())
+    }
+}
+
+/// Forks this process descends from, counted by a `pthread_atfork` child handler
+/// that the first `forks()` call registers; reading it is one atomic load, where
+/// `getpid` would be a syscall per request.
+#[cfg(unix)]
+static FORKS: AtomicUsize = AtomicUsize::new(0);
+
+#[cfg(unix)]
+fn forks() -> usize {
+    /// 0 before the handler is registered, 1 while it is, 2 after.
+    static STATE: AtomicUsize = AtomicUsize::new(0);
+
+    extern "C" fn child() {
+        FORKS.fetch_add(1, Ordering::Relaxed);
+    }
+
+    while STATE.load(Ordering::Acquire) != 2 {
+        if STATE.compare_exchange(0, 1, Ordering::Acquire, Ordering::Acquire).is_ok() {
+            unsafe { libc::pthread_atfork(None, None, Some(child)) };
+            STATE.store(2, Ordering::Release);
+        } else {
+            core::hint::spin_loop();
+        }
+    }
+
+    FORKS.load(Ordering::Relaxed)
+}
+
+#[cfg(not(unix))]
+fn forks() -> usize {
+    0
+}
+
+impl State {
+    fn reseed(&mut self) -> Result<(), Error> {
+        let mut entropy = [0; ENTROPY_LENGTH];
+        system_entropy(&mut entropy)?;
+
+        unsafe {
+            Hacl_HMAC_DRBG_reseed(
+                ALG,
+                self.as_ffi(),
+                entropy.len() as _,
+                entropy.as_mut_ptr(),
+                0,
+                ptr::null_mut()
+            );
+        }
+
+        wipe(&mut entropy);
+        Ok(())
+    }
+
+    /// Fills `output` straight from the DRBG, reseeding when it asks for it.
+    fn generate(&mut self, output: &mut [u8]) -> Result<(), Error> {
+        for chunk in output.chunks_mut(MAX_OUTPUT_LENGTH) {
+            loop {
+                let ok = unsafe {
+                    Hacl_HMAC_DRBG_generate(
+                        ALG,
+                        chunk.as_mut_ptr(),
+                        self.as_ffi(),
+                        chunk.len() as _,
+                        0,
+                        ptr::null_mut()
+                    )
+                };
+
+                if ok {
+                    break
+                }
+
+                self.reseed()?;
+            }
+        }
+
+        Ok(())
+    }
+
+    #[inline]
+    fn as_ffi(&mut self) -> Hacl_HMAC_DRBG_state {
+        Hacl_HMAC_DRBG_state {
+            k: self.k.as_mut_ptr(),
+            v: self.v.as_mut_ptr(),
+            reseed_counter: &mut self.reseed_counter
+        }
+    }
+}
+
+impl RngCore for Drbg {
+    fn next_u32(&mut self) -> u32 {
+        impls::next_u32_via_fill(self)
+    }
+
+    fn next_u64(&mut self) -> u64 {
+        impls::next_u64_via_fill(self)
+    }
+
+    fn fill_bytes(&mut self, dest: &mut [u8]) {
+        self.try_fill_bytes(dest).expect("system entropy source failed")
+    }
+
+    fn try_fill_bytes(&mut self, dest: &mut [u8]) -> Result<(), Error> {
+        let mut dest = dest;
+        self.check_fork()?;
+
+        while !dest.is_empty() {
+            if self.pos == BUFFER_LENGTH {
+                // large requests skip the buffer
+                if dest.len() >= BUFFER_LENGTH {
+                    return self.state.generate(dest);
+                }
+
+                self.state.generate(&mut self.buf)?;
+                self.pos = 0;
+            }
+
+            let take = cmp::min(BUFFER_LENGTH - self.pos, dest.len());
+            let (head, tail) = dest.split_at_mut(take);
+            let served = &mut self.buf[self.pos..][..take];
+            head.copy_from_slice(served);
+            // served output must not be recoverable from the state
+            wipe(served);
+            self.pos += take;
+            dest = tail;
+        }
+
+        Ok(())
+    }
+}
+
+impl CryptoRng for Drbg {}
+
+impl Drop for Drbg {
+    fn drop(&mut self) {
+        wipe(&mut self.state.k);
+        wipe(&mut self.state.v);
+        wipe(&mut self.buf);
+    }
+}
+
+fn system_entropy(buf: &mut [u8]) -> Result<(), Error> {
+    if unsafe { Lib_RandomBuffer_System_randombytes(buf.as_mut_ptr(), buf.len() as _) } {
+        Ok(())
+    } else {
+        Err(NonZeroU32::new(ENTROPY_ERROR).unwrap().into())
+    }
+}
+
+#[cfg(feature = "std")]
+pub use self::thread::HaclRng;
+
+#[cfg(feature = "std")]
+mod thread {
+    use std::cell::RefCell;
+    use std::marker::PhantomData;
+    use std::thread_local;
+    use rand_core::{ RngCore, CryptoRng, Error };
+    use super::Drbg;
+
+    thread_local! {
+        static DRBG: RefCell<Option<Drbg>> = RefCell::new(None);
+    }
+
+    /// Handle to this thread's `Drbg`, instantiated on first use.
+    ///
+    /// Every thread owns its generator, so requests take neither a lock nor a syscall
+    /// until the next refill or reseed. The handle is `!Send` to keep it on its thread.
+    #[derive(Clone, Default)]
+    pub struct HaclRng(PhantomData<*const ()>);
+
+    impl HaclRng {
+        #[inline]
+        pub fn new() -> HaclRng {
+            HaclRng(PhantomData)
+        }
+    }
+
+    impl RngCore for HaclRng {
+        fn next_u32(&mut self) -> u32 {
+            let mut buf = [0; 4];
+            self.fill_bytes(&mut buf);
+            u32::from_le_bytes(buf)
+        }
+
+        fn next_u64(&mut self) -> u64 {
+            let mut buf = [0; 8];
+            self.fill_bytes(&mut buf);
+            u64::from_le_bytes(buf)
+        }
+
+        fn fill_bytes(&mut self, dest: &mut [u8]) {
+            self.try_fill_bytes(dest).expect("system entropy source failed")
+        }
+
+        fn try_fill_bytes(&mut self, dest: &mut [u8]) -> Result<(), Error> {
+            DRBG.with(|drbg| {
+                let mut drbg = drbg.borrow_mut();
+
+                if drbg.is_none() {
+                    *drbg = Some(Drbg::new()?);
+                }
+
+                drbg.as_mut().unwrap().try_fill_bytes(dest)
+            })
+        }
+    }
+
+    impl CryptoRng for HaclRng {}
+}
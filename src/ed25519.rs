@@ -1,9 +1,12 @@
 use hacl_star_sys as ffi;
 use rand_core::{CryptoRng, RngCore};
+use crate::sha2::{ Sha512, Sha512x4 };
+use crate::wipe::wipe;
 
 pub const SECRET_LENGTH: usize = 32;
 pub const PUBLIC_LENGTH: usize = 32;
 pub const SIG_LENGTH: usize = 64;
+pub const CONTEXT_MAX_LENGTH: usize = 255;
 
 define! {
     pub struct SecretKey/secretkey(pub [u8; SECRET_LENGTH]);
@@ -39,6 +42,11 @@ impl SecretKey {
     }
 
     pub fn signature(&self, msg: &[u8]) -> Signature {
+        // `Hacl_Ed25519_sign` takes a `u32` length
+        if msg.len() > u32::max_value() as usize {
+            return self.sign_dom(Sha512::default(), msg);
+        }
+
         let SecretKey(sk) = self;
         let mut sig = [0; SIG_LENGTH];
 
@@ -56,8 +64,13 @@ impl SecretKey {
 }
 
 impl PublicKey {
-    pub fn verify(self, msg: &[u8], &Signature(ref sig): &Signature) -> bool {
+    pub fn verify(self, msg: &[u8], sig: &Signature) -> bool {
+        if msg.len() > u32::max_value() as usize {
+            return self.verify_dom(Sha512::default(), msg, sig);
+        }
+
         let PublicKey(pk) = self;
+        let Signature(sig) = sig;
 
         unsafe {
             ffi::ed25519::Hacl_Ed25519_verify(
@@ -70,6 +83,275 @@ impl PublicKey {
     }
 }
 
+/// Incremental SHA-512 of the message for Ed25519ph, so large inputs are streamed
+/// once in constant memory.
+#[derive(Clone, Default)]
+pub struct Prehash(Sha512);
+
+impl Prehash {
+    #[inline]
+    pub fn new() -> Prehash {
+        Prehash::default()
+    }
+
+    #[inline]
+    pub fn update(&mut self, buf: &[u8]) {
+        self.0.update(buf);
+    }
+
+    fn finish(self) -> [u8; 64] {
+        let mut ph = [0; 64];
+        self.0.finish(&mut ph);
+        ph
+    }
+}
+
+impl SecretKey {
+    /// Ed25519ph (RFC 8032): signs the SHA-512 of the message fed to `prehash`.
+    pub fn signature_ph(&self, prehash: Prehash, context: &[u8]) -> Signature {
+        self.sign_dom(dom2(1, context), &prehash.finish())
+    }
+
+    /// Ed25519ctx (RFC 8032). Signing needs two passes over `msg`, so it is not
+    /// streamed; unlike `signature` it is not limited to `u32` lengths.
+    pub fn signature_ctx(&self, msg: &[u8], context: &[u8]) -> Signature {
+        self.sign_dom(dom2(0, context), msg)
+    }
+
+    /// Signs with every hash started from `dom`: empty for Ed25519, `dom2` for the
+    /// ph and ctx variants.
+    fn sign_dom(&self, dom: Sha512, msg: &[u8]) -> Signature {
+        let SecretKey(sk) = self;
+
+        // public key || secret scalar || nonce prefix
+        let mut ks = [0; 96];
+        let mut r = [0; 32];
+        let mut k = [0; 32];
+        let mut sig = [0; SIG_LENGTH];
+
+        unsafe {
+            ffi::ed25519::Hacl_Ed25519_expand_keys(ks.as_mut_ptr(), sk.as_ptr() as _);
+        }
+
+        let mut h = dom.clone();
+        h.update(&ks[64..]);
+        h.update(msg);
+        reduce(h, &mut r);
+
+        unsafe {
+            ffi::ed25519::Hacl_Ed25519_Ctx_point_mul_g_compress(sig.as_mut_ptr(), r.as_mut_ptr());
+        }
+
+        let mut h = dom;
+        h.update(&sig[..32]);
+        h.update(&ks[..32]);
+        h.update(msg);
+        reduce(h, &mut k);
+
+        unsafe {
+            ffi::ed25519::Hacl_Ed25519_Ctx_sign_finish(
+                sig[32..].as_mut_ptr(),
+                r.as_mut_ptr(),
+                k.as_mut_ptr(),
+                ks[32..].as_mut_ptr()
+            );
+        }
+
+        wipe(&mut ks);
+        wipe(&mut r);
+        Signature(sig)
+    }
+}
+
+impl PublicKey {
+    /// Ed25519ph (RFC 8032) over the message fed to `prehash`.
+    pub fn verify_ph(self, prehash: Prehash, context: &[u8], sig: &Signature) -> bool {
+        self.verify_dom(dom2(1, context), &prehash.finish(), sig)
+    }
+
+    /// Ed25519ctx (RFC 8032).
+    pub fn verify_ctx(self, msg: &[u8], context: &[u8], sig: &Signature) -> bool {
+        self.verify_dom(dom2(0, context), msg, sig)
+    }
+
+    fn verify_dom(self, dom: Sha512, msg: &[u8], &Signature(ref sig): &Signature) -> bool {
+        let PublicKey(pk) = self;
+        let mut k = [0; 32];
+
+        let mut h = dom;
+        h.update(&sig[..32]);
+        h.update(&pk);
+        h.update(msg);
+        reduce(h, &mut k);
+
+        unsafe {
+            ffi::ed25519::Hacl_Ed25519_Ctx_verify_finish(
+                pk.as_ptr() as _,
+                sig.as_ptr() as _,
+                k.as_mut_ptr()
+            )
+        }
+    }
+}
+
+/// Signatures and verifications hashed four at a time in `sign_batch` and
+/// `verify_batch`.
+const BATCH_LENGTH: usize = 4;
+
+/// `keys[i].signature(msgs[i])` into `sigs[i]`.
+///
+/// The nonce hashes `prefix || M` and the challenge hashes `R || A || M` of four
+/// signatures at a time go through `Sha512x4`; the scalar multiplications are
+/// still one per signature.
+pub fn sign_batch(sigs: &mut [Signature], keys: &[SecretKey], msgs: &[&[u8]]) {
+    assert_eq!(sigs.len(), keys.len());
+    assert_eq!(sigs.len(), msgs.len());
+
+    let chunks = sigs.chunks_mut(BATCH_LENGTH)
+        .zip(keys.chunks(BATCH_LENGTH))
+        .zip(msgs.chunks(BATCH_LENGTH));
+
+    for ((sigs, keys), msgs) in chunks {
+        sign_chunk(sigs, keys, msgs);
+    }
+}
+
+fn sign_chunk(sigs: &mut [Signature], keys: &[SecretKey], msgs: &[&[u8]]) {
+    let n = sigs.len();
+
+    // public key || secret scalar || nonce prefix, as in `sign_dom`
+    let mut ks = [[0; 96]; BATCH_LENGTH];
+    let mut hashes = [[0; 64]; BATCH_LENGTH];
+    let mut r = [[0; 32]; BATCH_LENGTH];
+    let mut k = [[0; 32]; BATCH_LENGTH];
+    let mut m = [&[][..]; BATCH_LENGTH];
+
+    for i in 0..n {
+        let SecretKey(sk) = &keys[i];
+        unsafe {
+            ffi::ed25519::Hacl_Ed25519_expand_keys(ks[i].as_mut_ptr(), sk.as_ptr() as _);
+        }
+        m[i] = msgs[i];
+    }
+
+    let mut h = Sha512x4::default();
+    h.update([&ks[0][64..], &ks[1][64..], &ks[2][64..], &ks[3][64..]]);
+    h.update(m);
+    h.finish(&mut hashes);
+
+    for i in 0..n {
+        let Signature(sig) = &mut sigs[i];
+        unsafe {
+            ffi::ed25519::Hacl_Ed25519_Ctx_reduce(r[i].as_mut_ptr(), hashes[i].as_mut_ptr());
+            ffi::ed25519::Hacl_Ed25519_Ctx_point_mul_g_compress(sig.as_mut_ptr(), r[i].as_mut_ptr());
+        }
+    }
+
+    let mut rs = [[0; 32]; BATCH_LENGTH];
+    for i in 0..n {
+        rs[i].copy_from_slice(&sigs[i].0[..32]);
+    }
+
+    let mut h = Sha512x4::default();
+    h.update([&rs[0], &rs[1], &rs[2], &rs[3]]);
+    h.update([&ks[0][..32], &ks[1][..32], &ks[2][..32], &ks[3][..32]]);
+    h.update(m);
+    h.finish(&mut hashes);
+
+    for i in 0..n {
+        let Signature(sig) = &mut sigs[i];
+        unsafe {
+            ffi::ed25519::Hacl_Ed25519_Ctx_reduce(k[i].as_mut_ptr(), hashes[i].as_mut_ptr());
+            ffi::ed25519::Hacl_Ed25519_Ctx_sign_finish(
+                sig[32..].as_mut_ptr(),
+                r[i].as_mut_ptr(),
+                k[i].as_mut_ptr(),
+                ks[i][32..].as_mut_ptr()
+            );
+        }
+    }
+
+    for i in 0..BATCH_LENGTH {
+        wipe(&mut ks[i]);
+        wipe(&mut r[i]);
+    }
+}
+
+/// `keys[i].verify(msgs[i], &sigs[i])` into `results[i]`, with the challenge
+/// hashes `R || A || M` of four signatures at a time in `Sha512x4`. Returns
+/// whether all of them verified.
+pub fn verify_batch(results: &mut [bool], keys: &[PublicKey], msgs: &[&[u8]], sigs: &[Signature]) -> bool {
+    assert_eq!(results.len(), keys.len());
+    assert_eq!(results.len(), msgs.len());
+    assert_eq!(results.len(), sigs.len());
+
+    let chunks = results.chunks_mut(BATCH_LENGTH)
+        .zip(keys.chunks(BATCH_LENGTH))
+        .zip(msgs.chunks(BATCH_LENGTH))
+        .zip(sigs.chunks(BATCH_LENGTH));
+
+    let mut all = true;
+    for (((results, keys), msgs), sigs) in chunks {
+        all &= verify_chunk(results, keys, msgs, sigs);
+    }
+    all
+}
+
+fn verify_chunk(results: &mut [bool], keys: &[PublicKey], msgs: &[&[u8]], sigs: &[Signature]) -> bool {
+    let n = results.len();
+    let mut rs = [&[][..]; BATCH_LENGTH];
+    let mut pks = [&[][..]; BATCH_LENGTH];
+    let mut m = [&[][..]; BATCH_LENGTH];
+    let mut hashes = [[0; 64]; BATCH_LENGTH];
+
+    for i in 0..n {
+        rs[i] = &sigs[i].0[..32];
+        pks[i] = &keys[i].0[..];
+        m[i] = msgs[i];
+    }
+
+    let mut h = Sha512x4::default();
+    h.update(rs);
+    h.update(pks);
+    h.update(m);
+    h.finish(&mut hashes);
+
+    let mut all = true;
+    for i in 0..n {
+        let mut k = [0; 32];
+        results[i] = unsafe {
+            ffi::ed25519::Hacl_Ed25519_Ctx_reduce(k.as_mut_ptr(), hashes[i].as_mut_ptr());
+            ffi::ed25519::Hacl_Ed25519_Ctx_verify_finish(
+                keys[i].0.as_ptr() as _,
+                sigs[i].0.as_ptr() as _,
+                k.as_mut_ptr()
+            )
+        };
+        all &= results[i];
+    }
+    all
+}
+
+/// SHA-512 state after `dom2(phflag, context)`.
+fn dom2(phflag: u8, context: &[u8]) -> Sha512 {
+    assert!(context.len() <= CONTEXT_MAX_LENGTH);
+
+    let mut h = Sha512::default();
+    h.update(b"SigEd25519 no Ed25519 collisions");
+    h.update(&[phflag, context.len() as u8]);
+    h.update(context);
+    h
+}
+
+fn reduce(h: Sha512, out: &mut [u8; 32]) {
+    let mut hash = [0; 64];
+    h.finish(&mut hash);
+
+    unsafe {
+        ffi::ed25519::Hacl_Ed25519_Ctx_reduce(out.as_mut_ptr(), hash.as_mut_ptr());
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -89,4 +371,16 @@ mod tests {
         let msg = b"foo";
         sec.signature(&msg[..]);
     }
+
+    #[test]
+    fn sign_streamed() {
+        // the path taken by messages over `u32::MAX` bytes
+        let mut csprng: ThreadRng = thread_rng();
+        let (sec, public) = keypair(&mut csprng);
+        let msg = [0x5a; 1000];
+
+        let sig = sec.sign_dom(Sha512::default(), &msg);
+        assert_eq!(&sig.0[..], &sec.signature(&msg).0[..]);
+        assert!(public.verify_dom(Sha512::default(), &msg, &sig));
+    }
 }
@@ -0,0 +1,213 @@
+//! Several digests of a file or stream in one read pass.
+
+use std::boxed::Box;
+use std::fmt;
+use std::fs::File;
+use std::io::{ self, Read };
+use std::path::Path;
+use std::sync::Arc;
+use std::sync::mpsc::{ channel, sync_channel };
+use std::thread;
+use std::vec::Vec;
+use crate::hash::Hash;
+use crate::sha2::{ Sha224, Sha256, Sha384, Sha512 };
+use crate::blake2::{ Blake2s, Blake2b };
+
+
+/// Bytes per read; each chunk is shared by all hashing threads, then reused.
+const CHUNK_LENGTH: usize = 1 << 20;
+
+/// Chunks a hashing thread may fall behind the reader.
+const QUEUE_LENGTH: usize = 4;
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Algorithm {
+    Sha224,
+    Sha256,
+    Sha384,
+    Sha512,
+    Blake2s,
+    Blake2b
+}
+
+impl Algorithm {
+    pub fn hash_length(self) -> usize {
+        match self {
+            Algorithm::Sha224 => Sha224::HASH_LENGTH,
+            Algorithm::Sha256 => Sha256::HASH_LENGTH,
+            Algorithm::Sha384 => Sha384::HASH_LENGTH,
+            Algorithm::Sha512 => Sha512::HASH_LENGTH,
+            Algorithm::Blake2s => Blake2s::HASH_LENGTH,
+            Algorithm::Blake2b => Blake2b::HASH_LENGTH
+        }
+    }
+
+    fn state(self) -> Box<dyn Update> {
+        match self {
+            Algorithm::Sha224 => Box::new(Sha224::default()),
+            Algorithm::Sha256 => Box::new(Sha256::default()),
+            Algorithm::Sha384 => Box::new(Sha384::default()),
+            Algorithm::Sha512 => Box::new(Sha512::default()),
+            Algorithm::Blake2s => Box::new(Blake2s::default()),
+            Algorithm::Blake2b => Box::new(Blake2b::default())
+        }
+    }
+}
+
+/// The tag of BSD-style checksum lines, e.g. `SHA256` or `BLAKE2b`.
+impl fmt::Display for Algorithm {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.write_str(match self {
+            Algorithm::Sha224 => "SHA224",
+            Algorithm::Sha256 => "SHA256",
+            Algorithm::Sha384 => "SHA384",
+            Algorithm::Sha512 => "SHA512",
+            Algorithm::Blake2s => "BLAKE2s",
+            Algorithm::Blake2b => "BLAKE2b"
+        })
+    }
+}
+
+#[derive(Clone)]
+pub struct Digest {
+    pub algorithm: Algorithm,
+    bytes: [u8; 64]
+}
+
+impl AsRef<[u8]> for Digest {
+    fn as_ref(&self) -> &[u8] {
+        &self.bytes[..self.algorithm.hash_length()]
+    }
+}
+
+/// Object-safe side of `Hash`, so one thread type serves every algorithm.
+trait Update: Send {
+    fn update(&mut self, buf: &[u8]);
+    fn finish(self: Box<Self>, output: &mut [u8]);
+}
+
+impl<H: Hash + Send> Update for H {
+    #[inline]
+    fn update(&mut self, buf: &[u8]) {
+        Hash::update(self, buf)
+    }
+
+    fn finish(self: Box<Self>, output: &mut [u8]) {
+        self.finish_into(output)
+    }
+}
+
+/// Digests of the file at `path`, one per entry of `algorithms`.
+pub fn hash_file<P: AsRef<Path>>(path: P, algorithms: &[Algorithm]) -> io::Result<Vec<Digest>> {
+    hash_reader(File::open(path)?, algorithms)
+}
+
+/// Digests of everything `reader` yields, of any length.
+///
+/// The input is read once, in `CHUNK_LENGTH` pieces; with more than one algorithm
+/// every digest runs on its own thread, so the pass costs about as much as the
+/// slowest hash (or the read, when that is slower).
+pub fn hash_reader<R: Read>(mut reader: R, algorithms: &[Algorithm]) -> io::Result<Vec<Digest>> {
+    if algorithms.len() <= 1 {
+        let mut states = algorithms.iter().map(|alg| alg.state()).collect::<Vec<_>>();
+        let mut buf = std::vec![0; CHUNK_LENGTH];
+
+        loop {
+            let n = read_chunk(&mut reader, &mut buf)?;
+            for state in states.iter_mut() {
+                state.update(&buf[..n]);
+            }
+            if n < CHUNK_LENGTH {
+                break
+            }
+        }
+
+        return Ok(finish(algorithms, states));
+    }
+
+    let mut senders = Vec::with_capacity(algorithms.len());
+    let mut threads = Vec::with_capacity(algorithms.len());
+    // buffers every thread is done with, back to the reader
+    let (recycle, recycled) = channel::<Vec<u8>>();
+
+    for &alg in algorithms {
+        let (sender, receiver) = sync_channel::<Arc<Vec<u8>>>(QUEUE_LENGTH);
+        let mut state = alg.state();
+        let recycle = recycle.clone();
+
+        senders.push(sender);
+        threads.push(thread::spawn(move || {
+            for chunk in receiver {
+                state.update(&chunk);
+                // only the last holder gets the buffer; the reader keeps none
+                if let Ok(buf) = Arc::try_unwrap(chunk) {
+                    let _ = recycle.send(buf);
+                }
+            }
+            state
+        }));
+    }
+
+    let mut result = Ok(());
+
+    loop {
+        // allocates only until buffers come back; at most QUEUE_LENGTH + 2 are
+        // live, the slowest thread's queue, the chunk it hashes and this one
+        let mut buf = recycled.try_recv().unwrap_or_else(|_| std::vec![0; CHUNK_LENGTH]);
+        buf.resize(CHUNK_LENGTH, 0);
+        let n = match read_chunk(&mut reader, &mut buf) {
+            Ok(n) => n,
+            Err(err) => {
+                result = Err(err);
+                break
+            }
+        };
+
+        buf.truncate(n);
+        let chunk = Arc::new(buf);
+        for sender in &senders[1..] {
+            sender.send(chunk.clone()).expect("hash thread panicked");
+        }
+        senders[0].send(chunk).expect("hash thread panicked");
+
+        if n < CHUNK_LENGTH {
+            break
+        }
+    }
+
+    // closing the channels ends the threads
+    drop(senders);
+
+    let states = threads.into_iter()
+        .map(|thread| thread.join().expect("hash thread panicked"))
+        .collect::<Vec<_>>();
+
+    result.map(|()| finish(algorithms, states))
+}
+
+/// Fills `buf` unless the input ends first; returns the bytes read.
+fn read_chunk<R: Read>(reader: &mut R, buf: &mut [u8]) -> io::Result<usize> {
+    let mut n = 0;
+
+    while n < buf.len() {
+        match reader.read(&mut buf[n..]) {
+            Ok(0) => break,
+            Ok(m) => n += m,
+            Err(ref err) if err.kind() == io::ErrorKind::Interrupted => (),
+            Err(err) => return Err(err)
+        }
+    }
+
+    Ok(n)
+}
+
+fn finish(algorithms: &[Algorithm], states: Vec<Box<dyn Update>>) -> Vec<Digest> {
+    algorithms.iter()
+        .zip(states)
+        .map(|(&algorithm, state)| {
+            let mut bytes = [0; 64];
+            state.finish(&mut bytes);
+            Digest { algorithm, bytes }
+        })
+        .collect()
+}
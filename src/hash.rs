@@ -0,0 +1,53 @@
+/// Incremental hash function, implemented by the SHA-2 and BLAKE2 states.
+pub trait Hash: Clone + Default {
+    const BLOCK_LENGTH: usize;
+    const HASH_LENGTH: usize;
+
+    fn update(&mut self, buf: &[u8]);
+
+    /// Writes the digest into `output[..Self::HASH_LENGTH]`.
+    fn finish_into(self, output: &mut [u8]);
+
+    /// Compresses a whole buffered block now rather than on the next `update`.
+    ///
+    /// BLAKE2 keeps its last full block back because the final block is compressed
+    /// differently; calling this after a block-aligned prefix makes the cached state
+    /// hold the finished compression. SHA-2 compresses eagerly, so it is a no-op there.
+    fn flush(&mut self) {}
+
+    /// Copy of a partially absorbed state, to finish several messages that share
+    /// what was hashed so far. The states are plain arrays, so this is a memcpy.
+    #[inline]
+    fn fork(&self) -> Self {
+        self.clone()
+    }
+}
+
+/// State after a constant prefix, absorbed (and flushed) once; each message then
+/// costs a copy of the state plus the compressions of its suffix.
+#[derive(Clone)]
+pub struct PrefixHasher<H> {
+    state: H
+}
+
+impl<H: Hash> PrefixHasher<H> {
+    pub fn new(prefix: &[u8]) -> PrefixHasher<H> {
+        let mut state = H::default();
+        state.update(prefix);
+        state.flush();
+        PrefixHasher { state }
+    }
+
+    /// Fresh state positioned after the prefix.
+    #[inline]
+    pub fn hasher(&self) -> H {
+        self.state.fork()
+    }
+
+    /// Writes the digest of `prefix || suffix` into `output[..H::HASH_LENGTH]`.
+    pub fn hash(&self, suffix: &[u8], output: &mut [u8]) {
+        let mut state = self.hasher();
+        state.update(suffix);
+        state.finish_into(output);
+    }
+}
@@ -0,0 +1,43 @@
+use crate::hash::Hash;
+use crate::hmac::Hmac;
+
+
+/// HKDF (RFC 5869) holding the PRK as a keyed `Hmac`, so every `expand` reuses
+/// its precomputed pads.
+#[derive(Clone)]
+pub struct Hkdf<H> {
+    prk: Hmac<H>
+}
+
+impl<H: Hash> Hkdf<H> {
+    /// Runs HKDF-Extract; an empty `salt` stands for `HASH_LENGTH` zero bytes.
+    pub fn extract(salt: &[u8], ikm: &[u8]) -> Hkdf<H> {
+        let mut prk = [0; 64];
+        Hmac::<H>::new(salt).mac(ikm, &mut prk);
+        Hkdf::new(&prk[..H::HASH_LENGTH])
+    }
+
+    /// Starts from an existing pseudorandom key.
+    pub fn new(prk: &[u8]) -> Hkdf<H> {
+        Hkdf { prk: Hmac::new(prk) }
+    }
+
+    /// Fills `okm` with HKDF-Expand output, at most `255 * HASH_LENGTH` bytes.
+    pub fn expand(&self, info: &[u8], okm: &mut [u8]) {
+        assert!(okm.len() <= 255 * H::HASH_LENGTH);
+
+        let mut t = [0; 64];
+
+        for (i, chunk) in okm.chunks_mut(H::HASH_LENGTH).enumerate() {
+            let mut state = self.prk.clone();
+            if i > 0 {
+                state.update(&t[..H::HASH_LENGTH]);
+            }
+            state.update(info);
+            state.update(&[i as u8 + 1]);
+            state.finish(&mut t);
+
+            chunk.copy_from_slice(&t[..chunk.len()]);
+        }
+    }
+}
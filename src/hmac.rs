@@ -1,12 +1,92 @@
 use hacl_star_sys as ffi;
+use crate::hash::Hash;
+use crate::sha2::{ Sha256, Sha512 };
+use crate::wipe::wipe;
 
 
-pub const KEY_LENGTH: usize = 64;
+/// Largest block length of the supported hashes (SHA-512, BLAKE2b).
+const MAX_BLOCK_LENGTH: usize = 128;
+
+/// Largest digest length of the supported hashes.
+const MAX_HASH_LENGTH: usize = 64;
+
+/// HMAC keyed once: the ipad and opad blocks are compressed in `new`, and every
+/// message starts from a clone of those states instead of rehashing the key.
+///
+/// `Hmac` is also the streaming state, so keep one per key and clone it per message.
+#[derive(Clone)]
+pub struct Hmac<H> {
+    inner: H,
+    outer: H
+}
+
+impl<H: Hash> Hmac<H> {
+    pub const MAC_LENGTH: usize = H::HASH_LENGTH;
+
+    pub fn new(key: &[u8]) -> Hmac<H> {
+        let block_len = H::BLOCK_LENGTH;
+        let mut block = [0; MAX_BLOCK_LENGTH];
+
+        if key.len() > block_len {
+            let mut h = H::default();
+            h.update(key);
+            h.finish_into(&mut block);
+        } else {
+            block[..key.len()].copy_from_slice(key);
+        }
+
+        let mut inner = H::default();
+        let mut outer = H::default();
+
+        for b in block[..block_len].iter_mut() {
+            *b ^= 0x36;
+        }
+        inner.update(&block[..block_len]);
+        inner.flush();
+
+        for b in block[..block_len].iter_mut() {
+            *b ^= 0x36 ^ 0x5c;
+        }
+        outer.update(&block[..block_len]);
+        outer.flush();
+        wipe(&mut block);
+
+        Hmac { inner, outer }
+    }
+
+    /// Computes the tag of `data` into `output[..Self::MAC_LENGTH]`.
+    pub fn mac(&self, data: &[u8], output: &mut [u8]) {
+        let mut state = self.clone();
+        state.update(data);
+        state.finish(output);
+    }
+
+    #[inline]
+    pub fn update(&mut self, buf: &[u8]) {
+        self.inner.update(buf);
+    }
+
+    /// Writes the tag into `output[..Self::MAC_LENGTH]`.
+    pub fn finish(self, output: &mut [u8]) {
+        let Hmac { inner, mut outer } = self;
+        let mut hash = [0; MAX_HASH_LENGTH];
+
+        inner.finish_into(&mut hash);
+        outer.update(&hash[..H::HASH_LENGTH]);
+        outer.finish_into(output);
+    }
+}
+
 pub const MAC_LENGTH: usize = 32;
 
 pub fn hmac_sha256(mac: &mut [u8; MAC_LENGTH], key: &[u8], data: &[u8]) {
+    // the one-shot functions take `u32` lengths
+    if key.len() > u32::max_value() as usize || data.len() > u32::max_value() as usize {
+        return Hmac::<Sha256>::new(key).mac(data, mac);
+    }
+
     unsafe {
-        ffi::hmac_sha2_256::hmac(
+        ffi::hmac::Hacl_HMAC_compute_sha2_256(
             mac.as_mut_ptr(),
             key.as_ptr() as _,
             key.len() as _,
@@ -16,11 +96,16 @@ pub fn hmac_sha256(mac: &mut [u8; MAC_LENGTH], key: &[u8], data: &[u8]) {
     }
 }
 
-pub fn hmac_sha256_core(mac: &mut [u8; MAC_LENGTH], key: &[u8; KEY_LENGTH], data: &[u8]) {
+pub fn hmac_sha512(mac: &mut [u8; 64], key: &[u8], data: &[u8]) {
+    if key.len() > u32::max_value() as usize || data.len() > u32::max_value() as usize {
+        return Hmac::<Sha512>::new(key).mac(data, mac);
+    }
+
     unsafe {
-        ffi::hmac_sha2_256::hmac_core(
+        ffi::hmac::Hacl_HMAC_compute_sha2_512(
             mac.as_mut_ptr(),
             key.as_ptr() as _,
+            key.len() as _,
             data.as_ptr() as _,
             data.len() as _
         );
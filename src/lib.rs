@@ -1,5 +1,8 @@
 #![no_std]
 
+#[cfg(feature = "std")]
+extern crate std;
+
 pub struct And<A, B>(pub A, pub B);
 
 macro_rules! define {
@@ -17,13 +20,29 @@ macro_rules! define {
     };
 }
 
-// pub mod hash;
-// pub mod sha2;
-// pub mod hmac;
-// pub mod poly1305;
+pub use hacl_star_sys::dispatch;
+
+mod wipe;
+
+pub mod hash;
+pub mod sha2;
+pub mod blake2;
+pub mod hmac;
+pub mod hkdf;
+pub mod poly1305;
+pub mod aead;
+#[cfg(not(all(
+    target_arch = "wasm32",
+    not(any(target_os = "emscripten", target_os = "wasi"))
+)))]
+pub mod drbg;
+#[cfg(feature = "std")]
+pub mod file;
+#[cfg(feature = "std")]
+pub mod merkle;
 // pub mod chacha20;
 // pub mod salsa20;
 // pub mod chacha20poly1305;
 pub mod curve25519;
 pub mod ed25519;
-// pub mod nacl;
+pub mod nacl;
@@ -0,0 +1,361 @@
+//! Binary Merkle trees, as HACL*'s `MerkleTree` builds them, with multiproofs
+//! and consistency proofs.
+//!
+//! Nodes are paired level by level and the last node of a level with an odd
+//! count is carried up unchanged, which gives the shape of RFC 6962 (without its
+//! leaf and node prefixes). A node is `Algorithm::node(left, right)`; with
+//! `Algorithm::Sha256` that is the SHA-256 compression function on the standard
+//! IV and the single block `left || right`, without the padding block of a full
+//! SHA-256.
+
+use std::vec::Vec;
+use hacl_star_sys as ffi;
+use ffi::merkle::*;
+
+mod storage;
+#[cfg(unix)]
+mod mapped;
+mod snapshot;
+mod consistency;
+
+pub use self::snapshot::{ Writer, Reader, Pinned, Snapshot };
+pub use self::consistency::{ ConsistencyProof, Consistency, verify_consistency };
+use self::storage::{ Storage, Spine, LEVELS };
+
+
+/// Longest node hash, that of `Algorithm::Blake2b`.
+pub const MAX_HASH_LENGTH: usize = 64;
+
+/// Node hash of a tree; leaves are hashes of the same length.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Algorithm {
+    /// `mt_sha256_compress`, 32 bytes, computed by the kernel of `dispatch`: the
+    /// SHA extensions where the cpu has them, the vector kernels for batches
+    /// otherwise.
+    Sha256,
+    /// BLAKE2s-256 of `left || right`, 32 bytes.
+    Blake2s,
+    /// BLAKE2b-512 of `left || right`, 64 bytes.
+    Blake2b
+}
+
+impl Algorithm {
+    pub fn hash_length(self) -> usize {
+        match self {
+            Algorithm::Sha256 | Algorithm::Blake2s => 32,
+            Algorithm::Blake2b => 64
+        }
+    }
+
+    /// Node kernel for `mt_hash_pairs`, picked once by `dispatch`.
+    fn kernel(self) -> mt_kernel {
+        match self {
+            Algorithm::Sha256 => ffi::dispatch::table().merkle_sha256,
+            Algorithm::Blake2s => ffi::dispatch::table().merkle_blake2s,
+            Algorithm::Blake2b => mt_kernel { node: Some(mt_blake2b_compress), lanes: 1, batch: None }
+        }
+    }
+
+    /// The parent of `left` and `right` into `out`, all `hash_length` bytes.
+    pub fn node(self, left: &[u8], right: &[u8], out: &mut [u8]) {
+        let len = self.hash_length();
+        assert_eq!(left.len(), len);
+        assert_eq!(right.len(), len);
+        assert_eq!(out.len(), len);
+
+        // the node hashes take mutable pointers, though they only read their inputs
+        let mut left_buf = [0; MAX_HASH_LENGTH];
+        let mut right_buf = [0; MAX_HASH_LENGTH];
+        left_buf[..len].copy_from_slice(left);
+        right_buf[..len].copy_from_slice(right);
+        let node = self.kernel().node.unwrap();
+        unsafe { node(left_buf.as_mut_ptr(), right_buf.as_mut_ptr(), out.as_mut_ptr()) };
+    }
+}
+
+/// Append-only Merkle tree of leaf hashes.
+///
+/// Each level is a run of fixed-size segments of contiguous hashes, so inserting
+/// and flushing allocate per segment rather than per node (HACL*'s tree mallocs
+/// every node and reaches it through an array of pointers), and proofs read
+/// neighbouring nodes from the same cache lines. Nodes are hashed by HACL*.
+///
+/// Every change ends by bringing the root and the right-hand side of the tree
+/// (the partial node at the end of each level) up to date, at one compression
+/// per level whose node count is odd. Reads never hash or write, so a shared
+/// `Tree` serves roots and proofs from any number of threads; `insert_batch`
+/// pays for the root once per batch rather than once per leaf.
+pub struct Tree {
+    algorithm: Algorithm,
+    storage: Storage,
+    offset: u64,
+    size: u64,
+    spine: Spine
+}
+
+impl Tree {
+    /// A tree holding `init` as its first leaf.
+    pub fn new(algorithm: Algorithm, init: &[u8]) -> Tree {
+        assert_eq!(init.len(), algorithm.hash_length());
+        Tree::from_leaves(algorithm, init)
+    }
+
+    /// A tree of the leaves laid out back to back in `leaves`, at least one.
+    pub fn from_leaves(algorithm: Algorithm, leaves: &[u8]) -> Tree {
+        let len = algorithm.hash_length();
+        assert!(leaves.len() >= len);
+
+        let storage = Storage::new(len);
+        let spine = unsafe { storage.spine(algorithm, 0) };
+        let mut tree = Tree { algorithm, storage, offset: 0, size: 0, spine };
+        tree.insert_batch(leaves);
+        tree
+    }
+
+    pub fn algorithm(&self) -> Algorithm {
+        self.algorithm
+    }
+
+    /// Number of leaves inserted, flushed ones included.
+    pub fn len(&self) -> u64 {
+        self.size
+    }
+
+    pub fn insert(&mut self, leaf: &[u8]) {
+        assert_eq!(leaf.len(), self.algorithm.hash_length());
+        self.insert_batch(leaf);
+    }
+
+    /// Inserts the leaves laid out back to back in `leaves`, as `insert` on each
+    /// would. The new nodes of a level are hashed several at a time, by the
+    /// kernel `dispatch::backends().merkle` names.
+    pub fn insert_batch(&mut self, leaves: &[u8]) {
+        self.size = unsafe { self.storage.append(self.algorithm, self.size, leaves) };
+        self.update_root();
+    }
+
+    /// The root, as of the last change; nothing is hashed here.
+    pub fn root(&self) -> &[u8] {
+        self.spine.root(self.algorithm.hash_length())
+    }
+
+    /// Sibling hashes from leaf `idx` up to the root; `idx` must not be flushed.
+    pub fn path(&self, idx: u64) -> Vec<Vec<u8>> {
+        self.multiproof(&[idx]).nodes().map(|node| node.to_vec()).collect()
+    }
+
+    /// Drops the leaves before `idx` and the nodes only they need; `idx` stays.
+    pub fn flush_to(&mut self, idx: u64) {
+        assert!(self.offset <= idx && idx < self.size);
+
+        let mut lo = [0; LEVELS];
+        for (lv, lo) in lo.iter_mut().enumerate() {
+            *lo = (idx >> lv) & !1;
+        }
+        // neither the root nor the spine change
+        self.storage = self.storage.share(&lo, &[u64::max_value(); LEVELS]);
+        self.offset = idx;
+    }
+
+    /// Drops the leaves after `idx`; `idx` stays.
+    pub fn retract_to(&mut self, idx: u64) {
+        assert!(self.offset <= idx && idx < self.size);
+
+        let mut hi = [0; LEVELS];
+        for (lv, hi) in hi.iter_mut().enumerate() {
+            *hi = (idx + 1) >> lv;
+        }
+        self.storage = self.storage.share(&[0; LEVELS], &hi);
+        self.size = idx + 1;
+        self.update_root();
+    }
+
+    /// One proof for the leaves at `indices`, strictly increasing and not flushed.
+    ///
+    /// Holds each node the verifier cannot compute from the leaves exactly once,
+    /// so a run of adjacent leaves costs about two paths rather than one per leaf.
+    pub fn multiproof(&self, indices: &[u64]) -> MultiProof {
+        assert!(!indices.is_empty());
+        assert!(indices[0] >= self.offset);
+        assert!(indices[indices.len() - 1] < self.size);
+
+        unsafe { self.storage.multiproof(&self.spine, self.size, indices) }
+    }
+
+    /// The proof that this tree's first `old_size` leaves, of which at least
+    /// the last is not flushed, are a prefix of it.
+    pub fn consistency(&self, old_size: u64) -> ConsistencyProof {
+        assert!(self.offset < old_size && old_size <= self.size);
+
+        unsafe { self.storage.consistency(&self.spine, self.size, old_size) }
+    }
+
+    fn update_root(&mut self) {
+        self.spine = unsafe { self.storage.spine(self.algorithm, self.size) };
+    }
+}
+
+/// The multiproof for the leaves `known` of a tree of `width` leaves, whose
+/// node `k` of level `lv` is `node(lv, k)`; that is called only for siblings.
+fn prove<'a, F>(hash_length: usize, mut width: u64, mut known: Vec<u64>, node: F) -> MultiProof
+    where F: Fn(u32, u64) -> &'a [u8]
+{
+    assert!(known.windows(2).all(|w| w[0] < w[1]));
+
+    let mut nodes = Vec::new();
+    let mut lv = 0;
+
+    while width > 1 {
+        let mut p = 0;
+        let mut parents = 0;
+
+        while p < known.len() {
+            let k = known[p];
+
+            if k % 2 == 1 {
+                nodes.extend_from_slice(node(lv, k - 1));
+            } else if p + 1 < known.len() && known[p + 1] == k + 1 {
+                p += 1;
+            } else if k + 1 < width {
+                nodes.extend_from_slice(node(lv, k + 1));
+            }
+
+            known[parents] = k / 2;
+            parents += 1;
+            p += 1;
+        }
+
+        known.truncate(parents);
+        lv += 1;
+        width = width / 2 + width % 2;
+    }
+
+    MultiProof { hash_length, nodes }
+}
+
+/// Inclusion proof for several leaves of one tree.
+///
+/// The nodes are ordered level by level from the leaves up, and left to right
+/// within a level, which is the order `verify` consumes them in.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct MultiProof {
+    hash_length: usize,
+    nodes: Vec<u8>
+}
+
+impl MultiProof {
+    pub fn hash_length(&self) -> usize {
+        self.hash_length
+    }
+
+    pub fn nodes(&self) -> core::slice::Chunks<'_, u8> {
+        self.nodes.chunks(self.hash_length)
+    }
+
+    /// The layout of `mt_serialize_path`: big-endian hash size and node count,
+    /// then the nodes.
+    pub fn to_bytes(&self) -> Vec<u8> {
+        serialize(self.hash_length, &self.nodes)
+    }
+
+    pub fn from_bytes(buf: &[u8]) -> Option<MultiProof> {
+        deserialize(buf).map(|(hash_length, nodes)| MultiProof { hash_length, nodes })
+    }
+
+    /// Checks that `leaves`, laid out back to back, sit at `indices` (strictly
+    /// increasing) in the `algorithm` tree of `size` leaves with root `root`.
+    pub fn verify(
+        &self,
+        algorithm: Algorithm,
+        size: u64,
+        indices: &[u64],
+        leaves: &[u8],
+        root: &[u8]
+    ) -> bool {
+        let len = algorithm.hash_length();
+        assert!(!indices.is_empty());
+        assert_eq!(indices.len() * len, leaves.len());
+        assert!(indices.windows(2).all(|w| w[0] < w[1]));
+
+        if self.hash_length != len || root.len() != len || indices[indices.len() - 1] >= size {
+            return false;
+        }
+
+        let mut known = indices.iter()
+            .zip(leaves.chunks(len))
+            .map(|(&k, leaf)| {
+                let mut hash = [0; MAX_HASH_LENGTH];
+                hash[..len].copy_from_slice(leaf);
+                (k, hash)
+            })
+            .collect::<Vec<_>>();
+        let mut nodes = self.nodes();
+        let mut width = size;
+
+        while width > 1 {
+            let mut p = 0;
+            let mut parents = 0;
+
+            while p < known.len() {
+                let (k, hash) = known[p];
+                let mut parent = [0; MAX_HASH_LENGTH];
+
+                if k % 2 == 1 {
+                    match nodes.next() {
+                        Some(sibling) => algorithm.node(sibling, &hash[..len], &mut parent[..len]),
+                        None => return false
+                    }
+                } else if p + 1 < known.len() && known[p + 1].0 == k + 1 {
+                    p += 1;
+                    algorithm.node(&hash[..len], &known[p].1[..len], &mut parent[..len]);
+                } else if k + 1 < width {
+                    match nodes.next() {
+                        Some(sibling) => algorithm.node(&hash[..len], sibling, &mut parent[..len]),
+                        None => return false
+                    }
+                } else {
+                    parent = hash;
+                }
+
+                known[parents] = (k / 2, parent);
+                parents += 1;
+                p += 1;
+            }
+
+            known.truncate(parents);
+            width = width / 2 + width % 2;
+        }
+
+        nodes.next().is_none() && &known[0].1[..len] == root
+    }
+}
+
+fn serialize(hash_length: usize, nodes: &[u8]) -> Vec<u8> {
+    let mut buf = Vec::with_capacity(8 + nodes.len());
+    buf.extend_from_slice(&(hash_length as u32).to_be_bytes());
+    buf.extend_from_slice(&((nodes.len() / hash_length) as u32).to_be_bytes());
+    buf.extend_from_slice(nodes);
+    buf
+}
+
+fn deserialize(buf: &[u8]) -> Option<(usize, Vec<u8>)> {
+    if buf.len() < 8 {
+        return None;
+    }
+
+    let (header, body) = buf.split_at(8);
+    let mut hash_size = [0; 4];
+    let mut count = [0; 4];
+    hash_size.copy_from_slice(&header[..4]);
+    count.copy_from_slice(&header[4..]);
+    let hash_length = u32::from_be_bytes(hash_size) as usize;
+
+    if hash_length == 0
+        || hash_length > MAX_HASH_LENGTH
+        || body.len() as u64 != u32::from_be_bytes(count) as u64 * hash_length as u64
+    {
+        return None;
+    }
+
+    Some((hash_length, body.to_vec()))
+}
@@ -0,0 +1,264 @@
+//! Consistency proofs between two sizes of one log, as in RFC 9162 (section
+//! 2.1.4) with this module's node hash.
+//!
+//! Every node such a proof holds is a complete subtree of the larger tree, or
+//! the partial node at the end of one of its levels, which the spine keeps; so
+//! proving reads nodes and hashes nothing. Verifying hashes two chains along the
+//! proof, and `verify_consistency` steps many proofs at once so that each round's
+//! compressions go through the multi-buffer kernels together.
+
+use std::vec::Vec;
+use hacl_star_sys::merkle::mt_hash_pairs;
+use super::{ Algorithm, MAX_HASH_LENGTH, serialize, deserialize };
+
+
+/// Proof that a log of `old_size` leaves is a prefix of one of `new_size`.
+///
+/// The nodes are those of RFC 9162's `SUBPROOF`, from the leaves up.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct ConsistencyProof {
+    hash_length: usize,
+    nodes: Vec<u8>
+}
+
+impl ConsistencyProof {
+    pub fn hash_length(&self) -> usize {
+        self.hash_length
+    }
+
+    pub fn nodes(&self) -> core::slice::Chunks<'_, u8> {
+        self.nodes.chunks(self.hash_length)
+    }
+
+    /// The layout of `MultiProof::to_bytes`.
+    pub fn to_bytes(&self) -> Vec<u8> {
+        serialize(self.hash_length, &self.nodes)
+    }
+
+    pub fn from_bytes(buf: &[u8]) -> Option<ConsistencyProof> {
+        deserialize(buf).map(|(hash_length, nodes)| ConsistencyProof { hash_length, nodes })
+    }
+
+    /// Checks that the `algorithm` log with root `old_root` at `old_size` leaves
+    /// is a prefix of the one with root `new_root` at `new_size`.
+    pub fn verify(
+        &self,
+        algorithm: Algorithm,
+        old_size: u64,
+        new_size: u64,
+        old_root: &[u8],
+        new_root: &[u8]
+    ) -> bool {
+        let check = Consistency { old_size, new_size, old_root, new_root, proof: self };
+        verify_consistency(algorithm, &[check])[0]
+    }
+}
+
+/// One pair of signed tree heads for `verify_consistency`.
+#[derive(Clone, Copy, Debug)]
+pub struct Consistency<'a> {
+    pub old_size: u64,
+    pub new_size: u64,
+    pub old_root: &'a [u8],
+    pub new_root: &'a [u8],
+    pub proof: &'a ConsistencyProof
+}
+
+/// `ConsistencyProof::verify` of each of `checks`, all of one log algorithm.
+///
+/// The proofs are walked in lockstep: each round takes the next node of every
+/// proof still running and hashes the one or two parents it yields for all of
+/// them in a single `mt_hash_pairs` call, several per kernel call (see
+/// `dispatch::backends().merkle`).
+pub fn verify_consistency(algorithm: Algorithm, checks: &[Consistency]) -> Vec<bool> {
+    let len = algorithm.hash_length();
+    let mut states = checks.iter().map(|check| State::new(len, check)).collect::<Vec<_>>();
+    let mut pairs = Vec::new();
+    let mut parents = Vec::new();
+    // index of the state, and whether both roots are hashed or only the new one
+    let mut jobs = Vec::new();
+
+    loop {
+        pairs.clear();
+        jobs.clear();
+
+        for (i, state) in states.iter_mut().enumerate() {
+            if state.result.is_some() {
+                continue;
+            }
+
+            let c = match state.path.get(state.next) {
+                Some(&c) => c,
+                None => {
+                    state.result = Some(
+                        &state.fr[..len] == state.check.old_root
+                            && &state.sr[..len] == state.check.new_root
+                            && state.snode == 0
+                    );
+                    continue;
+                }
+            };
+            state.next += 1;
+
+            if state.snode == 0 {
+                state.result = Some(false);
+                continue;
+            }
+
+            if state.fnode & 1 == 1 || state.fnode == state.snode {
+                pairs.extend_from_slice(c);
+                pairs.extend_from_slice(&state.fr[..len]);
+                pairs.extend_from_slice(c);
+                pairs.extend_from_slice(&state.sr[..len]);
+                jobs.push((i, true));
+
+                while state.fnode & 1 == 0 && state.fnode != 0 {
+                    state.fnode >>= 1;
+                    state.snode >>= 1;
+                }
+            } else {
+                pairs.extend_from_slice(&state.sr[..len]);
+                pairs.extend_from_slice(c);
+                jobs.push((i, false));
+            }
+            state.fnode >>= 1;
+            state.snode >>= 1;
+        }
+
+        if jobs.is_empty() {
+            break;
+        }
+
+        let n = pairs.len() / (2 * len);
+        let kernel = algorithm.kernel();
+        parents.resize(n * len, 0);
+        unsafe {
+            mt_hash_pairs(
+                &kernel,
+                len as u32,
+                n as u32,
+                pairs.as_mut_ptr(),
+                parents.as_mut_ptr()
+            );
+        }
+
+        let mut out = parents.chunks(len);
+        for &(i, both) in jobs.iter() {
+            let state = &mut states[i];
+            if both {
+                state.fr[..len].copy_from_slice(out.next().unwrap());
+            }
+            state.sr[..len].copy_from_slice(out.next().unwrap());
+        }
+    }
+
+    states.iter().map(|state| state.result == Some(true)).collect()
+}
+
+/// The verifier of RFC 9162 section 2.1.4.2, one node per round.
+struct State<'a> {
+    check: &'a Consistency<'a>,
+    /// The proof, with the old root in front when `old_size` is a power of two.
+    path: Vec<&'a [u8]>,
+    next: usize,
+    fnode: u64,
+    snode: u64,
+    fr: [u8; MAX_HASH_LENGTH],
+    sr: [u8; MAX_HASH_LENGTH],
+    result: Option<bool>
+}
+
+impl<'a> State<'a> {
+    fn new(len: usize, check: &'a Consistency<'a>) -> State<'a> {
+        let mut state = State {
+            check,
+            path: Vec::new(),
+            next: 1,
+            fnode: 0,
+            snode: 0,
+            fr: [0; MAX_HASH_LENGTH],
+            sr: [0; MAX_HASH_LENGTH],
+            result: None
+        };
+
+        let proof = check.proof;
+        if proof.hash_length != len
+            || check.old_root.len() != len
+            || check.new_root.len() != len
+            || check.old_size == 0
+            || check.old_size > check.new_size
+        {
+            state.result = Some(false);
+            return state;
+        }
+
+        if check.old_size == check.new_size {
+            state.result = Some(proof.nodes.is_empty() && check.old_root == check.new_root);
+            return state;
+        }
+
+        if check.old_size.is_power_of_two() {
+            state.path.push(check.old_root);
+        }
+        state.path.extend(proof.nodes());
+        if state.path.is_empty() {
+            state.result = Some(false);
+            return state;
+        }
+
+        state.fnode = check.old_size - 1;
+        state.snode = check.new_size - 1;
+        while state.fnode & 1 == 1 {
+            state.fnode >>= 1;
+            state.snode >>= 1;
+        }
+        state.fr[..len].copy_from_slice(state.path[0]);
+        state.sr[..len].copy_from_slice(state.path[0]);
+        state
+    }
+}
+
+/// The consistency proof from `old` leaves to the `size` leaves of a tree
+/// whose node `k` of level `lv` is `node(lv, k)`; that is called for complete
+/// nodes and for partial ones that are siblings, which the spine keeps.
+pub fn prove<'a, F>(hash_length: usize, size: u64, old: u64, node: F) -> ConsistencyProof
+    where F: Fn(u32, u64) -> &'a [u8]
+{
+    assert!(0 < old && old <= size);
+
+    // the subtree of leaves a..b: complete, or partial at the end of the tree,
+    // where the spine has it at the level on which its index is odd
+    let subtree = |a: u64, b: u64| {
+        let lv = if (b - a).is_power_of_two() { (b - a).trailing_zeros() } else { a.trailing_zeros() };
+        node(lv, a >> lv)
+    };
+
+    // SUBPROOF(m, D[a:b], b) unrolled, collecting the nodes top down; the flag
+    // holds while D[a:b] would be the old tree itself, whose root the verifier has
+    let mut nodes = Vec::new();
+    let (mut m, mut a, mut b) = (old, 0, size);
+    let mut old_tree = true;
+
+    while m != b - a {
+        // the largest power of two below b - a
+        let k = 1 << (63 - (b - a - 1).leading_zeros());
+        if m <= k {
+            nodes.push(subtree(a + k, b));
+            b = a + k;
+        } else {
+            nodes.push(subtree(a, a + k));
+            m -= k;
+            a += k;
+            old_tree = false;
+        }
+    }
+    if !old_tree {
+        nodes.push(subtree(a, b));
+    }
+
+    let mut buf = Vec::with_capacity(nodes.len() * hash_length);
+    for node in nodes.iter().rev() {
+        buf.extend_from_slice(node);
+    }
+    ConsistencyProof { hash_length, nodes: buf }
+}
@@ -0,0 +1,161 @@
+//! File-backed segments for the cold levels of a `Writer`.
+//!
+//! Each cold level is an unlinked file in a directory the caller picks, node `k`
+//! at byte `k * hash_length`, mapped shared in extents of `EXTENT` nodes so a
+//! billion-leaf level takes thousands of mappings rather than a million. The
+//! kernel pages the complete nodes out and keeps the ones the writer and recent
+//! readers touch; nothing is persistent, the files vanish with their mappings.
+
+use core::ptr;
+use std::fs::{ self, File, OpenOptions };
+use std::io;
+use std::os::unix::io::AsRawFd;
+use std::path::{ Path, PathBuf };
+use std::process;
+use std::sync::Arc;
+use std::sync::atomic::{ AtomicUsize, Ordering };
+use std::vec::Vec;
+use super::storage::LEVELS;
+
+
+/// Nodes per mapping: 8 MiB of 32-byte hashes, a whole number of segments and
+/// of pages.
+pub const EXTENT: u64 = 1 << 18;
+
+static FILES: AtomicUsize = AtomicUsize::new(0);
+
+/// A mapped range of a level file; unmapped, and its disk space released, once
+/// no segment uses it.
+pub struct Extent {
+    file: Arc<File>,
+    offset: u64,
+    ptr: *mut u8,
+    len: usize
+}
+
+unsafe impl Send for Extent {}
+unsafe impl Sync for Extent {}
+
+impl Extent {
+    /// Byte `offset` of the extent.
+    pub fn at(&self, offset: usize) -> *mut u8 {
+        assert!(offset < self.len);
+        unsafe { self.ptr.add(offset) }
+    }
+}
+
+impl Drop for Extent {
+    fn drop(&mut self) {
+        unsafe {
+            libc::munmap(self.ptr as *mut libc::c_void, self.len);
+
+            // flushed nodes would otherwise hold disk space until the file goes
+            #[cfg(target_os = "linux")]
+            libc::fallocate(
+                self.file.as_raw_fd(),
+                libc::FALLOC_FL_PUNCH_HOLE | libc::FALLOC_FL_KEEP_SIZE,
+                self.offset as libc::off_t,
+                self.len as libc::off_t
+            );
+        }
+    }
+}
+
+/// The files of one storage generation and the extent of each level written
+/// last. Only the writer touches it.
+pub struct Backing {
+    dir: PathBuf,
+    cold_levels: usize,
+    files: Vec<Option<Arc<File>>>,
+    last: Vec<Option<(u64, Arc<Extent>)>>
+}
+
+impl Backing {
+    /// Maps levels below `cold_levels` to files in `dir`; fails early if it
+    /// cannot create them.
+    pub fn new(dir: &Path, cold_levels: usize) -> io::Result<Backing> {
+        let mut backing = Backing {
+            dir: dir.to_path_buf(),
+            cold_levels: cold_levels.min(LEVELS),
+            files: std::vec![None; LEVELS],
+            last: std::vec![None; LEVELS]
+        };
+        if backing.cold_levels > 0 {
+            backing.file(0)?;
+        }
+        Ok(backing)
+    }
+
+    /// A generation in new files: one that retracts may not write over nodes
+    /// the previous one mapped.
+    pub fn fresh(&self) -> Backing {
+        Backing {
+            dir: self.dir.clone(),
+            cold_levels: self.cold_levels,
+            files: std::vec![None; LEVELS],
+            last: std::vec![None; LEVELS]
+        }
+    }
+
+    pub fn is_cold(&self, lv: usize) -> bool {
+        lv < self.cold_levels
+    }
+
+    /// The extent holding node `k` of level `lv`, and the node's offset in it.
+    pub fn extent(&mut self, lv: usize, k: u64, hash_length: usize) -> io::Result<(Arc<Extent>, usize)> {
+        let e = k / EXTENT;
+        let offset = (k % EXTENT) as usize * hash_length;
+
+        if let Some((last, ref extent)) = self.last[lv] {
+            if last == e {
+                return Ok((extent.clone(), offset));
+            }
+        }
+
+        let bytes = EXTENT * hash_length as u64;
+        let start = e * bytes;
+        let file = self.file(lv)?;
+        if file.metadata()?.len() < start + bytes {
+            file.set_len(start + bytes)?;
+        }
+
+        let ptr = unsafe {
+            libc::mmap(
+                ptr::null_mut(),
+                bytes as usize,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                file.as_raw_fd(),
+                start as libc::off_t
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+
+        let extent = Arc::new(Extent { file, offset: start, ptr: ptr as *mut u8, len: bytes as usize });
+        self.last[lv] = Some((e, extent.clone()));
+        Ok((extent, offset))
+    }
+
+    fn file(&mut self, lv: usize) -> io::Result<Arc<File>> {
+        if let Some(ref file) = self.files[lv] {
+            return Ok(file.clone());
+        }
+
+        let file = loop {
+            let name = std::format!("merkle-{}-{}", process::id(), FILES.fetch_add(1, Ordering::Relaxed));
+            let path = self.dir.join(name);
+            match OpenOptions::new().read(true).write(true).create_new(true).open(&path) {
+                Ok(file) => {
+                    fs::remove_file(&path)?;
+                    break Arc::new(file);
+                },
+                Err(ref err) if err.kind() == io::ErrorKind::AlreadyExists => (),
+                Err(err) => return Err(err)
+            }
+        };
+        self.files[lv] = Some(file.clone());
+        Ok(file)
+    }
+}
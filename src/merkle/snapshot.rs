@@ -0,0 +1,418 @@
+//! A Merkle log with one writer and any number of readers on snapshots.
+//!
+//! A `Tree` cannot be read while it changes. A `Writer` keeps the same levels,
+//! but after every change publishes an immutable `Snapshot`: the size, the root,
+//! the right-hand side and a reference to the storage. Readers pin the
+//! latest snapshot and then work on it alone, however far the writer has moved
+//! on; a snapshot and the storage only it still uses are freed once no reader
+//! pins or holds it. Trees, roots and proofs are the same as those of `Tree`.
+//!
+//! Pinning takes no lock and writes no shared counter: the reader announces the
+//! snapshot in a hazard slot of its own and checks it is still the latest, and
+//! the writer frees a snapshot it replaced only once no slot announces it.
+
+use core::ops::Deref;
+use core::ptr::{ self, NonNull };
+use core::sync::atomic::{ AtomicPtr, AtomicUsize, Ordering };
+use std::boxed::Box;
+use std::sync::{ Arc, Mutex };
+use std::vec::Vec;
+use super::{ Algorithm, MultiProof, ConsistencyProof };
+use super::storage::{ Storage, Spine, LEVELS };
+#[cfg(unix)]
+use super::mapped::Backing;
+#[cfg(unix)]
+use std::{ io, path::Path };
+
+
+/// Hazard slots per block of `Slots`.
+const SLOTS: usize = 64;
+
+/// The latest snapshot, shared by a `Writer` and its `Reader`s.
+struct Current {
+    /// An `Arc<Snapshot>` pointer.
+    latest: AtomicPtr<Snapshot>,
+    slots: Slots,
+    /// Snapshots the writer replaced while a slot announced them; only the
+    /// writer locks it.
+    retired: Mutex<Vec<Arc<Snapshot>>>,
+    /// Where each new `Reader` starts looking for a free slot.
+    hints: AtomicUsize
+}
+
+impl Current {
+    fn new(snapshot: Snapshot) -> Current {
+        Current {
+            latest: AtomicPtr::new(Arc::into_raw(Arc::new(snapshot)) as *mut Snapshot),
+            slots: Slots::new(),
+            retired: Mutex::new(Vec::new()),
+            hints: AtomicUsize::new(0)
+        }
+    }
+
+    /// The latest snapshot, as an `Arc`. Only the writer, the one to free
+    /// snapshots, may call it.
+    unsafe fn snapshot(&self) -> Arc<Snapshot> {
+        clone(self.latest.load(Ordering::Acquire))
+    }
+}
+
+impl Drop for Current {
+    fn drop(&mut self) {
+        unsafe { drop(Arc::from_raw(*self.latest.get_mut())) }
+    }
+}
+
+/// Another `Arc` to the snapshot at `ptr`, which must be kept alive meanwhile.
+unsafe fn clone(ptr: *const Snapshot) -> Arc<Snapshot> {
+    let snapshot = Arc::from_raw(ptr);
+    let clone = snapshot.clone();
+    core::mem::forget(snapshot);
+    clone
+}
+
+/// A cache line of its own, so that readers on different slots do not share one.
+#[repr(align(128))]
+struct Slot(AtomicPtr<Snapshot>);
+
+/// Hazard slots: null while free, then `taken()` or the snapshot their reader
+/// pins. A block is added when all are in use, and kept until the end.
+struct Slots {
+    slots: Box<[Slot]>,
+    next: AtomicPtr<Slots>
+}
+
+fn taken() -> *mut Snapshot {
+    NonNull::dangling().as_ptr()
+}
+
+impl Slots {
+    fn new() -> Slots {
+        let slots = (0..SLOTS)
+            .map(|_| Slot(AtomicPtr::new(ptr::null_mut())))
+            .collect::<Vec<_>>()
+            .into_boxed_slice();
+        Slots { slots, next: AtomicPtr::new(ptr::null_mut()) }
+    }
+
+    /// A free slot, marked taken, looking from slot `hint` on.
+    fn take(&self, hint: usize) -> &AtomicPtr<Snapshot> {
+        let mut block = self;
+
+        loop {
+            for i in 0..SLOTS {
+                let slot = &block.slots[(hint + i) % SLOTS].0;
+                if slot.load(Ordering::Relaxed).is_null()
+                    && slot.compare_exchange(ptr::null_mut(), taken(), Ordering::Acquire, Ordering::Relaxed).is_ok()
+                {
+                    return slot;
+                }
+            }
+
+            let mut next = block.next.load(Ordering::Acquire);
+            if next.is_null() {
+                let new = Box::into_raw(Box::new(Slots::new()));
+                next = match block.next.compare_exchange(ptr::null_mut(), new, Ordering::AcqRel, Ordering::Acquire) {
+                    Ok(_) => new,
+                    Err(other) => {
+                        unsafe { drop(Box::from_raw(new)) };
+                        other
+                    }
+                };
+            }
+            block = unsafe { &*next };
+        }
+    }
+
+    /// Whether a slot announces `snapshot`.
+    fn announce(&self, snapshot: *const Snapshot) -> bool {
+        let mut block = self;
+
+        loop {
+            if block.slots.iter().any(|slot| slot.0.load(Ordering::SeqCst) as *const Snapshot == snapshot) {
+                return true;
+            }
+
+            let next = block.next.load(Ordering::Acquire);
+            if next.is_null() {
+                return false;
+            }
+            block = unsafe { &*next };
+        }
+    }
+}
+
+impl Drop for Slots {
+    fn drop(&mut self) {
+        let next = *self.next.get_mut();
+        if !next.is_null() {
+            unsafe { drop(Box::from_raw(next)) }
+        }
+    }
+}
+
+
+/// Appends to a log whose snapshots other threads read.
+pub struct Writer {
+    algorithm: Algorithm,
+    storage: Arc<Storage>,
+    offset: u64,
+    size: u64,
+    current: Arc<Current>
+}
+
+impl Writer {
+    /// A log holding `init` as its first leaf.
+    pub fn new(algorithm: Algorithm, init: &[u8]) -> Writer {
+        assert_eq!(init.len(), algorithm.hash_length());
+        Writer::from_leaves(algorithm, init)
+    }
+
+    /// A log of the leaves laid out back to back in `leaves`, at least one.
+    pub fn from_leaves(algorithm: Algorithm, leaves: &[u8]) -> Writer {
+        Writer::with_storage(algorithm, Storage::new(algorithm.hash_length()), leaves)
+    }
+
+    /// `from_leaves`, keeping the `cold_levels` lowest levels in files in `dir`
+    /// rather than in memory; these hold all but a `2^-cold_levels` share of the
+    /// nodes, and the kernel pages them in and out as they are used. The files
+    /// are unlinked at once and only live as long as the log and its snapshots.
+    ///
+    /// Errors are those of creating a file in `dir`; later failures to extend or
+    /// map one, e.g. for lack of address space, panic like a failed allocation,
+    /// and a full disk raises `SIGBUS`.
+    #[cfg(unix)]
+    pub fn on_disk(algorithm: Algorithm, leaves: &[u8], dir: &Path, cold_levels: usize) -> io::Result<Writer> {
+        let backing = Backing::new(dir, cold_levels)?;
+        let storage = Storage::mapped(algorithm.hash_length(), backing);
+        Ok(Writer::with_storage(algorithm, storage, leaves))
+    }
+
+    fn with_storage(algorithm: Algorithm, storage: Storage, leaves: &[u8]) -> Writer {
+        assert!(leaves.len() >= algorithm.hash_length());
+
+        let storage = Arc::new(storage);
+        let empty = Snapshot {
+            algorithm,
+            storage: storage.clone(),
+            offset: 0,
+            size: 0,
+            spine: unsafe { storage.spine(algorithm, 0) }
+        };
+        let mut writer = Writer {
+            algorithm,
+            storage,
+            offset: 0,
+            size: 0,
+            current: Arc::new(Current::new(empty))
+        };
+        writer.insert_batch(leaves);
+        writer
+    }
+
+    pub fn algorithm(&self) -> Algorithm {
+        self.algorithm
+    }
+
+    /// Number of leaves inserted, flushed ones included.
+    pub fn len(&self) -> u64 {
+        self.size
+    }
+
+    pub fn insert(&mut self, leaf: &[u8]) {
+        assert_eq!(leaf.len(), self.algorithm.hash_length());
+        self.insert_batch(leaf);
+    }
+
+    /// Appends the leaves laid out back to back in `leaves` and publishes one
+    /// snapshot for all of them; the new nodes of a level are hashed as by
+    /// `Tree::insert_batch`.
+    pub fn insert_batch(&mut self, leaves: &[u8]) {
+        self.size = unsafe { self.storage.append(self.algorithm, self.size, leaves) };
+        self.publish();
+    }
+
+    /// Drops the leaves before `idx` and the nodes only they need; `idx` stays.
+    /// Snapshots taken before keep them.
+    pub fn flush_to(&mut self, idx: u64) {
+        assert!(self.offset <= idx && idx < self.size);
+
+        let mut lo = [0; LEVELS];
+        for (lv, lo) in lo.iter_mut().enumerate() {
+            *lo = (idx >> lv) & !1;
+        }
+        self.storage = Arc::new(self.storage.share(&lo, &[u64::max_value(); LEVELS]));
+        self.offset = idx;
+        self.publish();
+    }
+
+    /// Drops the leaves after `idx`; `idx` stays. Snapshots taken before keep
+    /// them.
+    pub fn retract_to(&mut self, idx: u64) {
+        assert!(self.offset <= idx && idx < self.size);
+
+        let mut hi = [0; LEVELS];
+        for (lv, hi) in hi.iter_mut().enumerate() {
+            *hi = (idx + 1) >> lv;
+        }
+        self.storage = Arc::new(self.storage.share(&[0; LEVELS], &hi));
+        self.size = idx + 1;
+        self.publish();
+    }
+
+    /// The latest snapshot.
+    pub fn snapshot(&self) -> Arc<Snapshot> {
+        unsafe { self.current.snapshot() }
+    }
+
+    /// A handle other threads take snapshots from.
+    pub fn reader(&self) -> Reader {
+        Reader::new(self.current.clone())
+    }
+
+    /// Computes the root and right-hand side and makes them the current
+    /// snapshot.
+    fn publish(&mut self) {
+        let snapshot = Arc::new(Snapshot {
+            algorithm: self.algorithm,
+            storage: self.storage.clone(),
+            offset: self.offset,
+            size: self.size,
+            spine: unsafe { self.storage.spine(self.algorithm, self.size) }
+        });
+
+        let current = &*self.current;
+        let old = current.latest.swap(Arc::into_raw(snapshot) as *mut Snapshot, Ordering::SeqCst);
+
+        // a reader that announced a replaced snapshot only reads it if it did so
+        // before the swap, so the slot shows it now; a later one reads the new
+        // snapshot instead
+        let mut retired = current.retired.lock().unwrap();
+        retired.push(unsafe { Arc::from_raw(old) });
+        retired.retain(|snapshot| current.slots.announce(&**snapshot));
+    }
+}
+
+/// Takes snapshots of a `Writer`'s log from any thread.
+pub struct Reader {
+    current: Arc<Current>,
+    /// First slot to try; each reader starts at its own, so that readers on
+    /// different threads do not contend for one.
+    hint: usize
+}
+
+impl Reader {
+    fn new(current: Arc<Current>) -> Reader {
+        let hint = current.hints.fetch_add(1, Ordering::Relaxed);
+        Reader { current, hint }
+    }
+
+    /// The latest snapshot the writer published, pinned until the guard is
+    /// dropped. Cheaper than `snapshot`, which adds to a reference count every
+    /// reader of the same snapshot shares.
+    pub fn pin(&self) -> Pinned<'_> {
+        let current = &*self.current;
+        let slot = current.slots.take(self.hint);
+        let mut snapshot = current.latest.load(Ordering::Acquire);
+
+        loop {
+            slot.store(snapshot, Ordering::SeqCst);
+            let latest = current.latest.load(Ordering::SeqCst);
+            if latest == snapshot {
+                break;
+            }
+            snapshot = latest;
+        }
+
+        Pinned { slot, snapshot: unsafe { &*snapshot } }
+    }
+
+    /// The latest snapshot the writer published.
+    pub fn snapshot(&self) -> Arc<Snapshot> {
+        let pinned = self.pin();
+        unsafe { clone(pinned.snapshot) }
+    }
+}
+
+impl Clone for Reader {
+    fn clone(&self) -> Reader {
+        Reader::new(self.current.clone())
+    }
+}
+
+/// A snapshot a `Reader` pinned.
+pub struct Pinned<'a> {
+    slot: &'a AtomicPtr<Snapshot>,
+    snapshot: &'a Snapshot
+}
+
+impl<'a> Deref for Pinned<'a> {
+    type Target = Snapshot;
+
+    fn deref(&self) -> &Snapshot {
+        self.snapshot
+    }
+}
+
+impl<'a> Drop for Pinned<'a> {
+    fn drop(&mut self) {
+        self.slot.store(ptr::null_mut(), Ordering::Release);
+    }
+}
+
+/// The log as of one change; never changes itself.
+pub struct Snapshot {
+    algorithm: Algorithm,
+    storage: Arc<Storage>,
+    offset: u64,
+    size: u64,
+    spine: Spine
+}
+
+impl Snapshot {
+    pub fn algorithm(&self) -> Algorithm {
+        self.algorithm
+    }
+
+    /// Number of leaves, flushed ones included.
+    pub fn len(&self) -> u64 {
+        self.size
+    }
+
+    /// First leaf not flushed.
+    pub fn offset(&self) -> u64 {
+        self.offset
+    }
+
+    pub fn root(&self) -> &[u8] {
+        self.spine.root(self.algorithm.hash_length())
+    }
+
+    /// Sibling hashes from leaf `idx` up to the root; `idx` must not be flushed.
+    pub fn path(&self, idx: u64) -> Vec<Vec<u8>> {
+        self.multiproof(&[idx]).nodes().map(|node| node.to_vec()).collect()
+    }
+
+    /// As `Tree::multiproof`.
+    pub fn multiproof(&self, indices: &[u64]) -> MultiProof {
+        assert!(!indices.is_empty());
+        assert!(indices[0] >= self.offset);
+        assert!(indices[indices.len() - 1] < self.size);
+
+        unsafe { self.storage.multiproof(&self.spine, self.size, indices) }
+    }
+
+    /// As `Tree::consistency`: the proof from `old_size` leaves to this
+    /// snapshot's size.
+    pub fn consistency(&self, old_size: u64) -> ConsistencyProof {
+        assert!(self.offset < old_size && old_size <= self.size);
+
+        unsafe { self.storage.consistency(&self.spine, self.size, old_size) }
+    }
+
+    /// Checks `proof` for `leaves`, laid out back to back, at `indices` against
+    /// this snapshot's size and root.
+    pub fn verify(&self, indices: &[u64], leaves: &[u8], proof: &MultiProof) -> bool {
+        proof.verify(self.algorithm, self.size, indices, leaves, self.root())
+    }
+}
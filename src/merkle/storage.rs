@@ -0,0 +1,569 @@
+//! Level storage of a `Tree`, or shared by a `Writer` and its snapshots.
+//!
+//! Each level is a directory of fixed-size segments that never move once
+//! allocated, so the writer can append to a level while readers hold pointers
+//! into it: a snapshot of `size` leaves only reads the `size >> lv` complete nodes
+//! of level `lv`, and the writer only writes past them. Flushing and retracting
+//! instead build a new `Storage` that shares the segments it keeps (copying the
+//! one a retraction cuts), so older snapshots keep theirs.
+//!
+//! The directory is a trie of `FANOUT`-way nodes that storages share: a new
+//! storage copies only the nodes on the path to either end of what it keeps, so
+//! a flush or retraction costs the height of the trie rather than a pass over
+//! every segment, and the segments it drops are freed with the last storage
+//! that holds them.
+//!
+//! On Unix the segments of the lowest levels, which hold nearly all nodes, can
+//! live in files instead (see `mapped`), for trees larger than memory.
+
+use core::{ mem, ptr };
+use core::sync::atomic::{ AtomicPtr, Ordering };
+use std::boxed::Box;
+use std::sync::Arc;
+use std::vec::Vec;
+#[cfg(unix)]
+use std::sync::Mutex;
+use hacl_star_sys::merkle::mt_hash_pairs;
+use super::{ Algorithm, MultiProof, ConsistencyProof, MAX_HASH_LENGTH, prove };
+use super::consistency;
+#[cfg(unix)]
+use super::mapped::{ Backing, Extent };
+
+
+/// Levels of a tree of up to `u64::MAX` leaves.
+pub const LEVELS: usize = 64;
+
+/// Nodes of segment 0; segments 1 to 6 double up to `SEGMENT`, so small trees
+/// stay small, and every later segment holds `SEGMENT` nodes.
+const FIRST: u64 = 16;
+const SEGMENT: u64 = FIRST << 6;
+
+/// Segment index bits resolved by a directory node, which has `FANOUT` entries.
+const FANOUT_BITS: u32 = 6;
+const FANOUT: usize = 1 << FANOUT_BITS;
+
+/// Segment holding node `k`, with the first node of that segment and its length.
+fn segment_of(k: u64) -> (u64, u64, u64) {
+    if k < FIRST {
+        (0, 0, FIRST)
+    } else if k < SEGMENT {
+        let s = (64 - k.leading_zeros() - FIRST.trailing_zeros()) as u64;
+        let start = FIRST << (s - 1);
+        (s, start, start)
+    } else {
+        (6 + k / SEGMENT, k / SEGMENT * SEGMENT, SEGMENT)
+    }
+}
+
+fn segment_start(s: u64) -> (u64, u64) {
+    match s {
+        0 => (0, FIRST),
+        1..=6 => (FIRST << (s - 1), FIRST << (s - 1)),
+        _ => ((s - 6) * SEGMENT, SEGMENT)
+    }
+}
+
+/// Segments under a directory node of `height`.
+fn span(height: u32) -> u64 {
+    1 << (FANOUT_BITS * (height + 1))
+}
+
+/// Another reference to the `Arc` behind `ptr`.
+unsafe fn retain<T>(ptr: *const T) -> *mut T {
+    let arc = Arc::from_raw(ptr);
+    mem::forget(arc.clone());
+    Arc::into_raw(arc) as *mut T
+}
+
+struct Segment {
+    ptr: *mut u8,
+    len: usize,
+    /// The mapping the segment lies in, if file-backed.
+    #[cfg(unix)]
+    extent: Option<Arc<Extent>>
+}
+
+impl Segment {
+    fn new(len: usize) -> Segment {
+        let mut buf = mem::ManuallyDrop::new(std::vec![0; len].into_boxed_slice());
+        Segment {
+            ptr: buf.as_mut_ptr(),
+            len,
+            #[cfg(unix)]
+            extent: None
+        }
+    }
+}
+
+impl Drop for Segment {
+    fn drop(&mut self) {
+        #[cfg(unix)]
+        {
+            if self.extent.is_some() {
+                return;
+            }
+        }
+        unsafe { drop(Vec::from_raw_parts(self.ptr, self.len, self.len)) }
+    }
+}
+
+/// Directory node: `Arc<Node>` pointers to the nodes of `height - 1` below it,
+/// or at height 0 `Arc<Segment>` pointers; null where nothing is stored. Entry
+/// `i` of a node whose first segment is `base` covers the segments from
+/// `base + i * span(height - 1)` on.
+struct Node {
+    height: u32,
+    entries: Box<[AtomicPtr<()>]>
+}
+
+impl Node {
+    /// An empty node, as an `Arc` pointer.
+    fn new(height: u32) -> *mut Node {
+        let entries = (0..FANOUT)
+            .map(|_| AtomicPtr::new(ptr::null_mut()))
+            .collect::<Vec<_>>()
+            .into_boxed_slice();
+        Arc::into_raw(Arc::new(Node { height, entries })) as *mut Node
+    }
+
+    fn entry(&self, s: u64) -> &AtomicPtr<()> {
+        &self.entries[(s >> (FANOUT_BITS * self.height)) as usize % FANOUT]
+    }
+}
+
+impl Drop for Node {
+    fn drop(&mut self) {
+        for entry in self.entries.iter() {
+            let ptr = entry.load(Ordering::Acquire);
+            if ptr.is_null() {
+                continue;
+            }
+
+            unsafe {
+                if self.height == 0 {
+                    drop(Arc::from_raw(ptr as *const Segment));
+                } else {
+                    drop(Arc::from_raw(ptr as *const Node));
+                }
+            }
+        }
+    }
+}
+
+pub struct Storage {
+    hash_length: usize,
+    /// Directory root of each level, an `Arc<Node>` pointer allocated on first
+    /// use and replaced by a higher one as the level grows.
+    roots: Box<[AtomicPtr<Node>]>,
+    #[cfg(unix)]
+    backing: Option<Arc<Mutex<Backing>>>
+}
+
+impl Storage {
+    pub fn new(hash_length: usize) -> Storage {
+        let roots = (0..LEVELS)
+            .map(|_| AtomicPtr::new(ptr::null_mut()))
+            .collect::<Vec<_>>()
+            .into_boxed_slice();
+        Storage {
+            hash_length,
+            roots,
+            #[cfg(unix)]
+            backing: None
+        }
+    }
+
+    /// Storage whose cold levels are in `backing`.
+    #[cfg(unix)]
+    pub fn mapped(hash_length: usize, backing: Backing) -> Storage {
+        let mut storage = Storage::new(hash_length);
+        storage.backing = Some(Arc::new(Mutex::new(backing)));
+        storage
+    }
+
+    /// A segment for nodes `start..start + len` of level `lv`, zeroed.
+    fn allocate(&self, lv: usize, start: u64, len: u64) -> Segment {
+        #[cfg(unix)]
+        {
+            if let Some(ref backing) = self.backing {
+                let mut backing = backing.lock().unwrap();
+                if backing.is_cold(lv) {
+                    // nothing to report an error to, as with a failed allocation
+                    let (extent, offset) = backing.extent(lv, start, self.hash_length)
+                        .expect("cannot map Merkle tree storage");
+                    return Segment {
+                        ptr: extent.at(offset),
+                        len: len as usize * self.hash_length,
+                        extent: Some(extent)
+                    };
+                }
+            }
+        }
+
+        Segment::new(len as usize * self.hash_length)
+    }
+
+    /// The directory entry of segment `s` of level `lv`, creating the nodes on
+    /// the way. Only the writer may call it.
+    fn entry(&self, lv: usize, s: u64) -> &AtomicPtr<()> {
+        let root = &self.roots[lv];
+        let mut node = root.load(Ordering::Acquire);
+
+        unsafe {
+            if node.is_null() {
+                node = Node::new(0);
+                root.store(node, Ordering::Release);
+            }
+            while s >= span((*node).height) {
+                let parent = Node::new((*node).height + 1);
+                (*parent).entries[0].store(node as *mut (), Ordering::Relaxed);
+                root.store(parent, Ordering::Release);
+                node = parent;
+            }
+
+            while (*node).height > 0 {
+                let entry = (*node).entry(s);
+                let mut child = entry.load(Ordering::Acquire);
+                if child.is_null() {
+                    child = Node::new((*node).height - 1) as *mut ();
+                    entry.store(child, Ordering::Release);
+                }
+                node = child as *mut Node;
+            }
+
+            (*node).entry(s)
+        }
+    }
+
+    fn segment(&self, lv: usize, s: u64) -> *const Segment {
+        let mut node = self.roots[lv].load(Ordering::Acquire) as *const Node;
+
+        unsafe {
+            if node.is_null() || s >= span((*node).height) {
+                return ptr::null();
+            }
+            loop {
+                let ptr = (*node).entry(s).load(Ordering::Acquire);
+                if (*node).height == 0 || ptr.is_null() {
+                    return ptr as *const Segment;
+                }
+                node = ptr as *const Node;
+            }
+        }
+    }
+
+    /// Node `k` of level `lv`, which must have been written before the caller
+    /// learnt of it (e.g. through the snapshot that holds it).
+    pub unsafe fn node(&self, lv: usize, k: u64) -> &[u8] {
+        let (ptr, _) = self.run(lv, k, 1);
+        core::slice::from_raw_parts(ptr, self.hash_length)
+    }
+
+    /// Nodes `k..k + m` of level `lv` are contiguous at the pointer, for the
+    /// returned `m <= n`; same condition as `node`.
+    pub unsafe fn run(&self, lv: usize, k: u64, n: u64) -> (*const u8, u64) {
+        let (s, start, len) = segment_of(k);
+        let segment = self.segment(lv, s);
+        assert!(!segment.is_null());
+        let m = n.min(start + len - k);
+        ((*segment).ptr.add((k - start) as usize * self.hash_length), m)
+    }
+
+    /// `run` for writing, allocating the segment if needed. Only the writer may
+    /// call it, and only for nodes no snapshot can read yet.
+    pub unsafe fn run_mut(&self, lv: usize, k: u64, n: u64) -> (*mut u8, u64) {
+        let (s, start, len) = segment_of(k);
+        let entry = self.entry(lv, s);
+        let mut segment = entry.load(Ordering::Acquire) as *mut Segment;
+
+        if segment.is_null() {
+            let new = Arc::new(self.allocate(lv, start, len));
+            segment = Arc::into_raw(new) as *mut Segment;
+            entry.store(segment as *mut (), Ordering::Release);
+        }
+
+        let m = n.min(start + len - k);
+        ((*segment).ptr.add((k - start) as usize * self.hash_length), m)
+    }
+
+    /// A storage holding the nodes `lo[lv]..hi[lv]` of each level: the segments
+    /// in that range are shared, and one holding both sides of `hi[lv]` is copied,
+    /// so the writer of the new storage can fill it past `hi[lv]` again.
+    pub fn share(&self, lo: &[u64; LEVELS], hi: &[u64; LEVELS]) -> Storage {
+        #[allow(unused_mut)]
+        let mut shared = Storage::new(self.hash_length);
+
+        #[cfg(unix)]
+        {
+            // nodes past a cut are written again, so into files of their own
+            shared.backing = self.backing.as_ref().map(|backing| {
+                if hi.iter().all(|&hi| hi == u64::max_value()) {
+                    backing.clone()
+                } else {
+                    Arc::new(Mutex::new(backing.lock().unwrap().fresh()))
+                }
+            });
+        }
+
+        for lv in 0..LEVELS {
+            let root = self.roots[lv].load(Ordering::Acquire);
+            if root.is_null() || lo[lv] >= hi[lv] {
+                continue;
+            }
+
+            let keep = Keep::new(lo[lv], hi[lv]);
+            let root = unsafe { shared.share_node(lv, root, 0, &keep) };
+            shared.roots[lv].store(root as *mut Node, Ordering::Release);
+        }
+
+        shared
+    }
+
+    /// The part of `node`, whose first segment is `base`, that `keep` covers: the
+    /// node itself if it covers all of it, else a copy of the node with the
+    /// entries outside `keep` left out and those across its ends shared in turn.
+    unsafe fn share_node(&self, lv: usize, node: *const Node, base: u64, keep: &Keep) -> *mut () {
+        let height = (*node).height;
+        if keep.first <= base && base + span(height) <= keep.whole {
+            return retain(node) as *mut ();
+        }
+
+        let copy = Node::new(height);
+        let step = span(height) >> FANOUT_BITS;
+        for (i, entry) in (*node).entries.iter().enumerate() {
+            let ptr = entry.load(Ordering::Acquire);
+            let first = base + i as u64 * step;
+            if ptr.is_null() || first + step <= keep.first || first >= keep.end {
+                continue;
+            }
+
+            let ptr = if height > 0 {
+                self.share_node(lv, ptr as *const Node, first, keep)
+            } else if first < keep.whole {
+                retain(ptr as *const Segment) as *mut ()
+            } else {
+                // the segment holding both sides of `hi`
+                let segment = ptr as *const Segment;
+                let (start, len) = segment_start(first);
+                let cut = self.allocate(lv, start, len);
+                let keep = (keep.hi - start) as usize * self.hash_length;
+                ptr::copy_nonoverlapping((*segment).ptr, cut.ptr, keep);
+                Arc::into_raw(Arc::new(cut)) as *mut ()
+            };
+            (*copy).entries[i].store(ptr, Ordering::Relaxed);
+        }
+
+        copy as *mut ()
+    }
+}
+
+/// The segments of a level a shared storage keeps, for the nodes `lo..hi`.
+struct Keep {
+    /// Segment of `lo`.
+    first: u64,
+    /// End of the segments kept whole.
+    whole: u64,
+    /// End of the segments kept, `whole` or past the one `hi` cuts.
+    end: u64,
+    hi: u64
+}
+
+impl Keep {
+    fn new(lo: u64, hi: u64) -> Keep {
+        let first = segment_of(lo).0;
+        if hi == u64::max_value() {
+            return Keep { first, whole: u64::max_value(), end: u64::max_value(), hi };
+        }
+
+        let (s, start, _) = segment_of(hi);
+        let end = if start < hi { s + 1 } else { s };
+        Keep { first, whole: s, end, hi }
+    }
+}
+
+/// The root of the first `size` leaves of a storage, and the partial node at
+/// the end of each level, where it is a sibling (HACL*'s `rhs`).
+pub struct Spine {
+    root: [u8; MAX_HASH_LENGTH],
+    rhs: Vec<u8>
+}
+
+impl Spine {
+    pub fn root(&self, hash_length: usize) -> &[u8] {
+        &self.root[..hash_length]
+    }
+}
+
+impl Storage {
+    /// Writes `leaves`, laid out back to back, after the first `size` leaves,
+    /// and the complete nodes they add above, a level at a time through
+    /// `mt_hash_pairs`; returns the new size. Only the writer may call it.
+    pub unsafe fn append(&self, algorithm: Algorithm, size: u64, leaves: &[u8]) -> u64 {
+        let len = self.hash_length;
+        assert_eq!(leaves.len() % len, 0);
+
+        let j0 = size;
+        let j1 = j0.checked_add((leaves.len() / len) as u64).expect("too many leaves");
+        let kernel = algorithm.kernel();
+
+        let mut k = j0;
+        while k < j1 {
+            let (dst, m) = self.run_mut(0, k, j1 - k);
+            let src = &leaves[((k - j0) as usize * len)..][..m as usize * len];
+            ptr::copy_nonoverlapping(src.as_ptr(), dst, src.len());
+            k += m;
+        }
+
+        let mut lv = 0;
+        while lv + 1 < LEVELS && j0 >> (lv + 1) < j1 >> (lv + 1) {
+            let (mut p, p1) = (j0 >> (lv + 1), j1 >> (lv + 1));
+
+            // children and parents are contiguous within a segment, and a pair
+            // never spans two since segments start at even nodes
+            while p < p1 {
+                let (src, pairs) = self.run(lv, 2 * p, 2 * (p1 - p));
+                let (dst, m) = self.run_mut(lv + 1, p, pairs / 2);
+                mt_hash_pairs(&kernel, len as u32, m as u32, src as *mut u8, dst);
+                p += m;
+            }
+            lv += 1;
+        }
+
+        j1
+    }
+
+    /// The spine of the first `size` leaves, at one compression per level whose
+    /// node count is odd, as HACL*'s `construct_rhs`.
+    pub unsafe fn spine(&self, algorithm: Algorithm, size: u64) -> Spine {
+        let len = self.hash_length;
+        let levels = 64 - size.leading_zeros() as usize;
+        let mut rhs = std::vec![0; levels * len];
+        let mut acc = [0; MAX_HASH_LENGTH];
+        let mut actd = false;
+
+        for lv in 0..levels {
+            let w = size >> lv;
+            if w % 2 == 0 {
+                continue;
+            }
+
+            let node = self.node(lv, w - 1);
+            if actd {
+                // the partial node at w, whose sibling is the complete w - 1
+                rhs[lv * len..][..len].copy_from_slice(&acc[..len]);
+                let mut parent = [0; MAX_HASH_LENGTH];
+                algorithm.node(node, &acc[..len], &mut parent[..len]);
+                acc = parent;
+            } else {
+                acc[..len].copy_from_slice(node);
+                actd = true;
+            }
+        }
+
+        Spine { root: acc, rhs }
+    }
+
+    /// The multiproof for `indices` among the first `size` leaves, whose spine
+    /// is `spine`.
+    pub unsafe fn multiproof(&self, spine: &Spine, size: u64, indices: &[u64]) -> MultiProof {
+        prove(self.hash_length, size, indices.to_vec(), |lv, k| self.node_or_rhs(spine, size, lv, k))
+    }
+
+    /// The consistency proof from `old` leaves to the first `size`, whose spine
+    /// is `spine`.
+    pub unsafe fn consistency(&self, spine: &Spine, size: u64, old: u64) -> ConsistencyProof {
+        consistency::prove(self.hash_length, size, old, |lv, k| self.node_or_rhs(spine, size, lv, k))
+    }
+
+    /// Node `k` of level `lv` among the first `size` leaves: complete, or the
+    /// partial node at the end of the level, where the spine has it.
+    unsafe fn node_or_rhs<'a>(&'a self, spine: &'a Spine, size: u64, lv: u32, k: u64) -> &'a [u8] {
+        let len = self.hash_length;
+        if k < size >> lv {
+            self.node(lv as usize, k)
+        } else {
+            &spine.rhs[lv as usize * len..][..len]
+        }
+    }
+}
+
+impl Drop for Storage {
+    fn drop(&mut self) {
+        for root in self.roots.iter() {
+            let root = root.load(Ordering::Acquire);
+            if !root.is_null() {
+                unsafe { drop(Arc::from_raw(root)) }
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_segment_of() {
+        let mut k = 0;
+        for s in 0..20 {
+            let (start, len) = segment_start(s);
+            assert_eq!(start, k);
+            assert_eq!(segment_of(start), (s, start, len));
+            assert_eq!(segment_of(start + len - 1), (s, start, len));
+            k += len;
+        }
+        assert_eq!(segment_of(u64::max_value()).0, 6 + u64::max_value() / SEGMENT);
+
+        assert!(6 + u64::max_value() / SEGMENT < span(9));
+    }
+
+    /// A flush or retraction shares every directory node off the paths to the
+    /// ends of what it keeps.
+    #[test]
+    fn test_share_nodes() {
+        let storage = Storage::new(1);
+        let n = span(1) + 3;
+        unsafe {
+            for s in 0..n {
+                let (start, _) = segment_start(s);
+                storage.run_mut(0, start, 1).0.write(s as u8);
+            }
+        }
+
+        let root = storage.roots[0].load(Ordering::Acquire);
+        let child = |root: *mut Node, i: usize| unsafe { (*root).entries[i].load(Ordering::Acquire) };
+        assert_eq!(unsafe { (*root).height }, 2);
+
+        let mut lo = [0; LEVELS];
+        lo[0] = segment_start(FANOUT as u64 * 5 + 7).0;
+        let flushed = storage.share(&lo, &[u64::max_value(); LEVELS]);
+        let top = child(flushed.roots[0].load(Ordering::Acquire), 0) as *mut Node;
+        assert!(child(top, 4).is_null());
+        assert_ne!(child(top, 5), child(child(root, 0) as *mut Node, 5));
+        assert_eq!(child(top, 6), child(child(root, 0) as *mut Node, 6));
+        assert_eq!(
+            child(flushed.roots[0].load(Ordering::Acquire), 1),
+            child(root, 1)
+        );
+
+        let mut hi = [0; LEVELS];
+        hi[0] = segment_start(FANOUT as u64 * 9 + 2).0 + 1;
+        let retracted = flushed.share(&[0; LEVELS], &hi);
+        let top = child(retracted.roots[0].load(Ordering::Acquire), 0) as *mut Node;
+        assert_eq!(child(top, 8), child(child(root, 0) as *mut Node, 8));
+        assert!(child(top, 10).is_null());
+        assert!(child(retracted.roots[0].load(Ordering::Acquire), 1).is_null());
+
+        unsafe {
+            for s in 0..n {
+                let (start, _) = segment_start(s);
+                let kept = s >= FANOUT as u64 * 5 + 7 && s <= FANOUT as u64 * 9 + 2;
+                assert_eq!(!retracted.segment(0, s).is_null(), kept);
+                if kept {
+                    assert_eq!(retracted.node(0, start)[0], s as u8);
+                }
+                assert_eq!(storage.node(0, start)[0], s as u8);
+            }
+        }
+    }
+}
@@ -2,6 +2,41 @@ use hacl_star_sys as ffi;
 use crate::And;
 
 
+/// `crypto_secretbox_detached` with the Salsa20 and Poly1305 kernels of
+/// `ffi::dispatch::table()`; `c` may be `m`.
+unsafe fn secretbox_detached(c: *mut u8, mac: *mut u8, m: *const u8, len: usize, nonce: &[u8], key: &[u8]) {
+    let table = ffi::dispatch::table();
+
+    ffi::nacl::Hacl_NaCl_Dispatch_secretbox_detached(
+        Some(table.salsa20_xor),
+        Some(table.nacl_poly1305_mac),
+        c,
+        mac,
+        m as _,
+        len as _,
+        nonce.as_ptr() as _,
+        key.as_ptr() as _
+    );
+}
+
+/// `crypto_secretbox_open_detached` with the kernels of `ffi::dispatch::table()`;
+/// `m` may be `c`, and is left untouched if `mac` does not verify.
+unsafe fn secretbox_open_detached(m: *mut u8, c: *const u8, mac: *const u8, len: usize, nonce: &[u8], key: &[u8]) -> bool {
+    let table = ffi::dispatch::table();
+
+    ffi::nacl::Hacl_NaCl_Dispatch_secretbox_open_detached(
+        Some(table.salsa20_xor),
+        Some(table.nacl_poly1305_mac),
+        m,
+        c as _,
+        mac as _,
+        len as _,
+        nonce.as_ptr() as _,
+        key.as_ptr() as _
+    ) == 0
+}
+
+
 pub mod secret {
     use super::*;
 
@@ -25,38 +60,47 @@ pub mod secret {
 
     impl<'a> SecretBox<'a> {
         pub fn seal(self, m: &[u8], c: &mut [u8], mac: &mut [u8; MAC_LENGTH]) {
-            assert!(c.len() > 32);
             assert_eq!(c.len(), m.len());
+            assert!(m.len() <= u32::max_value() as usize);
 
             let And(Key(key), Nonce(nonce)) = self;
 
             unsafe {
-                ffi::nacl::NaCl_crypto_secretbox_detached(
-                    c.as_mut_ptr(),
-                    mac.as_mut_ptr(),
-                    m.as_ptr() as _,
-                    (m.len() - 32) as _,
-                    nonce.as_ptr() as _,
-                    key.as_ptr() as _
-                );
+                secretbox_detached(c.as_mut_ptr(), mac.as_mut_ptr(), m.as_ptr(), m.len(), nonce, key);
             }
         }
 
         pub fn open(self, m: &mut [u8], c: &[u8], mac: &[u8; MAC_LENGTH]) -> bool {
-            assert!(c.len() > 32);
             assert_eq!(c.len(), m.len());
+            assert!(c.len() <= u32::max_value() as usize);
+
+            let And(Key(key), Nonce(nonce)) = self;
+
+            unsafe {
+                secretbox_open_detached(m.as_mut_ptr(), c.as_ptr(), mac.as_ptr(), c.len(), nonce, key)
+            }
+        }
+
+        /// `seal` with the message and ciphertext in the same buffer.
+        pub fn seal_in_place(self, buf: &mut [u8], mac: &mut [u8; MAC_LENGTH]) {
+            assert!(buf.len() <= u32::max_value() as usize);
+
+            let And(Key(key), Nonce(nonce)) = self;
+
+            unsafe {
+                secretbox_detached(buf.as_mut_ptr(), mac.as_mut_ptr(), buf.as_ptr(), buf.len(), nonce, key);
+            }
+        }
+
+        /// `open` with the ciphertext and message in the same buffer, which is left
+        /// untouched if `mac` does not verify.
+        pub fn open_in_place(self, buf: &mut [u8], mac: &[u8; MAC_LENGTH]) -> bool {
+            assert!(buf.len() <= u32::max_value() as usize);
 
             let And(Key(key), Nonce(nonce)) = self;
 
             unsafe {
-                ffi::nacl::NaCl_crypto_secretbox_open_detached(
-                    m.as_mut_ptr(),
-                    c.as_ptr() as _,
-                    mac.as_ptr() as _,
-                    (c.len() - 32) as _,
-                    nonce.as_ptr() as _,
-                    key.as_ptr() as _
-                ) == 0
+                secretbox_open_detached(buf.as_mut_ptr(), buf.as_mut_ptr(), mac.as_ptr(), buf.len(), nonce, key)
             }
         }
     }
@@ -90,44 +134,58 @@ pub mod sealed {
         pub fn nonce(&self, n: &'a [u8; NONCE_LENGTH]) -> SealedBox<'a> {
             And(And(self.0, self.1), secret::nonce(n))
         }
+
+        /// The shared key of `crypto_box_beforenm`, or `None` if the public key is a
+        /// low-order point.
+        ///
+        /// A box is a secretbox under this key, so sealing many messages for the same
+        /// peer through `secret::SecretBox` skips the X25519 of every `seal`.
+        pub fn precompute(&self) -> Option<secret::Key> {
+            let And(SecretKey(sk), PublicKey(pk)) = self;
+            let mut key = [0; secret::KEY_LENGTH];
+
+            let r = unsafe {
+                ffi::nacl::Hacl_NaCl_crypto_box_beforenm(
+                    key.as_mut_ptr(),
+                    pk.as_ptr() as _,
+                    sk.as_ptr() as _
+                )
+            };
+
+            if r == 0 {
+                Some(secret::Key(key))
+            } else {
+                None
+            }
+        }
     }
 
     impl<'a> SealedBox<'a> {
-        pub fn seal(self, m: &[u8], c: &mut [u8], mac: &mut [u8; MAC_LENGTH]) {
-            assert!(c.len() > 32);
+        /// Returns `false`, and writes nothing, if the public key is a low-order point.
+        pub fn seal(self, m: &[u8], c: &mut [u8], mac: &mut [u8; MAC_LENGTH]) -> bool {
             assert_eq!(m.len(), c.len());
+            assert!(m.len() <= u32::max_value() as usize);
 
-            let And(And(SecretKey(sk), PublicKey(pk)), Nonce(nonce)) = self;
+            let And(pre, Nonce(nonce)) = self;
 
-            unsafe {
-                ffi::nacl::NaCl_crypto_box_detached(
-                    c.as_mut_ptr(),
-                    mac.as_mut_ptr(),
-                    m.as_ptr() as _,
-                    (m.len() - 32) as _,
-                    nonce.as_ptr() as _,
-                    pk.as_ptr() as _,
-                    sk.as_ptr() as _
-                );
+            match pre.precompute() {
+                Some(key) => {
+                    key.nonce(nonce).seal(m, c, mac);
+                    true
+                },
+                None => false
             }
         }
 
         pub fn open(self, m: &mut [u8], c: &[u8], mac: &[u8; MAC_LENGTH]) -> bool {
-            assert!(c.len() > 32);
             assert_eq!(m.len(), c.len());
+            assert!(c.len() <= u32::max_value() as usize);
 
-            let And(And(SecretKey(sk), PublicKey(pk)), Nonce(nonce)) = self;
+            let And(pre, Nonce(nonce)) = self;
 
-            unsafe {
-                ffi::nacl::NaCl_crypto_box_open_detached(
-                    m.as_mut_ptr(),
-                    c.as_ptr() as _,
-                    mac.as_ptr() as _,
-                    (c.len() - 32) as _,
-                    nonce.as_ptr() as _,
-                    pk.as_ptr() as _,
-                    sk.as_ptr() as _
-                ) == 0
+            match pre.precompute() {
+                Some(key) => key.nonce(nonce).open(m, c, mac),
+                None => false
             }
         }
     }
@@ -1,17 +1,70 @@
 use hacl_star_sys as ffi;
+use ffi::poly1305::{
+    Lib_IntVector_Intrinsics_vec128 as Vec128,
+    Lib_IntVector_Intrinsics_vec256 as Vec256
+};
+
+
+/// Largest vector batch of any backend (4 blocks for `Vec256`).
+const BUFFER_LENGTH: usize = 64;
+
+/// Largest single kernel call, kept a multiple of `BUFFER_LENGTH` and within `u32`.
+const CHUNK_LENGTH: usize = 1 << 30;
+
+/// Poly1305 kernel behind a `Poly1305` state.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Backend {
+    /// `Hacl_Poly1305_32`, available everywhere.
+    Portable,
+    /// Vale `x64_poly1305` assembly.
+    Vale,
+    /// `Hacl_Poly1305_128`, 2 blocks per step on AVX, NEON or wasm `simd128`.
+    Vec128,
+    /// `Hacl_Poly1305_256`, 4 blocks per step on AVX2.
+    Vec256
+}
+
+impl Backend {
+    /// Fastest backend supported by the running cpu, as chosen by `ffi::dispatch`.
+    pub fn detect() -> Backend {
+        match ffi::dispatch::table().poly1305 {
+            ffi::dispatch::Poly1305::Portable => Backend::Portable,
+            ffi::dispatch::Poly1305::Vale => Backend::Vale,
+            ffi::dispatch::Poly1305::Vec128 => Backend::Vec128,
+            ffi::dispatch::Poly1305::Vec256 => Backend::Vec256
+        }
+    }
+
+    pub fn is_available(self) -> bool {
+        let best = Backend::detect();
+
+        match self {
+            Backend::Portable => true,
+            Backend::Vale => cfg!(target_arch = "x86_64"),
+            Backend::Vec128 => best == Backend::Vec128 || best == Backend::Vec256,
+            Backend::Vec256 => best == Backend::Vec256
+        }
+    }
+}
 
+/// Kernel context, sized and aligned for 25 `vec256` limbs (the largest backend).
+#[repr(C, align(32))]
+#[derive(Clone)]
+struct Context([u64; 100]);
 
-#[derive(Default, Clone, Debug)]
-struct Inner {
-    r: [u64; 3],
-    h: [u64; 3]
+impl Context {
+    #[inline]
+    fn as_mut_ptr(&mut self) -> *mut u64 {
+        self.0.as_mut_ptr()
+    }
 }
 
-#[derive(Clone, Debug)]
+#[derive(Clone)]
 pub struct Poly1305 {
-    state: Inner,
-    key: [u8; 16],
-    block: [u8; 16],
+    backend: Backend,
+    ctx: Context,
+    key: [u8; 32],
+    block: [u8; BUFFER_LENGTH],
     pos: usize
 }
 
@@ -20,78 +73,138 @@ impl Poly1305 {
     pub const HASH_LENGTH: usize = 16;
 
     pub fn onetimeauth(output: &mut [u8; 16], input: &[u8], key: &[u8; 32]) {
-        unsafe {
-            ffi::poly1305::Hacl_Poly1305_64_crypto_onetimeauth(
-                output.as_mut_ptr(),
-                input.as_ptr() as _,
-                input.len() as _,
-                key.as_ptr() as _
-            );
-        }
+        let mut state = Poly1305::new(key);
+        state.update(input);
+        state.finish(output);
     }
 }
 
 impl Poly1305 {
+    #[inline]
     pub fn new(key: &[u8; 32]) -> Poly1305 {
-        let mut state = Inner::default();
+        Poly1305::with_backend(key, Backend::detect())
+    }
+
+    pub fn with_backend(key: &[u8; 32], backend: Backend) -> Poly1305 {
+        assert!(backend.is_available());
+
+        let mut state = Poly1305 {
+            backend,
+            ctx: Context([0; 100]),
+            key: *key,
+            block: [0; BUFFER_LENGTH],
+            pos: 0
+        };
 
         unsafe {
-            let state = ffi::poly1305::Hacl_Poly1305_64_mk_state(state.r.as_mut_ptr(), state.h.as_mut_ptr());
-            ffi::poly1305::Hacl_Poly1305_64_init(state, key.as_ptr() as _);
+            let ctx = state.ctx.as_mut_ptr();
+            let key = state.key.as_mut_ptr();
+
+            match backend {
+                Backend::Portable => ffi::poly1305::Hacl_Poly1305_32_poly1305_init(ctx, key),
+                Backend::Vale => (),
+                #[cfg(any(target_arch = "x86_64", target_arch = "aarch64", all(target_arch = "wasm32", target_feature = "simd128")))]
+                Backend::Vec128 => ffi::poly1305::Hacl_Poly1305_128_poly1305_init(ctx as *mut Vec128, key),
+                #[cfg(target_arch = "x86_64")]
+                Backend::Vec256 => ffi::poly1305::Hacl_Poly1305_256_poly1305_init(ctx as *mut Vec256, key),
+                #[allow(unreachable_patterns)]
+                _ => unreachable!()
+            }
         }
 
-        let mut key2 = [0; 16];
-        key2.copy_from_slice(&key[16..]);
+        state
+    }
 
-        Poly1305 {
-            state,
-            key: key2,
-            block: [0; 16],
-            pos: 0
-        }
+    #[inline]
+    pub fn backend(&self) -> Backend {
+        self.backend
     }
 
     pub fn update(&mut self, buf: &[u8]) {
-        let len = buf.len();
-        let br = Self::BLOCK_LENGTH - self.pos;
+        let mut buf = buf;
 
-        unsafe {
-            let state = ffi::poly1305::Hacl_Poly1305_64_mk_state(
-                self.state.r.as_mut_ptr(),
-                self.state.h.as_mut_ptr()
-            );
-
-            if len >= br {
-                self.block[self.pos..][..br].copy_from_slice(&buf[..br]);
-                ffi::poly1305::Hacl_Poly1305_64_update_block(state, self.block.as_ptr() as _);
-                self.pos = 0;
-            } else {
-                self.block[self.pos..][..len].copy_from_slice(buf);
-                self.pos += len;
+        if self.pos > 0 {
+            let take = core::cmp::min(BUFFER_LENGTH - self.pos, buf.len());
+            self.block[self.pos..][..take].copy_from_slice(&buf[..take]);
+            self.pos += take;
+            buf = &buf[take..];
+
+            if self.pos < BUFFER_LENGTH {
                 return;
             }
 
-            let buf = &buf[br..];
-            let len = buf.len();
-            let n = len / Self::BLOCK_LENGTH;
-            let r = len % Self::BLOCK_LENGTH;
-
-            ffi::poly1305::Hacl_Poly1305_64_update(state, buf.as_ptr() as _, n as _);
+            let block = self.block;
+            self.blocks(&block, false);
+            self.pos = 0;
+        }
 
-            self.block[..r].copy_from_slice(&buf[n * Self::BLOCK_LENGTH..][..r]);
-            self.pos = r;
+        // whole vector batches go straight from the caller's buffer
+        let n = buf.len() / BUFFER_LENGTH * BUFFER_LENGTH;
+        for chunk in buf[..n].chunks(CHUNK_LENGTH) {
+            self.blocks(chunk, false);
         }
+
+        let r = buf.len() - n;
+        self.block[..r].copy_from_slice(&buf[n..]);
+        self.pos = r;
     }
 
     pub fn finish(mut self, buf: &mut [u8; 16]) {
+        let block = self.block;
+        self.blocks(&block[..self.pos], true);
+
+        unsafe {
+            let ctx = self.ctx.as_mut_ptr();
+            let key = self.key.as_mut_ptr();
+
+            match self.backend {
+                Backend::Portable => ffi::poly1305::Hacl_Poly1305_32_poly1305_finish(buf.as_mut_ptr(), key, ctx),
+                Backend::Vale => buf.copy_from_slice(&self.ctx_bytes()[..16]),
+                #[cfg(any(target_arch = "x86_64", target_arch = "aarch64", all(target_arch = "wasm32", target_feature = "simd128")))]
+                Backend::Vec128 => ffi::poly1305::Hacl_Poly1305_128_poly1305_finish(buf.as_mut_ptr(), key, ctx as *mut Vec128),
+                #[cfg(target_arch = "x86_64")]
+                Backend::Vec256 => ffi::poly1305::Hacl_Poly1305_256_poly1305_finish(buf.as_mut_ptr(), key, ctx as *mut Vec256),
+                #[allow(unreachable_patterns)]
+                _ => unreachable!()
+            }
+        }
+    }
+
+    /// Absorbs `input`, which is whole 16-byte blocks unless `last` is set.
+    fn blocks(&mut self, input: &[u8], last: bool) {
+        debug_assert!(last || input.len() % Self::BLOCK_LENGTH == 0);
+
         unsafe {
-            let state = ffi::poly1305::Hacl_Poly1305_64_mk_state(
-                self.state.r.as_mut_ptr(),
-                self.state.h.as_mut_ptr()
-            );
+            let ctx = self.ctx.as_mut_ptr();
+            let len = input.len();
+            let input = input.as_ptr() as *mut u8;
+
+            match self.backend {
+                Backend::Portable => ffi::poly1305::Hacl_Poly1305_32_poly1305_update(ctx, len as _, input),
+                #[cfg(target_arch = "x86_64")]
+                Backend::Vale => {
+                    // the kernel consumes the key copy in its context, see `poly1305_vale`
+                    let key = self.key;
+                    self.ctx_bytes()[24..56].copy_from_slice(&key);
+                    ffi::poly1305::x64_poly1305(ctx as *mut u8, input, len as _, last as _);
+                },
+                #[cfg(any(target_arch = "x86_64", target_arch = "aarch64", all(target_arch = "wasm32", target_feature = "simd128")))]
+                Backend::Vec128 => ffi::poly1305::Hacl_Poly1305_128_poly1305_update(ctx as *mut Vec128, len as _, input),
+                #[cfg(target_arch = "x86_64")]
+                Backend::Vec256 => ffi::poly1305::Hacl_Poly1305_256_poly1305_update(ctx as *mut Vec256, len as _, input),
+                #[allow(unreachable_patterns)]
+                _ => unreachable!()
+            }
+        }
+    }
 
-            ffi::poly1305::Hacl_Poly1305_64_update_last(state, self.block.as_ptr() as _, self.pos as _);
-            ffi::poly1305::Hacl_Poly1305_64_finish(state, buf.as_mut_ptr(), self.key.as_ptr() as _);
+    #[inline]
+    fn ctx_bytes(&mut self) -> &mut [u8] {
+        unsafe {
+            core::slice::from_raw_parts_mut(
+                self.ctx.as_mut_ptr() as *mut u8,
+                core::mem::size_of::<Context>()
+            )
         }
     }
 }
@@ -1,6 +1,10 @@
 use hacl_star_sys as ffi;
+use crate::hash::Hash;
 
 
+/// Largest `n_blocks` handed to one `update_multi` call.
+const MAX_BLOCKS: usize = 1 << 20;
+
 macro_rules! sha2 {
     (
         pub struct $name:ident {
@@ -10,18 +14,21 @@ macro_rules! sha2 {
 
         const HASH_LENGTH = $outlen:expr;
 
-        impl $hash:path;
         impl $init:path;
-        impl $update:path;
-        impl $update_multi:path;
+        impl $update_multi:expr;
         impl $update_last:path;
         impl $finish:path;
+        impl $prev_len:path;
     ) => {
+        /// The compression function is picked when the state is created, so each
+        /// `update` costs one indirect call and no cpu check.
         #[derive(Clone)]
         pub struct $name {
             state: [$s; $size],
             block: [u8; $block],
-            pos: usize
+            pos: usize,
+            len: u128,
+            update_multi: unsafe extern "C" fn(*mut $s, *mut u8, u32)
         }
 
         impl $name {
@@ -29,7 +36,9 @@ macro_rules! sha2 {
             pub const HASH_LENGTH: usize = $outlen;
 
             pub fn hash(output: &mut [u8; $outlen], input: &[u8]) {
-                unsafe { $hash(output.as_mut_ptr(), input.as_ptr() as _, input.len() as _) };
+                let mut state = $name::default();
+                state.update(input);
+                state.finish(output);
             }
         }
 
@@ -37,7 +46,7 @@ macro_rules! sha2 {
             fn default() -> Self {
                 let mut state = [0; $size];
                 unsafe { $init(state.as_mut_ptr()) };
-                $name { state, block: [0; $block], pos: 0 }
+                $name { state, block: [0; $block], pos: 0, len: 0, update_multi: $update_multi }
             }
         }
 
@@ -48,7 +57,8 @@ macro_rules! sha2 {
 
                 if len >= br {
                     self.block[self.pos..][..br].copy_from_slice(&buf[..br]);
-                    unsafe { $update(self.state.as_mut_ptr(), self.block.as_ptr() as _) };
+                    unsafe { (self.update_multi)(self.state.as_mut_ptr(), self.block.as_ptr() as _, 1) };
+                    self.len += $block;
                     self.pos = 0;
                 } else {
                     self.block[self.pos..][..len].copy_from_slice(buf);
@@ -61,7 +71,16 @@ macro_rules! sha2 {
                 let n = len / $block;
                 let r = len % $block;
 
-                unsafe { $update_multi(self.state.as_mut_ptr(), buf.as_ptr() as _, n as _) };
+                for chunk in buf[..n * $block].chunks(MAX_BLOCKS * $block) {
+                    unsafe {
+                        (self.update_multi)(
+                            self.state.as_mut_ptr(),
+                            chunk.as_ptr() as _,
+                            (chunk.len() / $block) as _
+                        )
+                    };
+                }
+                self.len += (n * $block) as u128;
 
                 self.block[..r].copy_from_slice(&buf[n * $block..][..r]);
                 self.pos = r;
@@ -69,58 +88,249 @@ macro_rules! sha2 {
 
             pub fn finish(mut self, buf: &mut [u8; $outlen]) {
                 unsafe {
-                    $update_last(self.state.as_mut_ptr(), self.block.as_ptr() as _, self.pos as _);
-                    $finish(self.state.as_ptr() as _, buf.as_mut_ptr());
+                    $update_last(
+                        self.state.as_mut_ptr(),
+                        $prev_len(self.len),
+                        self.block.as_ptr() as _,
+                        self.pos as _
+                    );
+                    $finish(self.state.as_mut_ptr(), buf.as_mut_ptr());
                 }
             }
         }
+
+        impl Hash for $name {
+            const BLOCK_LENGTH: usize = $block;
+            const HASH_LENGTH: usize = $outlen;
+
+            #[inline]
+            fn update(&mut self, buf: &[u8]) {
+                $name::update(self, buf)
+            }
+
+            fn finish_into(self, output: &mut [u8]) {
+                let mut buf = [0; $outlen];
+                self.finish(&mut buf);
+                output[..$outlen].copy_from_slice(&buf);
+            }
+        }
     }
 }
 
+#[inline]
+fn prev_len64(len: u128) -> u64 {
+    len as u64
+}
+
+sha2!{
+    pub struct Sha224 {
+        state: [u32; 8],
+        block: [u8; 64]
+    }
+
+    const HASH_LENGTH = 28;
+
+    impl ffi::hash::Hacl_Hash_Core_SHA2_init_224;
+    impl ffi::dispatch::table().sha256_update_multi;
+    impl ffi::hash::Hacl_Hash_SHA2_update_last_224;
+    impl ffi::hash::Hacl_Hash_Core_SHA2_finish_224;
+    impl prev_len64;
+}
+
 sha2!{
     pub struct Sha256 {
-        state: [u32; 137],
+        state: [u32; 8],
         block: [u8; 64]
     }
 
     const HASH_LENGTH = 32;
 
-    impl ffi::sha2_256::Hacl_SHA2_256_hash;
-    impl ffi::sha2_256::Hacl_SHA2_256_init;
-    impl ffi::sha2_256::Hacl_SHA2_256_update;
-    impl ffi::sha2_256::Hacl_SHA2_256_update_multi;
-    impl ffi::sha2_256::Hacl_SHA2_256_update_last;
-    impl ffi::sha2_256::Hacl_SHA2_256_finish;
+    impl ffi::hash::Hacl_Hash_Core_SHA2_init_256;
+    impl ffi::dispatch::table().sha256_update_multi;
+    impl ffi::hash::Hacl_Hash_SHA2_update_last_256;
+    impl ffi::hash::Hacl_Hash_Core_SHA2_finish_256;
+    impl prev_len64;
 }
 
 sha2!{
     pub struct Sha384 {
-        state: [u64; 169],
+        state: [u64; 8],
         block: [u8; 128]
     }
 
     const HASH_LENGTH = 48;
 
-    impl ffi::sha2_384::Hacl_SHA2_384_hash;
-    impl ffi::sha2_384::Hacl_SHA2_384_init;
-    impl ffi::sha2_384::Hacl_SHA2_384_update;
-    impl ffi::sha2_384::Hacl_SHA2_384_update_multi;
-    impl ffi::sha2_384::Hacl_SHA2_384_update_last;
-    impl ffi::sha2_384::Hacl_SHA2_384_finish;
+    impl ffi::hash::Hacl_Hash_Core_SHA2_init_384;
+    impl ffi::hash::Hacl_Hash_SHA2_update_multi_384 as _;
+    impl ffi::hash::Hacl_Hash_SHA2_update_last_384;
+    impl ffi::hash::Hacl_Hash_Core_SHA2_finish_384;
+    impl ffi::uint128;
 }
 
 sha2!{
     pub struct Sha512 {
-        state: [u64; 169],
+        state: [u64; 8],
         block: [u8; 128]
     }
 
     const HASH_LENGTH = 64;
 
-    impl ffi::sha2_512::Hacl_SHA2_512_hash;
-    impl ffi::sha2_512::Hacl_SHA2_512_init;
-    impl ffi::sha2_512::Hacl_SHA2_512_update;
-    impl ffi::sha2_512::Hacl_SHA2_512_update_multi;
-    impl ffi::sha2_512::Hacl_SHA2_512_update_last;
-    impl ffi::sha2_512::Hacl_SHA2_512_finish;
+    impl ffi::hash::Hacl_Hash_Core_SHA2_init_512;
+    impl ffi::hash::Hacl_Hash_SHA2_update_multi_512 as _;
+    impl ffi::hash::Hacl_Hash_SHA2_update_last_512;
+    impl ffi::hash::Hacl_Hash_Core_SHA2_finish_512;
+    impl ffi::uint128;
+}
+
+/// Four independent SHA-512 hashes stepped together.
+///
+/// Blocks that two or more lanes have ready go through one
+/// `dispatch::table().sha512x4_update_multi` call, which with AVX2 compresses four
+/// blocks in about the time `Sha512` takes for one. `finish` pads the four lanes
+/// and compresses their last blocks together too, so batches of short inputs (one
+/// or two blocks each, as in Ed25519) gain as much as long ones.
+#[derive(Clone)]
+pub struct Sha512x4 {
+    lanes: [Sha512; 4],
+    update_multi: ffi::dispatch::Sha512UpdateMulti4
+}
+
+impl Default for Sha512x4 {
+    fn default() -> Self {
+        Sha512x4::new([Sha512::default(), Sha512::default(), Sha512::default(), Sha512::default()])
+    }
+}
+
+impl Sha512x4 {
+    /// Continues the four states, e.g. after a shared prefix.
+    pub fn new(lanes: [Sha512; 4]) -> Sha512x4 {
+        Sha512x4 { lanes, update_multi: ffi::dispatch::table().sha512x4_update_multi }
+    }
+
+    /// `Sha512::hash` of each input.
+    pub fn hash(outputs: &mut [[u8; 64]; 4], inputs: [&[u8]; 4]) {
+        let mut state = Sha512x4::default();
+        state.update(inputs);
+        state.finish(outputs);
+    }
+
+    /// `Sha512::update` of lane `i` with `bufs[i]`; the lengths may differ.
+    pub fn update(&mut self, bufs: [&[u8]; 4]) {
+        // first the buffered block of each lane that `bufs[i]` completes
+        let mut full = [[0; 128]; 4];
+        let mut filled = [false; 4];
+        let mut rest = [&[][..]; 4];
+
+        for (i, (lane, buf)) in self.lanes.iter_mut().zip(bufs.iter()).enumerate() {
+            let br = 128 - lane.pos;
+
+            if buf.len() >= br {
+                full[i][..lane.pos].copy_from_slice(&lane.block[..lane.pos]);
+                full[i][lane.pos..].copy_from_slice(&buf[..br]);
+                filled[i] = true;
+                lane.pos = 0;
+                rest[i] = &buf[br..];
+            } else {
+                lane.block[lane.pos..][..buf.len()].copy_from_slice(buf);
+                lane.pos += buf.len();
+            }
+        }
+
+        let mut blocks = [&[][..]; 4];
+        for (i, block) in full.iter().enumerate() {
+            if filled[i] {
+                blocks[i] = &block[..];
+            }
+        }
+        self.update_blocks(blocks);
+
+        let mut blocks = [&[][..]; 4];
+        for (i, (lane, rest)) in self.lanes.iter_mut().zip(rest.iter()).enumerate() {
+            if !filled[i] {
+                continue;
+            }
+            let n = rest.len() / 128 * 128;
+            blocks[i] = &rest[..n];
+            lane.block[..rest.len() - n].copy_from_slice(&rest[n..]);
+            lane.pos = rest.len() - n;
+        }
+        self.update_blocks(blocks);
+    }
+
+    /// `Sha512::finish` of each lane into `outputs`.
+    pub fn finish(mut self, outputs: &mut [[u8; 64]; 4]) {
+        let mut last = [[0; 256]; 4];
+        let mut lens = [0; 4];
+
+        for ((lane, last), len) in self.lanes.iter().zip(last.iter_mut()).zip(lens.iter_mut()) {
+            // the block, 0x80, zeros and the length in bits, in one or two blocks
+            let total = (lane.len + lane.pos as u128) << 3;
+            *len = if lane.pos + 17 <= 128 { 128 } else { 256 };
+
+            last[..lane.pos].copy_from_slice(&lane.block[..lane.pos]);
+            last[lane.pos] = 0x80;
+            last[*len - 16..*len].copy_from_slice(&total.to_be_bytes());
+        }
+
+        let mut blocks = [&[][..]; 4];
+        for ((block, last), &len) in blocks.iter_mut().zip(last.iter()).zip(lens.iter()) {
+            *block = &last[..len];
+        }
+        self.update_blocks(blocks);
+
+        for (lane, output) in self.lanes.iter_mut().zip(outputs.iter_mut()) {
+            unsafe {
+                ffi::hash::Hacl_Hash_Core_SHA2_finish_512(lane.state.as_mut_ptr(), output.as_mut_ptr());
+            }
+        }
+    }
+
+    /// Compresses `blocks[i]`, whole blocks, into lane `i`: four lanes per kernel
+    /// call while two or more have blocks left, then the last one on its own.
+    fn update_blocks(&mut self, mut blocks: [&[u8]; 4]) {
+        let mut scratch = [[0u64; 8]; 4];
+
+        loop {
+            let active = blocks.iter().filter(|b| !b.is_empty()).count();
+            let n = match blocks.iter().filter(|b| !b.is_empty()).map(|b| b.len() / 128).min() {
+                Some(n) => n.min(MAX_BLOCKS),
+                None => return
+            };
+
+            if active == 1 {
+                let i = blocks.iter().position(|b| !b.is_empty()).unwrap();
+                let lane = &mut self.lanes[i];
+                for chunk in blocks[i].chunks(MAX_BLOCKS * 128) {
+                    unsafe {
+                        (lane.update_multi)(lane.state.as_mut_ptr(), chunk.as_ptr() as _, (chunk.len() / 128) as _)
+                    };
+                }
+                lane.len += blocks[i].len() as u128;
+                return;
+            }
+
+            // idle lanes hash the blocks of a busy one into a scratch state
+            let busy = blocks.iter().position(|b| !b.is_empty()).unwrap();
+            let mut states = [core::ptr::null_mut(); 4];
+            let mut inputs = [core::ptr::null_mut(); 4];
+            for (i, (lane, scratch)) in self.lanes.iter_mut().zip(scratch.iter_mut()).enumerate() {
+                if blocks[i].is_empty() {
+                    states[i] = scratch.as_mut_ptr();
+                    inputs[i] = blocks[busy].as_ptr() as *mut u8;
+                } else {
+                    states[i] = lane.state.as_mut_ptr();
+                    inputs[i] = blocks[i].as_ptr() as *mut u8;
+                }
+            }
+
+            unsafe { (self.update_multi)(states.as_mut_ptr(), inputs.as_mut_ptr(), n as u32) };
+
+            for (lane, blocks) in self.lanes.iter_mut().zip(blocks.iter_mut()) {
+                if !blocks.is_empty() {
+                    lane.len += (n * 128) as u128;
+                    *blocks = &blocks[n * 128..];
+                }
+            }
+        }
+    }
 }
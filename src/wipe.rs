@@ -0,0 +1,10 @@
+use core::ptr;
+
+
+/// Zeroes `buf` with volatile writes, which the compiler cannot drop as dead
+/// stores, for keys and other secrets about to go out of scope.
+pub(crate) fn wipe(buf: &mut [u8]) {
+    for b in buf.iter_mut() {
+        unsafe { ptr::write_volatile(b, 0) };
+    }
+}
@@ -0,0 +1,224 @@
+extern crate hacl_star;
+
+use std::sync::Arc;
+use std::thread;
+use hacl_star::aead::{ Aead, Alg, AeadKeyPool, Slot };
+
+
+fn hex(s: &str) -> Vec<u8> {
+    (0..s.len()).step_by(2)
+        .map(|i| u8::from_str_radix(&s[i..i + 2], 16).unwrap())
+        .collect()
+}
+
+fn check(alg: Alg, key: &str, nonce: &str, aad: &str, m: &[u8], c: &str, t: &str) {
+    let mut aead = match Aead::new(alg, &hex(key)) {
+        Some(aead) => aead,
+        None => {
+            assert!(alg != Alg::Chacha20Poly1305);
+            return
+        }
+    };
+
+    let (nonce, aad) = (hex(nonce), hex(aad));
+    let mut buf = m.to_vec();
+    let mut tag = [0; 16];
+    aead.encrypt(&nonce, &aad, &mut buf, &mut tag);
+    assert_eq!(buf, hex(c));
+    assert_eq!(&tag[..], &hex(t)[..]);
+
+    assert!(aead.decrypt(&nonce, &aad, &mut buf, &tag));
+    assert_eq!(buf, m);
+
+    aead.encrypt(&nonce, &aad, &mut buf, &mut tag);
+    tag[0] ^= 1;
+    assert!(!aead.decrypt(&nonce, &aad, &mut buf, &tag));
+    assert!(buf.iter().all(|&b| b == 0));
+}
+
+#[test]
+fn test_chacha20poly1305() {
+    // RFC 8439, section 2.8.2
+    check(
+        Alg::Chacha20Poly1305,
+        "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f",
+        "070000004041424344454647",
+        "50515253c0c1c2c3c4c5c6c7",
+        b"Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.",
+        "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6\
+         3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36\
+         92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc\
+         3ff4def08e4b7a9de576d26586cec64b6116",
+        "1ae10b594f09e26a7e902ecbd0600691"
+    );
+}
+
+#[test]
+fn test_aes_gcm() {
+    // GCM specification, test cases 4 and 16
+    let m = hex("d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72\
+                 1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+
+    check(
+        Alg::Aes128Gcm,
+        "feffe9928665731c6d6a8f9467308308",
+        "cafebabefacedbaddecaf888",
+        "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+        &m,
+        "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e\
+         21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+        "5bc94fbc3221a5db94fae95ae7121a47"
+    );
+
+    check(
+        Alg::Aes256Gcm,
+        "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+        "cafebabefacedbaddecaf888",
+        "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+        &m,
+        "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa\
+         8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+        "76fc6ece0f4e1768cddf8853bb2d551b"
+    );
+}
+
+#[test]
+fn test_aead_roundtrip() {
+    let msg = (0..2000).map(|i| i as u8).collect::<Vec<u8>>();
+
+    for &alg in [Alg::Aes128Gcm, Alg::Aes256Gcm, Alg::Chacha20Poly1305].iter() {
+        let key = vec![0x42; alg.key_length()];
+        let mut aead = match Aead::new(alg, &key) {
+            Some(aead) => aead,
+            None => continue
+        };
+
+        for &len in [0, 1, 15, 16, 17, 95, 96, 288, 300, 2000].iter() {
+            let mut buf = msg[..len].to_vec();
+            let mut tag = [0; 16];
+            aead.encrypt(&[7; 12], b"aad", &mut buf, &mut tag);
+
+            // a moved copy keeps working: no pointers into the state are kept
+            let mut moved = aead.clone();
+            assert!(moved.decrypt(&[7; 12], b"aad", &mut buf, &tag), "{:?} {}", alg, len);
+            assert_eq!(buf, &msg[..len]);
+        }
+
+        // re-keying in place gives the same results as a fresh state
+        let mut rekeyed = Aead::new(Alg::Chacha20Poly1305, &[1; 32]).unwrap();
+        assert!(rekeyed.rekey(alg, &key));
+
+        let (mut a, mut b) = (msg.clone(), msg.clone());
+        let (mut ta, mut tb) = ([0; 16], [0; 16]);
+        aead.encrypt(&[9; 12], &[], &mut a, &mut ta);
+        rekeyed.encrypt(&[9; 12], &[], &mut b, &mut tb);
+        assert_eq!(a, b);
+        assert_eq!(ta, tb);
+    }
+}
+
+#[test]
+fn test_aead_pool() {
+    let pool = AeadKeyPool::new((0..4).map(|_| Slot::new()).collect::<Vec<_>>());
+    let msg = (0..300).map(|i| i as u8).collect::<Vec<u8>>();
+
+    let handles = (0..4)
+        .map(|i| pool.insert(Alg::Chacha20Poly1305, &[i; 32]).unwrap())
+        .collect::<Vec<_>>();
+    assert!(pool.insert(Alg::Chacha20Poly1305, &[9; 32]).is_none());
+
+    for (i, &handle) in handles.iter().enumerate() {
+        let (mut a, mut b) = (msg.clone(), msg.clone());
+        let (mut ta, mut tb) = ([0; 16], [0; 16]);
+        pool.with(handle, |aead| aead.encrypt(&[1; 12], &[], &mut a, &mut ta)).unwrap();
+        Aead::new(Alg::Chacha20Poly1305, &[i as u8; 32]).unwrap()
+            .encrypt(&[1; 12], &[], &mut b, &mut tb);
+        assert_eq!(a, b);
+        assert_eq!(ta, tb);
+    }
+
+    // a removed handle is rejected, even once its slot is reused
+    assert!(pool.remove(handles[2]));
+    assert!(!pool.remove(handles[2]));
+    assert!(pool.with(handles[2], |_| ()).is_none());
+
+    let reused = pool.insert(Alg::Chacha20Poly1305, &[7; 32]).unwrap();
+    assert_ne!(reused, handles[2]);
+    assert!(pool.with(handles[2], |_| ()).is_none());
+    assert_eq!(pool.with(reused, |aead| aead.alg()), Some(Alg::Chacha20Poly1305));
+}
+
+#[test]
+fn test_aead_pool_foreign_handle() {
+    let pool = AeadKeyPool::new((0..2).map(|_| Slot::new()).collect::<Vec<_>>());
+    let other = AeadKeyPool::new((0..2).map(|_| Slot::new()).collect::<Vec<_>>());
+
+    // same index and generation, but from another pool: on a free slot and on a
+    // used one
+    let foreign = other.insert(Alg::Chacha20Poly1305, &[1; 32]).unwrap();
+    assert!(pool.with(foreign, |_| ()).is_none());
+    assert!(!pool.remove(foreign));
+
+    let own = pool.insert(Alg::Chacha20Poly1305, &[2; 32]).unwrap();
+    assert!(pool.with(foreign, |_| ()).is_none());
+    assert!(!pool.remove(foreign));
+
+    // the free list was not corrupted: the second slot is handed out once
+    let second = pool.insert(Alg::Chacha20Poly1305, &[3; 32]).unwrap();
+    assert_ne!(own, second);
+    assert!(pool.insert(Alg::Chacha20Poly1305, &[4; 32]).is_none());
+
+    assert!(pool.remove(own));
+    assert!(pool.with(own, |_| ()).is_none());
+    assert!(!pool.remove(own));
+    assert!(other.remove(foreign));
+}
+
+/// A borrowed slice serves one pool at a time (the doc test of `AeadKeyPool`
+/// checks that a second one does not compile); the next starts empty.
+#[test]
+fn test_aead_pool_borrowed() {
+    let mut slots = [Slot::new(), Slot::new()];
+
+    let pool = AeadKeyPool::new(&mut slots[..]);
+    let handle = pool.insert(Alg::Chacha20Poly1305, &[1; 32]).unwrap();
+    assert!(pool.insert(Alg::Chacha20Poly1305, &[2; 32]).is_some());
+    assert!(pool.insert(Alg::Chacha20Poly1305, &[3; 32]).is_none());
+    drop(pool);
+
+    let pool = AeadKeyPool::new(&mut slots[..]);
+    assert!(pool.with(handle, |_| ()).is_none());
+    assert!(!pool.remove(handle));
+    assert!(pool.insert(Alg::Chacha20Poly1305, &[4; 32]).is_some());
+    assert!(pool.insert(Alg::Chacha20Poly1305, &[5; 32]).is_some());
+    assert!(pool.insert(Alg::Chacha20Poly1305, &[6; 32]).is_none());
+}
+
+#[test]
+fn test_aead_pool_threads() {
+    let pool = Arc::new(AeadKeyPool::new((0..64).map(|_| Slot::new()).collect::<Vec<_>>()));
+    let alg = if Aead::new(Alg::Aes128Gcm, &[0; 16]).is_some() { Alg::Aes128Gcm } else { Alg::Chacha20Poly1305 };
+
+    let threads = (0..8u8)
+        .map(|t| {
+            let pool = pool.clone();
+            thread::spawn(move || {
+                for round in 0..100u8 {
+                    let key = vec![t ^ round; alg.key_length()];
+                    let handle = pool.insert(alg, &key).unwrap();
+                    let mut buf = vec![round; 100];
+                    let mut tag = [0; 16];
+
+                    pool.with(handle, |aead| aead.encrypt(&[t; 12], &[], &mut buf, &mut tag)).unwrap();
+                    assert!(Aead::new(alg, &key).unwrap().decrypt(&[t; 12], &[], &mut buf, &tag));
+                    assert_eq!(buf, vec![round; 100]);
+                    assert!(pool.remove(handle));
+                }
+            })
+        })
+        .collect::<Vec<_>>();
+
+    for thread in threads {
+        thread.join().unwrap();
+    }
+}
@@ -37,3 +37,58 @@ fn test_curve25519_kx() {
 
     assert_eq!(out1, out2);
 }
+
+#[test]
+fn test_curve25519_batch() {
+    use rand::{ RngCore, rngs::OsRng };
+
+    for &n in &[1, 2, 31, 32, 33, 100] {
+        let mut secrets = vec![[0; 32]; n];
+        let mut points = vec![[0; 32]; n];
+        for (sk, pk) in secrets.iter_mut().zip(points.iter_mut()) {
+            OsRng.fill_bytes(sk);
+            OsRng.fill_bytes(pk);
+        }
+        secrets[0] = SCALAR1;
+        points[0] = INPUT1;
+        // low order points, whose ladders end at Z = 0
+        points[n / 2] = [0; 32];
+        points[n - 1] = [0; 32];
+        points[n - 1][0] = 1;
+
+        let mut outputs = vec![[0xff; 32]; n];
+        curve25519::scalarmult_batch(&mut outputs, &secrets, &points);
+
+        for i in 0..n {
+            let mut expected = [0; 32];
+            curve25519::scalarmult(&mut expected, &secrets[i], &points[i]);
+            assert_eq!(outputs[i], expected, "n={} i={}", n, i);
+        }
+        if n > 1 {
+            assert_eq!(outputs[0], EXPECTED1);
+        }
+        assert_eq!(outputs[n / 2], [0; 32]);
+    }
+}
+
+#[test]
+fn test_curve25519_base() {
+    use rand::{ RngCore, rngs::OsRng };
+
+    let mut basepoint = [0; 32];
+    basepoint[0] = 9;
+
+    let mut secrets = vec![SCALAR1, SCALAR2, [0; 32], [0xff; 32]];
+    for _ in 0..64 {
+        let mut sk = [0; 32];
+        OsRng.fill_bytes(&mut sk);
+        secrets.push(sk);
+    }
+
+    for sk in &secrets {
+        let (mut expected, mut output) = ([0; 32], [0; 32]);
+        curve25519::scalarmult(&mut expected, sk, &basepoint);
+        curve25519::scalarmult_base(&mut output, sk);
+        assert_eq!(output, expected);
+    }
+}
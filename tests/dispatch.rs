@@ -0,0 +1,141 @@
+extern crate hacl_star;
+
+use hacl_star::dispatch::{ self, Feature, Poly1305 as Kernel };
+use hacl_star::poly1305::{ Poly1305, Backend };
+use hacl_star::sha2::{ Sha256, Sha512x4 };
+use hacl_star::nacl::secret;
+use hacl_star::aead::{ Aead, Alg };
+#[cfg(feature = "std")]
+use hacl_star::merkle::{ Algorithm, Tree };
+
+
+fn sha256(input: &[u8]) -> [u8; 32] {
+    let mut state = Sha256::default();
+    state.update(input);
+    let mut out = [0; 32];
+    state.finish(&mut out);
+    out
+}
+
+fn sha512x4(input: &[u8]) -> [[u8; 64]; 4] {
+    let mut out = [[0; 64]; 4];
+    Sha512x4::hash(&mut out, [input, &input[1..], &input[..300], &[]]);
+    out
+}
+
+fn poly1305(input: &[u8]) -> [u8; 16] {
+    let mut out = [0; 16];
+    Poly1305::onetimeauth(&mut out, input, &[7; 32]);
+    out
+}
+
+fn secretbox(input: &[u8]) -> Vec<u8> {
+    let mut out = input.to_vec();
+    let mut mac = [0; 16];
+    secret::Key([7; 32]).nonce(&[9; 24]).seal_in_place(&mut out, &mut mac);
+    out.extend_from_slice(&mac);
+    out
+}
+
+fn chacha20poly1305(input: &[u8]) -> Vec<u8> {
+    let mut aead = Aead::new(Alg::Chacha20Poly1305, &[7; 32]).unwrap();
+    let mut out = input.to_vec();
+    let mut mac = [0; 16];
+    aead.encrypt(&[9; 12], b"aad", &mut out, &mut mac);
+    out.extend_from_slice(&mac);
+    out
+}
+
+#[cfg(feature = "std")]
+fn merkle_roots(msg: &[u8]) -> Vec<Vec<u8>> {
+    [Algorithm::Sha256, Algorithm::Blake2s, Algorithm::Blake2b].iter()
+        .map(|&algorithm| {
+            let len = algorithm.hash_length();
+            let leaves = &msg[..msg.len() / len * len];
+            Tree::from_leaves(algorithm, leaves).root().to_vec()
+        })
+        .collect()
+}
+
+#[cfg(not(feature = "std"))]
+fn merkle_roots(_msg: &[u8]) -> Vec<Vec<u8>> {
+    Vec::new()
+}
+
+#[test]
+fn test_dispatch() {
+    let msg = (0..10000).map(|i| i as u8).collect::<Vec<u8>>();
+    let before = dispatch::backends();
+
+    assert_eq!(Backend::detect() as usize, before.poly1305 as usize);
+    assert!(before.to_string().starts_with("poly1305: "));
+    assert!(before.to_string().contains(", sha256: "));
+    assert!(before.to_string().contains(", salsa20: "));
+    assert!(before.to_string().contains(", nacl_poly1305: "));
+    assert!(before.to_string().contains(", merkle: "));
+    assert!(before.to_string().contains(", sha512x4: "));
+    assert!(before.to_string().contains(", chacha20poly1305: "));
+    assert!(before.to_string().ends_with(if before.aes_gcm { ", aes_gcm: vale" } else { ", aes_gcm: none" }));
+    assert_eq!(Aead::new(Alg::Aes128Gcm, &[7; 16]).is_some(), before.aes_gcm);
+
+    let sha = sha256(&msg);
+    let mac = poly1305(&msg);
+    let sha512 = sha512x4(&msg);
+    let lens = (0..600).chain([1023, 1024, 1025, 4096, 10000].iter().cloned()).collect::<Vec<_>>();
+    let boxes = lens.iter().map(|&len| secretbox(&msg[..len])).collect::<Vec<_>>();
+    let roots = merkle_roots(&msg);
+    let sealed = lens.iter().map(|&len| chacha20poly1305(&msg[..len])).collect::<Vec<_>>();
+    let mut old_aead = Aead::new(Alg::Chacha20Poly1305, &[7; 32]).unwrap();
+
+    // a state created before the override keeps its kernel, and a table taken
+    // before it stays as it was
+    let mut old = Sha256::default();
+    let old_table = dispatch::table();
+
+    for &feature in [Feature::Shaext, Feature::Avx2, Feature::Avx, Feature::Vale].iter() {
+        dispatch::disable(feature);
+        assert_eq!(sha256(&msg), sha);
+        assert_eq!(poly1305(&msg), mac);
+        assert_eq!(sha512x4(&msg), sha512);
+        for (&len, sealed) in lens.iter().zip(&boxes) {
+            assert_eq!(&secretbox(&msg[..len]), sealed);
+        }
+        assert_eq!(merkle_roots(&msg), roots);
+        for (&len, sealed) in lens.iter().zip(&sealed) {
+            assert_eq!(&chacha20poly1305(&msg[..len]), sealed);
+        }
+    }
+
+    let after = dispatch::backends();
+    assert_eq!(after.sha256, "portable");
+    assert_eq!(after.salsa20, if cfg!(any(target_arch = "aarch64", all(target_arch = "wasm32", target_feature = "simd128"))) { "vec128" } else { "portable" });
+    assert_eq!(after.merkle, after.salsa20);
+    assert_eq!(after.sha512x4, "portable");
+    assert_eq!(after.poly1305, if cfg!(any(target_arch = "aarch64", all(target_arch = "wasm32", target_feature = "simd128"))) { Kernel::Vec128 } else { Kernel::Portable });
+    assert_eq!(Backend::detect() as usize, after.poly1305 as usize);
+    assert_eq!(after.nacl_poly1305, if after.poly1305 == Kernel::Vec128 { "vec128" } else { "portable" });
+    assert_eq!(after.chacha20poly1305, after.salsa20);
+    assert_eq!(after.aes_gcm, false);
+    assert!(Aead::new(Alg::Aes256Gcm, &[7; 32]).is_none());
+
+    assert_eq!(old_table.sha256, before.sha256);
+    assert_eq!(old_table.poly1305, before.poly1305);
+
+    old.update(&msg);
+    let mut out = [0; 32];
+    old.finish(&mut out);
+    assert_eq!(out, sha);
+
+    let mut c = msg.clone();
+    let mut mac = [0; 16];
+    old_aead.encrypt(&[9; 12], b"aad", &mut c, &mut mac);
+    c.extend_from_slice(&mac);
+    assert_eq!(&c, sealed.last().unwrap());
+}
+
+#[test]
+fn test_feature_names() {
+    assert_eq!(Feature::from_name("avx2"), Some(Feature::Avx2));
+    assert_eq!(Feature::from_name("shaext"), Some(Feature::Shaext));
+    assert_eq!(Feature::from_name("sha"), None);
+}
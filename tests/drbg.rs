@@ -0,0 +1,134 @@
+extern crate hacl_star;
+extern crate rand;
+#[cfg(unix)]
+extern crate libc;
+
+use rand::RngCore;
+use hacl_star::drbg::Drbg;
+
+
+fn stream(drbg: &mut Drbg, len: usize, step: usize) -> Vec<u8> {
+    let mut out = vec![0; len];
+    for chunk in out.chunks_mut(step) {
+        drbg.fill_bytes(chunk);
+    }
+    out
+}
+
+#[test]
+fn test_drbg_buffering() {
+    let entropy = [0x42; 32];
+    let nonce = [0x24; 16];
+
+    let expected = stream(&mut Drbg::from_entropy(&entropy, &nonce, b"test"), 3 * 4096, 3 * 4096);
+
+    for &step in &[1, 7, 32, 4095, 4096, 5000] {
+        let mut drbg = Drbg::from_entropy(&entropy, &nonce, b"test");
+        // requests that start on a refill boundary are generated in place,
+        // so only compare streams that stay within the buffer
+        if step < 4096 {
+            assert_eq!(stream(&mut drbg, 4096, step), &expected[..4096], "step={}", step);
+        } else {
+            let out = stream(&mut drbg, 3 * 4096, step);
+            assert_ne!(out, vec![0; 3 * 4096]);
+        }
+    }
+
+    let other = stream(&mut Drbg::from_entropy(&entropy, &nonce, b"other"), 4096, 4096);
+    assert_ne!(other, &expected[..4096]);
+}
+
+#[test]
+#[should_panic]
+fn test_drbg_short_nonce() {
+    Drbg::from_entropy(&[0x42; 32], &[0x24; 15], b"");
+}
+
+#[test]
+#[should_panic]
+fn test_drbg_long_personalization() {
+    Drbg::from_entropy(&[0x42; 32], &[0x24; 16], &vec![0; 65537]);
+}
+
+#[test]
+fn test_drbg_reseed() {
+    let mut drbg = Drbg::new().unwrap();
+
+    // past the 1024 generate calls of the reseed interval
+    let mut buf = [0; 4000];
+    for _ in 0..1100 {
+        drbg.fill_bytes(&mut buf);
+    }
+    assert_ne!(&buf[..], &[0; 4000][..]);
+
+    drbg.reseed().unwrap();
+    assert_ne!(drbg.next_u64(), drbg.next_u64());
+}
+
+#[cfg(feature = "std")]
+#[test]
+fn test_hacl_rng() {
+    use std::thread;
+    use hacl_star::drbg::HaclRng;
+
+    let handles = (0..4)
+        .map(|_| thread::spawn(|| {
+            let mut rng = HaclRng::new();
+            let mut buf = [0; 64];
+            rng.fill_bytes(&mut buf);
+            (buf.to_vec(), rng.next_u64())
+        }))
+        .collect::<Vec<_>>();
+
+    let outputs = handles.into_iter()
+        .map(|h| h.join().unwrap())
+        .collect::<Vec<_>>();
+
+    for i in 0..outputs.len() {
+        for j in i + 1..outputs.len() {
+            assert_ne!(outputs[i], outputs[j]);
+        }
+    }
+}
+
+#[cfg(all(unix, feature = "std"))]
+#[test]
+fn test_drbg_fork() {
+    use hacl_star::drbg::HaclRng;
+
+    // parent and child draw right after the fork, the parent's buffer half used
+    fn fork_streams<R: RngCore>(rng: &mut R) -> (Vec<u8>, Vec<u8>) {
+        let mut buf = [0; 64];
+        rng.fill_bytes(&mut buf);
+
+        let mut fds = [0; 2];
+        assert_eq!(unsafe { libc::pipe(fds.as_mut_ptr()) }, 0);
+
+        let pid = unsafe { libc::fork() };
+        assert!(pid >= 0);
+        rng.fill_bytes(&mut buf);
+
+        if pid == 0 {
+            unsafe {
+                libc::write(fds[1], buf.as_ptr() as *const libc::c_void, buf.len());
+                libc::_exit(0);
+            }
+        }
+
+        let mut child = [0; 64];
+        let n = unsafe { libc::read(fds[0], child.as_mut_ptr() as *mut libc::c_void, child.len()) };
+        unsafe {
+            libc::waitpid(pid, core::ptr::null_mut(), 0);
+            libc::close(fds[0]);
+            libc::close(fds[1]);
+        }
+        assert_eq!(n, 64);
+        (buf.to_vec(), child.to_vec())
+    }
+
+    let (parent, child) = fork_streams(&mut Drbg::from_entropy(&[0x42; 32], &[0x24; 16], b""));
+    assert_ne!(parent, child);
+
+    let (parent, child) = fork_streams(&mut HaclRng::new());
+    assert_ne!(parent, child);
+}
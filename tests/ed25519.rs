@@ -47,3 +47,92 @@ fn test_ed25519() {
     sig.0[23] ^= 0x01;
     assert!(!ed25519::PublicKey(PK11).verify(&MSG11, &sig));
 }
+
+fn hex(s: &str) -> Vec<u8> {
+    (0..s.len()).step_by(2)
+        .map(|i| u8::from_str_radix(&s[i..i + 2], 16).unwrap())
+        .collect()
+}
+
+fn array32(s: &str) -> [u8; 32] {
+    let mut out = [0; 32];
+    out.copy_from_slice(&hex(s));
+    out
+}
+
+#[test]
+fn test_ed25519ph() {
+    // RFC 8032, section 7.3
+    let sk = ed25519::SecretKey(array32("833fe62409237b9d62ec77587520911e9a759cec1d19755b7da901b96dca3d42"));
+    let pk = sk.get_public();
+    assert_eq!(pk.0, array32("ec172b93ad5e563bf4932c70e1245034c35467ef2efd4d64ebf819683467e2bf"));
+
+    let mut prehash = ed25519::Prehash::new();
+    prehash.update(b"a");
+    prehash.update(b"bc");
+    let mut sig = sk.signature_ph(prehash.clone(), &[]);
+    assert_eq!(
+        &sig.0[..],
+        &hex("98a70222f0b8121aa9d30f813d683f809e462b469c7ff87639499bb94e6dae41\
+              31f85042463c2a355a2003d062adf5aaa10b8c61e636062aaad11c2a26083406")[..]
+    );
+
+    assert!(pk.clone().verify_ph(prehash.clone(), &[], &sig));
+    assert!(!pk.clone().verify_ph(prehash.clone(), b"ctx", &sig));
+    assert!(!pk.clone().verify_ctx(b"abc", &[], &sig));
+
+    sig.0[40] ^= 1;
+    assert!(!pk.verify_ph(prehash, &[], &sig));
+}
+
+#[test]
+fn test_ed25519ctx() {
+    // RFC 8032, section 7.2
+    let sk = ed25519::SecretKey(array32("0305334e381af78f141cb666f6199f57bc3495335a256a95bd2a55bf546663f6"));
+    let pk = sk.get_public();
+    let msg = hex("f726936d19c800494e3fdaff20b276a8");
+
+    let sig = sk.signature_ctx(&msg, b"foo");
+    assert_eq!(
+        &sig.0[..],
+        &hex("55a4cc2f70a54e04288c5f4cd1e45a7bb520b36292911876cada7323198dd87a\
+              8b36950b95130022907a7fb7c4e9b2d5f6cca685a587b4b21f4b888e4e7edb0d")[..]
+    );
+
+    assert!(pk.clone().verify_ctx(&msg, b"foo", &sig));
+    assert!(!pk.clone().verify_ctx(&msg, b"bar", &sig));
+    assert!(!pk.verify(&msg, &sig));
+}
+
+#[test]
+fn test_ed25519_batch() {
+    let keys = (0..11u8).map(|i| ed25519::SecretKey([i * 13 + 1; 32])).collect::<Vec<_>>();
+    let publics = keys.iter().map(|sk| sk.get_public()).collect::<Vec<_>>();
+    let msg = (0..400).map(|i| i as u8).collect::<Vec<u8>>();
+    // lengths around the one- and two-block padding boundaries of R || A || M
+    let msgs = [0, 1, 47, 48, 63, 64, 175, 176, 200, 300, 400].iter()
+        .map(|&len| &msg[..len])
+        .collect::<Vec<_>>();
+
+    let mut sigs = vec![ed25519::Signature([0; 64]); keys.len()];
+    ed25519::sign_batch(&mut sigs, &keys, &msgs);
+    for ((sk, msg), sig) in keys.iter().zip(&msgs).zip(&sigs) {
+        assert_eq!(&sig.0[..], &sk.signature(msg).0[..]);
+    }
+
+    let mut results = vec![false; keys.len()];
+    assert!(ed25519::verify_batch(&mut results, &publics, &msgs, &sigs));
+    assert!(results.iter().all(|&ok| ok));
+
+    sigs[5].0[40] ^= 0x01;
+    sigs[9].0[3] ^= 0x80;
+    assert!(!ed25519::verify_batch(&mut results, &publics, &msgs, &sigs));
+    for (i, &ok) in results.iter().enumerate() {
+        assert_eq!(ok, i != 5 && i != 9, "i={}", i);
+        assert_eq!(ok, publics[i].clone().verify(msgs[i], &sigs[i]));
+    }
+
+    let mut sigs: [ed25519::Signature; 0] = [];
+    ed25519::sign_batch(&mut sigs, &[], &[]);
+    assert!(ed25519::verify_batch(&mut [], &[], &[], &[]));
+}
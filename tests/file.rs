@@ -0,0 +1,65 @@
+#![cfg(feature = "std")]
+
+extern crate hacl_star;
+
+use std::io::{ self, Read };
+use hacl_star::hash::Hash;
+use hacl_star::sha2::{ Sha256, Sha512 };
+use hacl_star::blake2::Blake2b;
+use hacl_star::file::{ self, Algorithm };
+
+
+fn digest<H: Hash>(input: &[u8]) -> Vec<u8> {
+    let mut h = H::default();
+    h.update(input);
+    let mut out = vec![0; H::HASH_LENGTH];
+    h.finish_into(&mut out);
+    out
+}
+
+/// Hands out at most 1000 bytes per read, to exercise partial reads.
+struct Trickle<'a>(&'a [u8]);
+
+impl<'a> Read for Trickle<'a> {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        let n = buf.len().min(self.0.len()).min(1000);
+        buf[..n].copy_from_slice(&self.0[..n]);
+        self.0 = &self.0[n..];
+        Ok(n)
+    }
+}
+
+#[test]
+fn test_hash_reader() {
+    let algorithms = [Algorithm::Sha256, Algorithm::Sha512, Algorithm::Blake2b];
+
+    // past QUEUE_LENGTH + 2 chunks, the reader reuses buffers
+    for &len in &[0, 1, 1 << 20, (1 << 20) + 1, 3 << 20, (9 << 20) + 5] {
+        let input = (0..len).map(|i| (i * 7) as u8).collect::<Vec<u8>>();
+        let expected = [digest::<Sha256>(&input), digest::<Sha512>(&input), digest::<Blake2b>(&input)];
+
+        let digests = file::hash_reader(Trickle(&input), &algorithms).unwrap();
+        for (digest, expected) in digests.iter().zip(expected.iter()) {
+            assert_eq!(digest.as_ref(), &expected[..], "{:?} len={}", digest.algorithm, len);
+        }
+
+        let single = file::hash_reader(&input[..], &algorithms[1..2]).unwrap();
+        assert_eq!(single[0].as_ref(), &expected[1][..]);
+    }
+}
+
+#[test]
+fn test_hash_file() {
+    let path = std::env::temp_dir().join(format!("hacl-star-file-{}", std::process::id()));
+    let input = vec![0xa5; 5000];
+    std::fs::write(&path, &input).unwrap();
+
+    let digests = file::hash_file(&path, &[Algorithm::Blake2b, Algorithm::Sha256]).unwrap();
+    std::fs::remove_file(&path).unwrap();
+
+    assert_eq!(digests[0].as_ref(), &digest::<Blake2b>(&input)[..]);
+    assert_eq!(digests[1].as_ref(), &digest::<Sha256>(&input)[..]);
+    assert_eq!(digests[0].algorithm.to_string(), "BLAKE2b");
+    assert_eq!(digests[1].algorithm.to_string(), "SHA256");
+    assert!(file::hash_file(&path, &[Algorithm::Sha256]).is_err());
+}
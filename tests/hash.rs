@@ -0,0 +1,148 @@
+extern crate hacl_star;
+
+use hacl_star::hash::{ Hash, PrefixHasher };
+use hacl_star::sha2::{ Sha256, Sha384, Sha512, Sha512x4 };
+use hacl_star::blake2::{ Blake2s, Blake2b };
+
+
+fn hex(s: &str) -> Vec<u8> {
+    (0..s.len()).step_by(2)
+        .map(|i| u8::from_str_radix(&s[i..i + 2], 16).unwrap())
+        .collect()
+}
+
+fn digest<H: Hash>(chunks: &[&[u8]]) -> Vec<u8> {
+    let mut h = H::default();
+    for chunk in chunks {
+        h.update(chunk);
+    }
+    let mut out = vec![0; H::HASH_LENGTH];
+    h.finish_into(&mut out);
+    out
+}
+
+fn check<H: Hash>(expected_abc: &str, expected_empty: &str) {
+    assert_eq!(digest::<H>(&[b"abc"]), hex(expected_abc));
+    assert_eq!(digest::<H>(&[b"a", b"", b"bc"]), hex(expected_abc));
+    assert_eq!(digest::<H>(&[]), hex(expected_empty));
+
+    let msg = (0..1000).map(|i| i as u8).collect::<Vec<u8>>();
+    let expected = digest::<H>(&[&msg]);
+    for &step in &[1, 63, 64, 65, 127, 128, 129, 500] {
+        let chunks = msg.chunks(step).collect::<Vec<_>>();
+        assert_eq!(digest::<H>(&chunks), expected, "step={}", step);
+    }
+}
+
+#[test]
+fn test_sha2() {
+    check::<Sha256>(
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"
+    );
+    check::<Sha384>(
+        "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed\
+         8086072ba1e7cc2358baeca134c825a7",
+        "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da\
+         274edebfe76f65fbd51ad2f14898b95b"
+    );
+    check::<Sha512>(
+        "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a\
+         2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+        "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce\
+         47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e"
+    );
+
+    let mut out = [0; 32];
+    Sha256::hash(&mut out, b"abc");
+    assert_eq!(&out[..], &hex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad")[..]);
+}
+
+#[test]
+fn test_blake2() {
+    check::<Blake2s>(
+        "508c5e8c327c14e2e1a72ba34eeb452f37458b209ed63a294d999b4c86675982",
+        "69217a3079908094e11121d042354a7c1f55b6482ca1a51e1b250dfd1ed0eef9"
+    );
+    check::<Blake2b>(
+        "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1\
+         7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923",
+        "786a02f742015903c6c6fd852552d272912f4740e15847618a86e217f71f5419\
+         d25e1031afee585313896444934eb04b903a685b1448b755d56f701afe9be2ce"
+    );
+
+    let mut out = [0; 32];
+    Blake2s::hash(&mut out, b"abc");
+    assert_eq!(&out[..], &hex("508c5e8c327c14e2e1a72ba34eeb452f37458b209ed63a294d999b4c86675982")[..]);
+}
+
+fn check_prefix<H: Hash>() {
+    let msg = (0..700).map(|i| i as u8).collect::<Vec<u8>>();
+
+    for &split in &[0, 1, 63, 64, 65, 128, 129, 256, 300] {
+        let (prefix, rest) = msg.split_at(split);
+        let prefixed = PrefixHasher::<H>::new(prefix);
+
+        for &len in &[0, 1, 64, 128, 200] {
+            let suffix = &rest[..len];
+            let mut out = vec![0; H::HASH_LENGTH];
+            prefixed.hash(suffix, &mut out);
+            assert_eq!(out, digest::<H>(&[prefix, suffix]), "split={} len={}", split, len);
+        }
+    }
+
+    // forks continue independently from the shared state
+    let mut base = H::default();
+    base.update(&msg[..100]);
+    let mut fork = base.fork();
+    fork.update(b"x");
+    base.update(b"y");
+
+    let (mut a, mut b) = (vec![0; H::HASH_LENGTH], vec![0; H::HASH_LENGTH]);
+    fork.finish_into(&mut a);
+    base.finish_into(&mut b);
+    assert_eq!(a, digest::<H>(&[&msg[..100], b"x"]));
+    assert_eq!(b, digest::<H>(&[&msg[..100], b"y"]));
+}
+
+#[test]
+fn test_prefix_hasher() {
+    check_prefix::<Sha256>();
+    check_prefix::<Sha512>();
+    check_prefix::<Blake2s>();
+    check_prefix::<Blake2b>();
+}
+
+#[test]
+fn test_sha512x4() {
+    let msg = (0..2000).map(|i| (i * 7) as u8).collect::<Vec<u8>>();
+    let lens = [0, 1, 111, 112, 127, 128, 129, 239, 240, 256, 1000, 2000];
+
+    // every lane length against every other, lanes finishing in different calls
+    for &a in &lens {
+        for &b in &lens {
+            let inputs = [&msg[..a], &msg[..b], &msg[3..3 + a / 2], &msg[b / 3..b]];
+            let mut outputs = [[0; 64]; 4];
+            Sha512x4::hash(&mut outputs, inputs);
+            for (output, input) in outputs.iter().zip(inputs.iter()) {
+                assert_eq!(&output[..], &digest::<Sha512>(&[input])[..], "a={} b={}", a, b);
+            }
+        }
+    }
+
+    // split updates, ragged across lanes
+    let mut state = Sha512x4::default();
+    for chunk in 0..20 {
+        let step = [1, 63, 128, 200];
+        let mut bufs = [&[][..]; 4];
+        for (i, buf) in bufs.iter_mut().enumerate() {
+            *buf = &msg[(chunk * step[i]).min(2000)..((chunk + 1) * step[i]).min(2000)];
+        }
+        state.update(bufs);
+    }
+    let mut outputs = [[0; 64]; 4];
+    state.finish(&mut outputs);
+    for (output, &step) in outputs.iter().zip([1, 63, 128, 200].iter()) {
+        assert_eq!(&output[..], &digest::<Sha512>(&[&msg[..(20 * step).min(2000)]])[..], "step={}", step);
+    }
+}
@@ -0,0 +1,153 @@
+extern crate hacl_star;
+extern crate hacl_star_sys;
+
+use hacl_star::hash::Hash;
+use hacl_star::hmac::{ self, Hmac };
+use hacl_star::hkdf::Hkdf;
+use hacl_star::sha2::{ Sha256, Sha512 };
+use hacl_star::blake2::{ Blake2s, Blake2b };
+use hacl_star_sys as ffi;
+
+
+fn hex(s: &str) -> Vec<u8> {
+    (0..s.len()).step_by(2)
+        .map(|i| u8::from_str_radix(&s[i..i + 2], 16).unwrap())
+        .collect()
+}
+
+fn mac<H: Hash>(key: &[u8], data: &[u8]) -> Vec<u8> {
+    let mut out = vec![0; H::HASH_LENGTH];
+    Hmac::<H>::new(key).mac(data, &mut out);
+    out
+}
+
+// RFC 4231, test cases 1, 2 and 6
+#[test]
+fn test_hmac_sha2() {
+    let cases: [(Vec<u8>, &[u8], &str, &str); 3] = [
+        (
+            vec![0x0b; 20],
+            b"Hi There",
+            "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+            "87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cde\
+             daa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854"
+        ),
+        (
+            b"Jefe".to_vec(),
+            b"what do ya want for nothing?",
+            "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+            "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554\
+             9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"
+        ),
+        (
+            vec![0xaa; 131],
+            b"Test Using Larger Than Block-Size Key - Hash Key First",
+            "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+            "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352\
+             6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598"
+        )
+    ];
+
+    for (key, data, tag256, tag512) in cases.iter() {
+        assert_eq!(mac::<Sha256>(key, data), hex(tag256));
+        assert_eq!(mac::<Sha512>(key, data), hex(tag512));
+
+        let mut out = [0; 32];
+        hmac::hmac_sha256(&mut out, key, data);
+        assert_eq!(&out[..], &hex(tag256)[..]);
+
+        let mut out = [0; 64];
+        hmac::hmac_sha512(&mut out, key, data);
+        assert_eq!(&out[..], &hex(tag512)[..]);
+    }
+}
+
+#[test]
+fn test_hmac_blake2() {
+    let data = (0..300).map(|i| i as u8).collect::<Vec<u8>>();
+
+    for &keylen in &[0, 16, 64, 65, 128, 129, 200] {
+        for &len in &[0, 1, 63, 64, 65, 128, 129, 300] {
+            let key = &data[..keylen];
+            let msg = &data[..len];
+
+            let mut expected = [0; 32];
+            unsafe {
+                ffi::hmac::Hacl_HMAC_compute_blake2s_32(
+                    expected.as_mut_ptr(),
+                    key.as_ptr() as _, key.len() as _,
+                    msg.as_ptr() as _, msg.len() as _
+                );
+            }
+            assert_eq!(mac::<Blake2s>(key, msg), &expected[..], "keylen={} len={}", keylen, len);
+
+            let mut expected = [0; 64];
+            unsafe {
+                ffi::hmac::Hacl_HMAC_compute_blake2b_32(
+                    expected.as_mut_ptr(),
+                    key.as_ptr() as _, key.len() as _,
+                    msg.as_ptr() as _, msg.len() as _
+                );
+            }
+            assert_eq!(mac::<Blake2b>(key, msg), &expected[..], "keylen={} len={}", keylen, len);
+        }
+    }
+}
+
+#[test]
+fn test_hmac_streaming() {
+    let keyed = Hmac::<Sha256>::new(b"key");
+    let msg = (0..200).map(|i| i as u8).collect::<Vec<u8>>();
+
+    let expected = mac::<Sha256>(b"key", &msg);
+
+    for &step in &[1, 13, 64, 100] {
+        let mut state = keyed.clone();
+        for chunk in msg.chunks(step) {
+            state.update(chunk);
+        }
+        let mut out = [0; 32];
+        state.finish(&mut out);
+        assert_eq!(&out[..], &expected[..]);
+    }
+}
+
+// RFC 5869, test case 1
+#[test]
+fn test_hkdf() {
+    let ikm = [0x0b; 22];
+    let salt = hex("000102030405060708090a0b0c");
+    let info = hex("f0f1f2f3f4f5f6f7f8f9");
+
+    let mut okm = [0; 42];
+    Hkdf::<Sha256>::extract(&salt, &ikm).expand(&info, &mut okm);
+    assert_eq!(&okm[..], &hex(
+        "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf\
+         34007208d5b887185865"
+    )[..]);
+
+    let prk = hex("077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5");
+    let mut okm2 = [0; 42];
+    Hkdf::<Sha256>::new(&prk).expand(&info, &mut okm2);
+    assert_eq!(okm, okm2);
+}
+
+#[test]
+fn test_hkdf_blake2() {
+    let prk = [0x42; 32];
+    let info = b"hkdf info";
+
+    let mut expected = [0; 100];
+    unsafe {
+        ffi::hkdf::Hacl_HKDF_expand_blake2s_32(
+            expected.as_mut_ptr(),
+            prk.as_ptr() as _, prk.len() as _,
+            info.as_ptr() as _, info.len() as _,
+            expected.len() as _
+        );
+    }
+
+    let mut okm = [0; 100];
+    Hkdf::<Blake2s>::new(&prk).expand(info, &mut okm);
+    assert_eq!(&okm[..], &expected[..]);
+}
@@ -0,0 +1,792 @@
+#![cfg(feature = "std")]
+
+extern crate hacl_star;
+extern crate hacl_star_sys;
+
+use hacl_star::sha2::Sha256;
+use hacl_star::blake2::{ Blake2s, Blake2b };
+use hacl_star::merkle::{ Algorithm, Tree, MultiProof, Writer, Snapshot };
+use hacl_star::merkle::{ ConsistencyProof, Consistency, verify_consistency };
+use hacl_star_sys as ffi;
+use std::sync::Arc;
+use std::thread;
+
+
+const ALGORITHMS: [Algorithm; 3] = [Algorithm::Sha256, Algorithm::Blake2s, Algorithm::Blake2b];
+
+fn leaf(algorithm: Algorithm, i: u64) -> Vec<u8> {
+    if algorithm.hash_length() == 64 {
+        let mut out = [0; 64];
+        Blake2b::hash(&mut out, &i.to_le_bytes());
+        out.to_vec()
+    } else {
+        let mut out = [0; 32];
+        Sha256::hash(&mut out, &i.to_le_bytes());
+        out.to_vec()
+    }
+}
+
+fn leaves(algorithm: Algorithm, range: std::ops::Range<u64>) -> Vec<u8> {
+    range.flat_map(|i| leaf(algorithm, i)).collect()
+}
+
+const K: [u32; 64] = [
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+];
+
+/// The SHA-256 compression function from the standard IV, over one block.
+fn compress(block: &[u8; 64]) -> [u8; 32] {
+    let iv = [
+        0x6a09e667u32, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    ];
+    let mut w = [0u32; 64];
+    for i in 0..16 {
+        w[i] = u32::from_be_bytes([block[4 * i], block[4 * i + 1], block[4 * i + 2], block[4 * i + 3]]);
+    }
+    for i in 16..64 {
+        let s0 = w[i - 15].rotate_right(7) ^ w[i - 15].rotate_right(18) ^ (w[i - 15] >> 3);
+        let s1 = w[i - 2].rotate_right(17) ^ w[i - 2].rotate_right(19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16].wrapping_add(s0).wrapping_add(w[i - 7]).wrapping_add(s1);
+    }
+
+    let mut s = iv;
+    for i in 0..64 {
+        let [a, b, c, d, e, f, g, h] = s;
+        let t1 = h
+            .wrapping_add(e.rotate_right(6) ^ e.rotate_right(11) ^ e.rotate_right(25))
+            .wrapping_add((e & f) ^ (!e & g))
+            .wrapping_add(K[i])
+            .wrapping_add(w[i]);
+        let t2 = (a.rotate_right(2) ^ a.rotate_right(13) ^ a.rotate_right(22))
+            .wrapping_add((a & b) ^ (a & c) ^ (b & c));
+        s = [t1.wrapping_add(t2), a, b, c, d.wrapping_add(t1), e, f, g];
+    }
+
+    let mut out = [0; 32];
+    for i in 0..8 {
+        out[4 * i..][..4].copy_from_slice(&s[i].wrapping_add(iv[i]).to_be_bytes());
+    }
+    out
+}
+
+/// The node hash, from the reference compression function and the BLAKE2 API.
+fn node(algorithm: Algorithm, left: &[u8], right: &[u8]) -> Vec<u8> {
+    let block = [left, right].concat();
+    match algorithm {
+        Algorithm::Sha256 => {
+            let mut buf = [0; 64];
+            buf.copy_from_slice(&block);
+            compress(&buf).to_vec()
+        },
+        Algorithm::Blake2s => {
+            let mut out = [0; 32];
+            Blake2s::hash(&mut out, &block);
+            out.to_vec()
+        },
+        Algorithm::Blake2b => {
+            let mut out = [0; 64];
+            Blake2b::hash(&mut out, &block);
+            out.to_vec()
+        }
+    }
+}
+
+/// RFC 6962 Merkle tree hash, without the leaf and node prefixes.
+fn mth(algorithm: Algorithm, leaves: &[u8]) -> Vec<u8> {
+    let len = algorithm.hash_length();
+    if leaves.len() == len {
+        return leaves.to_vec();
+    }
+    let k = (leaves.len() / len).next_power_of_two() / 2 * len;
+    node(algorithm, &mth(algorithm, &leaves[..k]), &mth(algorithm, &leaves[k..]))
+}
+
+fn tree(algorithm: Algorithm, n: u64) -> Tree {
+    let mut tree = Tree::new(algorithm, &leaf(algorithm, 0));
+    for i in 1..n {
+        tree.insert(&leaf(algorithm, i));
+    }
+    tree
+}
+
+fn check(tree: &Tree, indices: &[u64]) -> MultiProof {
+    let algorithm = tree.algorithm();
+    let len = algorithm.hash_length();
+    let size = tree.len();
+    let root = tree.root();
+    let leaves = indices.iter().flat_map(|&i| leaf(algorithm, i)).collect::<Vec<_>>();
+
+    let proof = tree.multiproof(indices);
+    assert!(proof.verify(algorithm, size, indices, &leaves, &root), "size={} indices={:?}", size, indices);
+    assert_eq!(MultiProof::from_bytes(&proof.to_bytes()), Some(proof.clone()));
+
+    // each node at most once: never more than the separate paths hold
+    let paths = indices.iter().map(|&i| tree.path(i).len()).sum::<usize>();
+    assert!(proof.nodes().len() <= paths);
+
+    let mut wrong = leaves.clone();
+    wrong[indices.len() / 2 * len] ^= 1;
+    assert!(!proof.verify(algorithm, size, indices, &wrong, &root));
+
+    for i in 0..proof.nodes().len() {
+        let mut bytes = proof.to_bytes();
+        bytes[8 + i * len] ^= 1;
+        let tampered = MultiProof::from_bytes(&bytes).unwrap();
+        assert!(!tampered.verify(algorithm, size, indices, &leaves, &root));
+    }
+
+    proof
+}
+
+#[test]
+fn test_root_and_path() {
+    // the reference compression, on the padded block of "abc"
+    let mut block = [0; 64];
+    block[..4].copy_from_slice(b"abc\x80");
+    block[63] = 24;
+    let mut abc = [0; 32];
+    Sha256::hash(&mut abc, b"abc");
+    assert_eq!(compress(&block), abc);
+
+    for &algorithm in ALGORITHMS.iter() {
+        let len = algorithm.hash_length();
+        let all = leaves(algorithm, 0..70);
+
+        for n in 1..=70 {
+            let tree = tree(algorithm, n);
+            assert_eq!(tree.len(), n);
+            assert_eq!(tree.root(), mth(algorithm, &all[..n as usize * len]), "{:?} n={}", algorithm, n);
+
+            // a single-leaf multiproof is the path
+            for i in 0..n {
+                let proof = check(&tree, &[i]);
+                assert_eq!(proof.nodes().collect::<Vec<_>>(), tree.path(i), "n={} i={}", n, i);
+            }
+        }
+    }
+}
+
+/// Root and paths of HACL*'s own tree of `leaves`, grown by `mt_insert` and
+/// `mt_insert_batch`, then retracted to `retract` leaves.
+fn hacl_tree(algorithm: Algorithm, leaves: &[u8], retract: u64) -> (Vec<u8>, Vec<Vec<Vec<u8>>>) {
+    use ffi::merkle::*;
+
+    let len = algorithm.hash_length();
+    let n = leaves.len() / len;
+    let hash_fun = match algorithm {
+        Algorithm::Sha256 => mt_sha256_compress,
+        Algorithm::Blake2s => mt_blake2s_compress,
+        Algorithm::Blake2b => mt_blake2b_compress
+    };
+    let kernel = match algorithm {
+        Algorithm::Sha256 => ffi::dispatch::table().merkle_sha256,
+        Algorithm::Blake2s => ffi::dispatch::table().merkle_blake2s,
+        Algorithm::Blake2b => mt_kernel { node: Some(mt_blake2b_compress), lanes: 1, batch: None }
+    };
+    let mut buf = leaves.to_vec();
+    let mut root = [0; 64];
+
+    unsafe {
+        let mt = mt_create_custom(len as u32, buf.as_mut_ptr(), Some(hash_fun));
+        for i in 1..n.min(5) {
+            mt_insert(mt, buf[i * len..].as_mut_ptr());
+        }
+        if n > 5 {
+            mt_insert_batch(mt, &kernel, n as u32 - 5, buf[5 * len..].as_mut_ptr());
+        }
+        mt_retract_to(mt, retract - 1);
+
+        let paths = (0..retract)
+            .map(|i| {
+                let path = mt_init_path(len as u32);
+                mt_get_path(mt, i, path, root.as_mut_ptr());
+                let steps = (1..mt_get_path_length(path))
+                    .map(|k| std::slice::from_raw_parts(mt_get_path_step(path, k), len).to_vec())
+                    .collect();
+                mt_free_path(path);
+                steps
+            })
+            .collect();
+        mt_free(mt);
+        (root[..len].to_vec(), paths)
+    }
+}
+
+#[test]
+fn test_hacl_tree() {
+    for &algorithm in ALGORITHMS.iter() {
+        let len = algorithm.hash_length();
+        let all = leaves(algorithm, 0..300);
+
+        for &n in &[1, 2, 3, 5, 6, 17, 64, 100, 255, 300] {
+            for &retract in &[n, n / 2 + 1] {
+                let mut tree = Tree::from_leaves(algorithm, &all[..n as usize * len]);
+                tree.retract_to(retract - 1);
+                let (root, paths) = hacl_tree(algorithm, &all[..n as usize * len], retract);
+                assert_eq!(tree.root(), &root[..], "{:?} n={} retract={}", algorithm, n, retract);
+                for (i, path) in paths.iter().enumerate() {
+                    assert_eq!(&tree.path(i as u64), path);
+                }
+            }
+        }
+    }
+}
+
+#[test]
+fn test_sha256_node() {
+    use ffi::merkle::*;
+
+    let table = ffi::dispatch::table();
+    assert!(["shaext", "vec256", "vec128", "portable"].contains(&table.merkle));
+    let portable = mt_kernel { node: Some(mt_sha256_node), lanes: 1, batch: None };
+
+    let all = leaves(Algorithm::Sha256, 0..40);
+    let mut block = [0; 64];
+    block.copy_from_slice(&all[..64]);
+    let expected = compress(&block);
+    let (mut left, mut right, mut out) = ([0; 32], [0; 32], [0; 32]);
+    left.copy_from_slice(&all[..32]);
+    right.copy_from_slice(&all[32..64]);
+
+    unsafe {
+        mt_sha256_compress(left.as_mut_ptr(), right.as_mut_ptr(), out.as_mut_ptr());
+        assert_eq!(out, expected);
+        mt_sha256_node(left.as_mut_ptr(), right.as_mut_ptr(), out.as_mut_ptr());
+        assert_eq!(out, expected);
+        // in place
+        mt_sha256_node(left.as_mut_ptr(), right.as_mut_ptr(), left.as_mut_ptr());
+        assert_eq!(left, expected);
+
+        // the selected kernel in place
+        let node = table.merkle_sha256.node.unwrap();
+        right.copy_from_slice(&all[32..64]);
+        left.copy_from_slice(&all[..32]);
+        node(left.as_mut_ptr(), right.as_mut_ptr(), right.as_mut_ptr());
+        assert_eq!(right, expected);
+
+        // whole batches, and the last nodes on their own
+        for kernel in [table.merkle_sha256, portable].iter() {
+            for n in 1..=20 {
+                let mut src = all[..n * 64].to_vec();
+                let mut dst = vec![0; n * 32];
+                mt_hash_pairs(kernel, 32, n as u32, src.as_mut_ptr(), dst.as_mut_ptr());
+                for (k, parent) in dst.chunks(32).enumerate() {
+                    block.copy_from_slice(&src[k * 64..(k + 1) * 64]);
+                    assert_eq!(parent, compress(&block), "n={} k={}", n, k);
+                }
+            }
+        }
+    }
+}
+
+#[test]
+fn test_insert_batch() {
+    for &algorithm in ALGORITHMS.iter() {
+        let len = algorithm.hash_length();
+        let all = leaves(algorithm, 0..1400);
+
+        for &n in &[1, 2, 3, 9, 16, 17, 100, 255, 256, 257, 1100] {
+            let tree = Tree::from_leaves(algorithm, &all[..n * len]);
+            assert_eq!(tree.len(), n as u64);
+            assert_eq!(tree.root(), mth(algorithm, &all[..n * len]), "{:?} n={}", algorithm, n);
+            check(&tree, &(0..n as u64).collect::<Vec<_>>());
+        }
+
+        // batches of every size, on trees of every parity, mixed with single inserts
+        let mut sequential = Tree::new(algorithm, &all[..len]);
+        let mut batched = Tree::new(algorithm, &all[..len]);
+        let mut pos = 1;
+        for size in (0..40).chain([100, 300].iter().cloned()) {
+            for i in pos..pos + size {
+                sequential.insert(&all[i * len..][..len]);
+            }
+            batched.insert_batch(&all[pos * len..(pos + size) * len]);
+            pos += size;
+
+            sequential.insert(&all[pos * len..][..len]);
+            batched.insert(&all[pos * len..][..len]);
+            pos += 1;
+
+            assert_eq!(batched.len(), pos as u64);
+            assert_eq!(batched.root(), sequential.root(), "{:?} size={}", algorithm, size);
+            for &i in &[0, pos as u64 / 3, pos as u64 - 1] {
+                assert_eq!(batched.path(i), sequential.path(i));
+            }
+        }
+
+        // after a flush, the stored levels start at an offset
+        batched.flush_to(333);
+        sequential.flush_to(333);
+        batched.insert_batch(&all[pos * len..(pos + 77) * len]);
+        for i in pos..pos + 77 {
+            sequential.insert(&all[i * len..][..len]);
+        }
+        assert_eq!(batched.root(), sequential.root());
+        check(&batched, &[333, 500, pos as u64 + 76]);
+    }
+}
+
+#[test]
+fn test_cached_root() {
+    for &algorithm in ALGORITHMS.iter() {
+        let len = algorithm.hash_length();
+        let all = leaves(algorithm, 0..600);
+
+        // the root of every size, one leaf or one batch at a time
+        let mut tree = Tree::new(algorithm, &all[..len]);
+        for n in 2..=300 {
+            tree.insert(&all[(n - 1) * len..][..len]);
+            assert_eq!(tree.root(), mth(algorithm, &all[..n * len]), "{:?} n={}", algorithm, n);
+        }
+        let mut n = 300;
+        for size in 1..20 {
+            tree.insert_batch(&all[n * len..(n + size) * len]);
+            n += size;
+            assert_eq!(tree.root(), mth(algorithm, &all[..n * len]), "{:?} n={}", algorithm, n);
+        }
+
+        let root = tree.root().to_vec();
+        tree.flush_to(200);
+        assert_eq!(tree.root(), &root[..]);
+        check(&tree, &[200, 201, n as u64 - 1]);
+        tree.retract_to(250);
+        assert_eq!(tree.root(), mth(algorithm, &all[..251 * len]));
+        check(&tree, &[200, 250]);
+    }
+
+    // readers share one tree
+    let algorithm = Algorithm::Sha256;
+    let tree = Arc::new(Tree::from_leaves(algorithm, &leaves(algorithm, 0..1000)));
+    let readers = (0..4u64)
+        .map(|t| {
+            let tree = tree.clone();
+            thread::spawn(move || {
+                for i in (t + 1..1000).step_by(37) {
+                    let indices = [i / 2, i];
+                    let leaves = [leaf(algorithm, i / 2), leaf(algorithm, i)].concat();
+                    let proof = tree.multiproof(&indices);
+                    assert!(proof.verify(algorithm, 1000, &indices, &leaves, tree.root()));
+                }
+            })
+        })
+        .collect::<Vec<_>>();
+    for reader in readers {
+        reader.join().unwrap();
+    }
+}
+
+#[test]
+fn test_multiproof() {
+    let mut state = 0x2545f491u64;
+    let mut next = move || {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        state
+    };
+
+    for &n in &[2, 3, 5, 8, 13, 64, 100, 255, 256, 257, 1000] {
+        let tree = tree(Algorithm::Sha256, n);
+
+        check(&tree, &(0..n).collect::<Vec<_>>());
+        check(&tree, &[0, n - 1]);
+
+        for _ in 0..20 {
+            let mut indices = (0..1 + next() % 16).map(|_| next() % n).collect::<Vec<_>>();
+            indices.sort();
+            indices.dedup();
+            check(&tree, &indices);
+        }
+    }
+
+    // a run of adjacent leaves needs about the nodes of its two end paths
+    let tree = tree(Algorithm::Sha256, 1000);
+    let run = (300..600).collect::<Vec<_>>();
+    let proof = check(&tree, &run);
+    assert!(proof.nodes().len() <= tree.path(300).len() + tree.path(599).len());
+
+    let tree = Tree::from_leaves(Algorithm::Blake2b, &leaves(Algorithm::Blake2b, 0..1000));
+    check(&tree, &run);
+}
+
+#[test]
+fn test_multiproof_rejects() {
+    let algorithm = Algorithm::Sha256;
+    let tree = tree(algorithm, 100);
+    let root = tree.root();
+    let indices = [3, 40, 41, 99];
+    let leaves = indices.iter().flat_map(|&i| leaf(algorithm, i)).collect::<Vec<_>>();
+    let proof = tree.multiproof(&indices);
+
+    assert!(!proof.verify(algorithm, 101, &indices, &leaves, &root));
+    assert!(!proof.verify(algorithm, 99, &indices, &leaves, &root));
+    assert!(!proof.verify(algorithm, 100, &[3, 40, 41, 98], &leaves, &root));
+    // same lengths, other node hash
+    assert!(!proof.verify(Algorithm::Blake2s, 100, &indices, &leaves, &root));
+
+    let bytes = proof.to_bytes();
+    assert!(MultiProof::from_bytes(&bytes[..bytes.len() - 1]).is_none());
+    assert!(MultiProof::from_bytes(&bytes[..4]).is_none());
+
+    // dropping or adding a node fails even if the rest is right
+    let mut short = bytes[..bytes.len() - 32].to_vec();
+    short[7] -= 1;
+    assert!(!MultiProof::from_bytes(&short).unwrap().verify(algorithm, 100, &indices, &leaves, &root));
+    let mut long = bytes.clone();
+    long.extend_from_slice(&[0; 32]);
+    long[7] += 1;
+    assert!(!MultiProof::from_bytes(&long).unwrap().verify(algorithm, 100, &indices, &leaves, &root));
+
+    // a 64-byte proof is not one for a 32-byte tree
+    let mut body = bytes[8..].to_vec();
+    if body.len() % 64 != 0 {
+        body.extend_from_slice(&[0; 32]);
+    }
+    let mut wide = 64u32.to_be_bytes().to_vec();
+    wide.extend_from_slice(&(body.len() as u32 / 64).to_be_bytes());
+    wide.extend_from_slice(&body);
+    let wide = MultiProof::from_bytes(&wide).unwrap();
+    assert_eq!(wide.hash_length(), 64);
+    assert!(!wide.verify(algorithm, 100, &indices, &leaves, &root));
+}
+
+#[test]
+fn test_flush_retract() {
+    let algorithm = Algorithm::Sha256;
+    let mut tree = tree(algorithm, 200);
+    tree.flush_to(77);
+    check(&tree, &[77, 78, 150, 199]);
+    check(&tree, &(77..200).collect::<Vec<_>>());
+
+    tree.retract_to(120);
+    assert_eq!(tree.len(), 121);
+    assert_eq!(tree.root(), mth(algorithm, &leaves(algorithm, 0..121)));
+    check(&tree, &[77, 100, 119, 120]);
+}
+
+/// RFC 9162 `SUBPROOF`, from the reference tree hash.
+fn subproof(algorithm: Algorithm, m: usize, leaves: &[u8], old_tree: bool) -> Vec<Vec<u8>> {
+    let len = algorithm.hash_length();
+    let n = leaves.len() / len;
+    if m == n {
+        return if old_tree { vec![] } else { vec![mth(algorithm, leaves)] };
+    }
+
+    let mut k = 1;
+    while 2 * k < n {
+        k *= 2;
+    }
+    let (mut proof, node) = if m <= k {
+        (subproof(algorithm, m, &leaves[..k * len], old_tree), mth(algorithm, &leaves[k * len..]))
+    } else {
+        (subproof(algorithm, m - k, &leaves[k * len..], false), mth(algorithm, &leaves[..k * len]))
+    };
+    proof.push(node);
+    proof
+}
+
+#[test]
+fn test_consistency() {
+    for &algorithm in ALGORITHMS.iter() {
+        let len = algorithm.hash_length();
+        let all = leaves(algorithm, 0..70);
+        let roots = (1..=70).map(|n| mth(algorithm, &all[..n * len])).collect::<Vec<_>>();
+        let mut tree = Tree::new(algorithm, &all[..len]);
+        let mut proofs = Vec::new();
+
+        for n in 1..=70 {
+            if n > 1 {
+                tree.insert(&all[(n - 1) * len..n * len]);
+            }
+
+            for m in 1..=n {
+                let (old_root, new_root) = (&roots[m - 1], &roots[n - 1]);
+                let proof = tree.consistency(m as u64);
+                let expected = subproof(algorithm, m, &all[..n * len], true);
+                assert_eq!(proof.nodes().collect::<Vec<_>>(), expected, "{:?} m={} n={}", algorithm, m, n);
+                assert!(proof.verify(algorithm, m as u64, n as u64, old_root, new_root), "m={} n={}", m, n);
+                assert_eq!(ConsistencyProof::from_bytes(&proof.to_bytes()), Some(proof.clone()));
+
+                let mut wrong = old_root.clone();
+                wrong[0] ^= 1;
+                assert!(!proof.verify(algorithm, m as u64, n as u64, &wrong, new_root));
+                assert!(!proof.verify(algorithm, m as u64, n as u64, old_root, &wrong));
+                assert!(!proof.verify(algorithm, n as u64, m as u64, new_root, old_root) || m == n);
+                for i in 0..proof.nodes().len() {
+                    let mut bytes = proof.to_bytes();
+                    bytes[8 + i * len] ^= 1;
+                    let tampered = ConsistencyProof::from_bytes(&bytes).unwrap();
+                    assert!(!tampered.verify(algorithm, m as u64, n as u64, old_root, new_root));
+                }
+
+                if n % 9 == 0 {
+                    proofs.push((m, n, proof));
+                }
+            }
+        }
+
+        // batches mixing good and bad pairs agree with one at a time
+        let mut wrong = roots[0].clone();
+        wrong[0] ^= 1;
+        let checks = proofs.iter()
+            .enumerate()
+            .map(|(i, &(m, n, ref proof))| Consistency {
+                old_size: m as u64,
+                new_size: n as u64,
+                old_root: &roots[m - 1],
+                new_root: if i % 5 == 3 { &wrong } else { &roots[n - 1] },
+                proof
+            })
+            .collect::<Vec<_>>();
+        let results = verify_consistency(algorithm, &checks);
+        for (i, (check, &ok)) in checks.iter().zip(&results).enumerate() {
+            assert_eq!(ok, i % 5 != 3);
+            assert_eq!(ok, check.proof.verify(algorithm, check.old_size, check.new_size, check.old_root, check.new_root));
+        }
+
+        // from the cached nodes of a snapshot, the flushed ones aside
+        let mut writer = Writer::from_leaves(algorithm, &all);
+        writer.flush_to(33);
+        let snapshot = writer.snapshot();
+        for m in 34..=70 {
+            assert_eq!(snapshot.consistency(m), tree.consistency(m));
+        }
+
+        // across segments
+        let big = leaves(algorithm, 0..3000);
+        let mut writer = Writer::from_leaves(algorithm, &big);
+        writer.flush_to(1500);
+        let snapshot = writer.snapshot();
+        for &m in &[1501, 2047, 2048, 2049, 2999, 3000] {
+            let old = Tree::from_leaves(algorithm, &big[..m as usize * len]);
+            let proof = snapshot.consistency(m);
+            assert!(proof.verify(algorithm, m, 3000, old.root(), snapshot.root()), "m={}", m);
+        }
+    }
+}
+
+/// Checks a snapshot against the `Tree` of the same leaves, `all` from the first.
+fn check_snapshot(snapshot: &Snapshot, tree: &Tree, all: &[u8], indices: &[u64]) {
+    let len = snapshot.algorithm().hash_length();
+    let leaves = indices.iter()
+        .flat_map(|&i| all[i as usize * len..][..len].iter().cloned())
+        .collect::<Vec<_>>();
+
+    assert_eq!(snapshot.len(), tree.len());
+    assert_eq!(snapshot.root(), tree.root());
+    let proof = snapshot.multiproof(indices);
+    assert_eq!(proof, tree.multiproof(indices), "size={} indices={:?}", snapshot.len(), indices);
+    assert!(snapshot.verify(indices, &leaves, &proof));
+    for &i in indices {
+        assert_eq!(snapshot.path(i), tree.path(i));
+    }
+}
+
+#[test]
+fn test_snapshot() {
+    for &algorithm in ALGORITHMS.iter() {
+        let len = algorithm.hash_length();
+        let all = leaves(algorithm, 0..3000);
+
+        // one leaf at a time, then batches crossing segment boundaries
+        let mut writer = Writer::new(algorithm, &all[..len]);
+        let mut tree = Tree::new(algorithm, &all[..len]);
+        let mut n = 1;
+        while n < 2500 {
+            let size = if n < 80 { 1 } else { n / 7 % 300 };
+            writer.insert_batch(&all[n * len..(n + size) * len]);
+            tree.insert_batch(&all[n * len..(n + size) * len]);
+            n += size;
+
+            let mut indices = vec![0, n as u64 / 3, n as u64 / 3 + 1, n as u64 - 1];
+            indices.sort();
+            indices.dedup();
+            check_snapshot(&writer.snapshot(), &tree, &all, &indices);
+        }
+
+        // old snapshots outlive flushes and retractions
+        let before = writer.snapshot();
+        writer.flush_to(1030);
+        tree.flush_to(1030);
+        let flushed = writer.snapshot();
+        assert_eq!(flushed.offset(), 1030);
+        check_snapshot(&flushed, &tree, &all, &[1030, 1031, 2000, n as u64 - 1]);
+
+        writer.retract_to(1500);
+        tree.retract_to(1500);
+        check_snapshot(&writer.snapshot(), &tree, &all, &[1030, 1499, 1500]);
+
+        // the leaves after a retraction differ from those before
+        let other = leaves(algorithm, 5000..5700);
+        writer.insert_batch(&other);
+        tree.insert_batch(&other);
+        let current = [&all[..1501 * len], &other[..]].concat();
+        check_snapshot(&writer.snapshot(), &tree, &current, &[1030, 1500, 1501, 2200]);
+
+        assert_eq!(before.len(), n as u64);
+        assert_eq!(before.root(), &mth(algorithm, &all[..n * len])[..]);
+        let indices = [0, 1023, 1024, 1501, n as u64 - 1];
+        let proof = before.multiproof(&indices);
+        let expected = indices.iter().flat_map(|&i| leaf(algorithm, i)).collect::<Vec<_>>();
+        assert!(before.verify(&indices, &expected, &proof));
+        assert_eq!(flushed.root(), before.root());
+        assert_eq!(flushed.multiproof(&indices[3..]), before.multiproof(&indices[3..]));
+    }
+}
+
+#[test]
+fn test_snapshot_readers() {
+    let algorithm = Algorithm::Blake2s;
+    let len = algorithm.hash_length();
+    let n = 4000;
+    let all = Arc::new(leaves(algorithm, 0..n));
+    let mut tree = Tree::new(algorithm, &all[..len]);
+    let mut roots = vec![Vec::new(), tree.root().to_vec()];
+    for i in 1..n as usize {
+        tree.insert(&all[i * len..][..len]);
+        roots.push(tree.root().to_vec());
+    }
+    let roots = Arc::new(roots);
+
+    let mut writer = Writer::new(algorithm, &all[..len]);
+    let readers = (0..4u64)
+        .map(|t| {
+            let reader = writer.reader();
+            let (all, roots) = (all.clone(), roots.clone());
+            thread::spawn(move || {
+                let mut seen = 0;
+                while seen < n {
+                    let (pinned, held);
+                    let snapshot: &Snapshot = if t % 2 == 0 {
+                        pinned = reader.pin();
+                        &pinned
+                    } else {
+                        held = reader.snapshot();
+                        &held
+                    };
+                    let size = snapshot.len();
+                    assert!(size >= seen);
+                    assert_eq!(snapshot.root(), &roots[size as usize][..]);
+
+                    let indices = [(size - 1) * t / 4, size - 1];
+                    let indices = if indices[0] == indices[1] { &indices[1..] } else { &indices[..] };
+                    let leaves = indices.iter()
+                        .flat_map(|&i| all[i as usize * len..][..len].iter().cloned())
+                        .collect::<Vec<_>>();
+                    let proof = snapshot.multiproof(indices);
+                    assert!(snapshot.verify(indices, &leaves, &proof));
+                    seen = size;
+                }
+            })
+        })
+        .collect::<Vec<_>>();
+
+    let mut m = 1;
+    while m < n as usize {
+        let size = (m % 13 + 1).min(n as usize - m);
+        writer.insert_batch(&all[m * len..(m + size) * len]);
+        m += size;
+    }
+    for reader in readers {
+        reader.join().unwrap();
+    }
+}
+
+#[test]
+fn test_snapshot_pin() {
+    let algorithm = Algorithm::Sha256;
+    let len = algorithm.hash_length();
+    let all = leaves(algorithm, 0..300);
+    let mut writer = Writer::new(algorithm, &all[..len]);
+    let reader = writer.reader();
+
+    // more pins than a block of slots, each kept across later publishes
+    let mut pinned = Vec::new();
+    for i in 1..200 {
+        pinned.push(reader.pin());
+        writer.insert(&all[i * len..][..len]);
+    }
+    for (i, snapshot) in pinned.iter().enumerate() {
+        assert_eq!(snapshot.len(), i as u64 + 1);
+        assert_eq!(snapshot.root(), &Tree::from_leaves(algorithm, &all[..(i + 1) * len]).root()[..]);
+    }
+
+    // a replaced snapshot is freed once unpinned, at the next publish
+    let old = writer.snapshot();
+    let pin = reader.pin();
+    writer.insert(&all[200 * len..][..len]);
+    assert_eq!(Arc::strong_count(&old), 2);
+    drop(pin);
+    drop(pinned);
+    writer.insert(&all[201 * len..][..len]);
+    assert_eq!(Arc::strong_count(&old), 1);
+    assert_eq!(reader.snapshot().len(), 202);
+}
+
+/// Checks a file-backed snapshot against an in-memory one of the same leaves.
+#[cfg(unix)]
+fn check_on_disk(snapshot: &Snapshot, expected: &Snapshot, all: &[u8], indices: &[u64]) {
+    let len = snapshot.algorithm().hash_length();
+    let leaves = indices.iter()
+        .flat_map(|&i| all[i as usize * len..][..len].iter().cloned())
+        .collect::<Vec<_>>();
+
+    assert_eq!(snapshot.len(), expected.len());
+    assert_eq!(snapshot.root(), expected.root());
+    let proof = snapshot.multiproof(indices);
+    assert_eq!(proof, expected.multiproof(indices), "size={} indices={:?}", snapshot.len(), indices);
+    assert!(snapshot.verify(indices, &leaves, &proof));
+}
+
+#[cfg(unix)]
+#[test]
+fn test_on_disk() {
+    let algorithm = Algorithm::Sha256;
+    let len = algorithm.hash_length();
+    let n = 600_000;
+    let all = leaves(algorithm, 0..n);
+    let dir = std::env::temp_dir();
+
+    // past the first 2^18-node extent of the two file-backed levels
+    let mut writer = Writer::on_disk(algorithm, &all[..len], &dir, 2).unwrap();
+    let mut memory = Writer::new(algorithm, &all[..len]);
+    let mut m = 1;
+    for &size in &[1, 100, 5000, 262_000, 300_000] {
+        writer.insert_batch(&all[m * len..(m + size) * len]);
+        memory.insert_batch(&all[m * len..(m + size) * len]);
+        m += size;
+
+        let mut indices = vec![0, 262_143, 262_144, m as u64 - 1];
+        indices.retain(|&i| i < m as u64);
+        indices.sort();
+        indices.dedup();
+        check_on_disk(&writer.snapshot(), &memory.snapshot(), &all, &indices);
+    }
+
+    let before = writer.snapshot();
+    writer.flush_to(300_000);
+    memory.flush_to(300_000);
+    writer.retract_to(500_000);
+    memory.retract_to(500_000);
+    let other = leaves(algorithm, n..n + 1000);
+    writer.insert_batch(&other);
+    memory.insert_batch(&other);
+    let current = [&all[..500_001 * len], &other[..]].concat();
+    check_on_disk(&writer.snapshot(), &memory.snapshot(), &current, &[300_000, 500_000, 500_001, 501_000]);
+
+    // the old snapshot still maps the nodes the writer has since replaced
+    let indices = [1, 500_001, m as u64 - 1];
+    let expected = indices.iter().flat_map(|&i| leaf(algorithm, i)).collect::<Vec<_>>();
+    assert!(before.verify(&indices, &expected, &before.multiproof(&indices)));
+    assert_eq!(before.len(), m as u64);
+
+    assert!(Writer::on_disk(algorithm, &all[..len], &dir.join("missing"), 2).is_err());
+}
@@ -0,0 +1,120 @@
+extern crate hacl_star;
+
+use hacl_star::curve25519;
+use hacl_star::nacl::secret;
+
+
+fn hex(s: &str) -> Vec<u8> {
+    (0..s.len()).step_by(2)
+        .map(|i| u8::from_str_radix(&s[i..i + 2], 16).unwrap())
+        .collect()
+}
+
+fn array32(s: &str) -> [u8; 32] {
+    let mut out = [0; 32];
+    out.copy_from_slice(&hex(s));
+    out
+}
+
+// the crypto_box vector of the NaCl distribution (tests/box.c, box2.c)
+const ALICE_SK: &str = "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a";
+const ALICE_PK: &str = "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a";
+const BOB_SK: &str = "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb";
+const BOB_PK: &str = "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f";
+const SHARED: &str = "1b27556473e985d462cd51197a9a46c76009549eac6474f206c4ee0844f68389";
+const NONCE: &str = "69696ee955b62b73cd62bda875fc73d68219e0036b7a0b37";
+const M: &str = "be075fc53c81f2d5cf141316ebeb0c7b5228c52a4c62cbd44b66849b64244ffc\
+                 e5ecbaaf33bd751a1ac728d45e6c61296cdc3c01233561f41db66cce314adb31\
+                 0e3be8250c46f06dceea3a7fa1348057e2f6556ad6b1318a024a838f21af1fde\
+                 048977eb48f59ffd4924ca1c60902e52f0a089bc76897040e082f93776384864\
+                 5e0705";
+const C: &str = "8e993b9f48681273c29650ba32fc76ce48332ea7164d96a4476fb8c531a1186a\
+                 c0dfc17c98dce87b4da7f011ec48c97271d2c20f9b928fe2270d6fb863d51738\
+                 b48eeee314a7cc8ab932164548e526ae90224368517acfeabd6bb3732bc0e9da\
+                 99832b61ca01b6de56244a9e88d5f9b37973f622a43d14a6599b1f654cb45a74\
+                 e355a5";
+const MAC: &str = "f3ffc7703f9400e52a7dfb4b3d3305d9";
+
+fn nonce() -> [u8; 24] {
+    let mut nonce = [0; 24];
+    nonce.copy_from_slice(&hex(NONCE));
+    nonce
+}
+
+#[test]
+fn test_box() {
+    let alice_sk = curve25519::SecretKey(array32(ALICE_SK));
+    let alice_pk = curve25519::PublicKey(array32(ALICE_PK));
+    let bob_sk = curve25519::SecretKey(array32(BOB_SK));
+    let bob_pk = curve25519::PublicKey(array32(BOB_PK));
+    let nonce = nonce();
+    let m = hex(M);
+
+    let mut c = vec![0; m.len()];
+    let mut mac = [0; 16];
+    assert!(alice_sk.and(&bob_pk).nonce(&nonce).seal(&m, &mut c, &mut mac));
+    assert_eq!(c, hex(C));
+    assert_eq!(&mac[..], &hex(MAC)[..]);
+
+    let mut out = vec![0; c.len()];
+    assert!(bob_sk.and(&alice_pk).nonce(&nonce).open(&mut out, &c, &mac));
+    assert_eq!(out, m);
+
+    mac[0] ^= 1;
+    assert!(!bob_sk.and(&alice_pk).nonce(&nonce).open(&mut out, &c, &mac));
+
+    // a low-order public key is refused
+    let zero = curve25519::PublicKey([0; 32]);
+    assert!(alice_sk.and(&zero).precompute().is_none());
+    assert!(!alice_sk.and(&zero).nonce(&nonce).seal(&m, &mut c, &mut mac));
+}
+
+#[test]
+fn test_box_precomputed() {
+    let alice_sk = curve25519::SecretKey(array32(ALICE_SK));
+    let alice_pk = curve25519::PublicKey(array32(ALICE_PK));
+    let bob_sk = curve25519::SecretKey(array32(BOB_SK));
+    let bob_pk = curve25519::PublicKey(array32(BOB_PK));
+    let nonce = nonce();
+
+    let key = alice_sk.and(&bob_pk).precompute().unwrap();
+    assert_eq!(key.0, array32(SHARED));
+    assert_eq!(bob_sk.and(&alice_pk).precompute().unwrap().0, key.0);
+
+    let mut buf = hex(M);
+    let mut mac = [0; 16];
+    key.nonce(&nonce).seal_in_place(&mut buf, &mut mac);
+    assert_eq!(buf, hex(C));
+    assert_eq!(&mac[..], &hex(MAC)[..]);
+
+    let mut tampered = mac;
+    tampered[15] ^= 0x80;
+    assert!(!key.nonce(&nonce).open_in_place(&mut buf, &tampered));
+    assert_eq!(buf, hex(C));
+
+    assert!(key.nonce(&nonce).open_in_place(&mut buf, &mac));
+    assert_eq!(buf, hex(M));
+}
+
+#[test]
+fn test_secretbox() {
+    let key = secret::Key([0x42; 32]);
+    let nonce = [7; 24];
+    let msg = (0..1000).map(|i| i as u8).collect::<Vec<u8>>();
+
+    for &len in [0, 1, 31, 32, 33, 64, 100, 1000].iter() {
+        let mut c = vec![0; len];
+        let mut mac = [0; 16];
+        key.nonce(&nonce).seal(&msg[..len], &mut c, &mut mac);
+
+        let mut buf = msg[..len].to_vec();
+        let mut mac2 = [0; 16];
+        key.nonce(&nonce).seal_in_place(&mut buf, &mut mac2);
+        assert_eq!(buf, c);
+        assert_eq!(mac, mac2);
+
+        let mut m = vec![0; len];
+        assert!(key.nonce(&nonce).open(&mut m, &c, &mac));
+        assert_eq!(m, &msg[..len]);
+    }
+}
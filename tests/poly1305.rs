@@ -0,0 +1,59 @@
+extern crate hacl_star;
+
+use hacl_star::poly1305::{ Poly1305, Backend };
+
+
+// RFC 8439, section 2.5.2
+const KEY: [u8; 32] = [
+    0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33,
+    0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8,
+    0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd,
+    0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b
+];
+const MSG: &[u8] = b"Cryptographic Forum Research Group";
+const TAG: [u8; 16] = [
+    0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6,
+    0xc2, 0x2b, 0x8b, 0xaf, 0x0c, 0x01, 0x27, 0xa9
+];
+
+const BACKENDS: [Backend; 4] = [Backend::Portable, Backend::Vale, Backend::Vec128, Backend::Vec256];
+
+#[test]
+fn test_poly1305() {
+    let mut tag = [0; 16];
+    Poly1305::onetimeauth(&mut tag, MSG, &KEY);
+    assert_eq!(tag, TAG);
+
+    for &backend in BACKENDS.iter().filter(|b| b.is_available()) {
+        let mut tag = [0; 16];
+        let mut state = Poly1305::with_backend(&KEY, backend);
+        state.update(&MSG[..5]);
+        state.update(&MSG[5..]);
+        state.finish(&mut tag);
+        assert_eq!(tag, TAG, "{:?}", backend);
+    }
+}
+
+#[test]
+fn test_poly1305_streaming() {
+    let msg = (0..1031).map(|i| i as u8).collect::<Vec<u8>>();
+
+    for &len in &[0, 15, 16, 17, 63, 64, 65, 129, 1031] {
+        let mut expected = [0; 16];
+        let mut state = Poly1305::with_backend(&KEY, Backend::Portable);
+        state.update(&msg[..len]);
+        state.finish(&mut expected);
+
+        for &backend in BACKENDS.iter().filter(|b| b.is_available()) {
+            for &step in &[1, 7, 16, 33, 64, 100, 1031] {
+                let mut tag = [0; 16];
+                let mut state = Poly1305::with_backend(&KEY, backend);
+                for chunk in msg[..len].chunks(step) {
+                    state.update(chunk);
+                }
+                state.finish(&mut tag);
+                assert_eq!(tag, expected, "{:?} len={} step={}", backend, len, step);
+            }
+        }
+    }
+}